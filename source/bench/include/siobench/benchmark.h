@@ -0,0 +1,388 @@
+#pragma once
+
+// -- std headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef SIO_BENCH_VERSION
+#define SIO_BENCH_VERSION "unknown"
+#endif
+
+namespace sio {
+
+  namespace bench {
+
+    /**
+     *  @brief  Prevent the compiler from optimizing away a computed value
+     */
+    template <typename T>
+    inline void do_not_optimize( T const &value ) {
+#if defined(__GNUC__) || defined(__clang__)
+      asm volatile( "" : : "r,m"(value) : "memory" ) ;
+#else
+      static volatile const T *sink = nullptr ;
+      sink = &value ;
+#endif
+    }
+
+    /**
+     *  @brief  Prevent the compiler from reordering memory accesses across this point
+     */
+    inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+      asm volatile( "" : : : "memory" ) ;
+#endif
+    }
+
+    /**
+     *  @brief  Escape a string for a JSON output
+     */
+    inline std::string json_escape( const std::string &str ) {
+      std::ostringstream out ;
+      for( const auto c : str ) {
+        switch( c ) {
+          case '"': out << "\\\"" ; break ;
+          case '\\': out << "\\\\" ; break ;
+          case '\n': out << "\\n" ; break ;
+          case '\t': out << "\\t" ; break ;
+          default:
+            if( static_cast<unsigned char>( c ) < 0x20 ) {
+              out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>( c ) << std::dec << std::setfill(' ') ;
+            }
+            else {
+              out << c ;
+            }
+        }
+      }
+      return out.str() ;
+    }
+
+    /**
+     *  @brief  The compiler name and version
+     */
+    inline std::string compiler() {
+      std::ostringstream out ;
+#if defined(__clang__)
+      out << "clang " << __clang_major__ << "." << __clang_minor__ << "." << __clang_patchlevel__ ;
+#elif defined(__GNUC__)
+      out << "gcc " << __GNUC__ << "." << __GNUC_MINOR__ << "." << __GNUC_PATCHLEVEL__ ;
+#else
+      out << "unknown" ;
+#endif
+      return out.str() ;
+    }
+
+    /**
+     *  @brief  config struct.
+     *
+     *  The benchmark run settings
+     */
+    struct config {
+      ///< The number of measured repetitions per benchmark
+      std::size_t                 _repetitions {15} ;
+      ///< The number of warm-up repetitions (not measured)
+      std::size_t                 _warmup {2} ;
+      ///< The minimal duration of a repetition (seconds)
+      double                      _min_time {0.01} ;
+      ///< Only run the benchmarks whose name contains this string
+      std::string                 _filter {} ;
+      ///< The JSON output file (empty: standard output)
+      std::string                 _output {} ;
+
+      /**
+       *  @brief  Parse the common command line arguments.
+       *          Returns false if an argument is invalid or if the help was requested
+       */
+      bool parse( int argc, char **argv, std::ostream &err = std::cerr ) {
+        for( int i=1 ; i<argc ; i++ ) {
+          const std::string arg = argv[i] ;
+          const bool has_value = ( i+1 < argc ) ;
+          if( arg == "-r" and has_value ) {
+            _repetitions = std::max( std::atoi( argv[++i] ), 1 ) ;
+          }
+          else if( arg == "-w" and has_value ) {
+            _warmup = std::max( std::atoi( argv[++i] ), 0 ) ;
+          }
+          else if( arg == "-t" and has_value ) {
+            _min_time = std::max( std::atof( argv[++i] ), 0. ) ;
+          }
+          else if( arg == "-f" and has_value ) {
+            _filter = argv[++i] ;
+          }
+          else if( arg == "-o" and has_value ) {
+            _output = argv[++i] ;
+          }
+          else {
+            err << "Invalid argument '" << arg << "'" << std::endl ;
+            return false ;
+          }
+        }
+        return true ;
+      }
+    };
+
+    /**
+     *  @brief  result struct.
+     *
+     *  The measurement of a benchmark. A sample is the mean time of one
+     *  iteration over a repetition
+     */
+    struct result {
+      ///< The benchmark name
+      std::string                 _name {} ;
+      ///< The number of processed bytes per iteration
+      std::size_t                 _bytes {0} ;
+      ///< The number of processed items per iteration
+      std::size_t                 _items {0} ;
+      ///< The number of iterations per repetition
+      std::size_t                 _iterations {0} ;
+      ///< The time per iteration of each repetition (nanoseconds)
+      std::vector<double>         _samples {} ;
+
+      /// Get the smallest sample
+      double min() const {
+        return *std::min_element( _samples.begin(), _samples.end() ) ;
+      }
+
+      /// Get the largest sample
+      double max() const {
+        return *std::max_element( _samples.begin(), _samples.end() ) ;
+      }
+
+      /// Get the mean of the samples
+      double mean() const {
+        return std::accumulate( _samples.begin(), _samples.end(), 0. ) / _samples.size() ;
+      }
+
+      /// Get the sample standard deviation
+      double stddev() const {
+        if( _samples.size() < 2 ) {
+          return 0. ;
+        }
+        const auto m = mean() ;
+        double sum = 0. ;
+        for( const auto s : _samples ) {
+          sum += ( s - m ) * ( s - m ) ;
+        }
+        return std::sqrt( sum / ( _samples.size() - 1 ) ) ;
+      }
+
+      /// Get the q-quantile of the samples (linear interpolation)
+      double quantile( double q ) const {
+        auto sorted = _samples ;
+        std::sort( sorted.begin(), sorted.end() ) ;
+        const auto pos = q * ( sorted.size() - 1 ) ;
+        const auto low = static_cast<std::size_t>( pos ) ;
+        const auto high = std::min( low + 1, sorted.size() - 1 ) ;
+        return sorted[low] + ( pos - low ) * ( sorted[high] - sorted[low] ) ;
+      }
+
+      /// Get the median of the samples
+      double median() const {
+        return quantile( 0.5 ) ;
+      }
+
+      /// Get the median absolute deviation of the samples
+      double mad() const {
+        const auto med = median() ;
+        result dev ;
+        for( const auto s : _samples ) {
+          dev._samples.push_back( std::fabs( s - med ) ) ;
+        }
+        return dev.median() ;
+      }
+    };
+
+    /**
+     *  @brief  runner class.
+     *
+     *  Run the benchmarks and collect the results. Each benchmark is first
+     *  calibrated: the number of iterations per repetition is doubled until
+     *  a repetition lasts at least the configured minimal time. A few
+     *  warm-up repetitions are then run and discarded before the measured
+     *  ones. The results are reported by their median and spread, which are
+     *  robust against the outliers caused by the system noise.
+     */
+    class runner {
+    public:
+      using clock = std::chrono::steady_clock ;
+
+    public:
+      /**
+       *  @brief  Constructor
+       *
+       *  @param  tool the benchmark tool name
+       *  @param  cfg the run settings
+       */
+      runner( const std::string &tool, const config &cfg ) :
+        _tool( tool ),
+        _config( cfg ) {
+        /* nop */
+      }
+
+      /**
+       *  @brief  Whether a benchmark is selected by the name filter
+       *
+       *  @param  name the benchmark name
+       */
+      bool selected( const std::string &name ) const {
+        return _config._filter.empty() or ( name.find( _config._filter ) != std::string::npos ) ;
+      }
+
+      /**
+       *  @brief  Measure a function called once per iteration
+       *
+       *  @param  name the benchmark name
+       *  @param  bytes the number of bytes processed per iteration
+       *  @param  items the number of items processed per iteration
+       *  @param  func the function to measure
+       */
+      template <typename Func>
+      void run( const std::string &name, std::size_t bytes, std::size_t items, Func func ) {
+        if( not selected( name ) ) {
+          return ;
+        }
+        result res ;
+        res._name = name ;
+        res._bytes = bytes ;
+        res._items = items ;
+        // calibrate the number of iterations
+        std::size_t iterations = 1 ;
+        while( true ) {
+          const auto elapsed = repetition( iterations, func ) ;
+          if( elapsed >= _config._min_time or iterations >= ( std::size_t(1) << 30 ) ) {
+            break ;
+          }
+          // aim directly at the target time when the measurement is meaningful
+          const auto factor = ( elapsed > _config._min_time / 100. ) ? ( 1.2 * _config._min_time / elapsed ) : 10. ;
+          iterations = std::max( iterations + 1, static_cast<std::size_t>( iterations * std::min( factor, 10. ) ) ) ;
+        }
+        res._iterations = iterations ;
+        for( std::size_t i=0 ; i<_config._warmup ; i++ ) {
+          repetition( iterations, func ) ;
+        }
+        for( std::size_t i=0 ; i<_config._repetitions ; i++ ) {
+          res._samples.push_back( 1e9 * repetition( iterations, func ) / iterations ) ;
+        }
+        print( res ) ;
+        _results.push_back( std::move( res ) ) ;
+      }
+
+      /**
+       *  @brief  Get the collected results
+       */
+      const std::vector<result> &results() const {
+        return _results ;
+      }
+
+      /**
+       *  @brief  Add a context entry written in the JSON output
+       *
+       *  @param  key the entry key
+       *  @param  value the entry value
+       */
+      void add_context( const std::string &key, const std::string &value ) {
+        _context.emplace_back( key, value ) ;
+      }
+
+      /**
+       *  @brief  Write the results as JSON
+       *
+       *  @param  out the output stream
+       */
+      void write_json( std::ostream &out ) const {
+        char date[64] ;
+        const auto now = std::time( nullptr ) ;
+        std::strftime( date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime( &now ) ) ;
+        out << std::setprecision(6) ;
+        out << "{\n" ;
+        out << "  \"tool\": \"" << json_escape( _tool ) << "\",\n" ;
+        out << "  \"context\": {\n" ;
+        out << "    \"date\": \"" << date << "\",\n" ;
+        out << "    \"sio_version\": \"" << SIO_BENCH_VERSION << "\",\n" ;
+        out << "    \"compiler\": \"" << json_escape( compiler() ) << "\",\n" ;
+        out << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n" ;
+        out << "    \"repetitions\": " << _config._repetitions << ",\n" ;
+        out << "    \"warmup\": " << _config._warmup << ",\n" ;
+        out << "    \"min_time_s\": " << _config._min_time ;
+        for( const auto &entry : _context ) {
+          out << ",\n    \"" << json_escape( entry.first ) << "\": \"" << json_escape( entry.second ) << "\"" ;
+        }
+        out << "\n  },\n" ;
+        out << "  \"benchmarks\": [" ;
+        for( std::size_t i=0 ; i<_results.size() ; i++ ) {
+          const auto &res = _results[i] ;
+          const auto median = res.median() ;
+          out << ( i == 0 ? "\n" : ",\n" ) ;
+          out << "    {\n" ;
+          out << "      \"name\": \"" << json_escape( res._name ) << "\",\n" ;
+          out << "      \"bytes_per_iteration\": " << res._bytes << ",\n" ;
+          out << "      \"items_per_iteration\": " << res._items << ",\n" ;
+          out << "      \"iterations\": " << res._iterations << ",\n" ;
+          out << "      \"repetitions\": " << res._samples.size() << ",\n" ;
+          out << "      \"ns_min\": " << res.min() << ",\n" ;
+          out << "      \"ns_median\": " << median << ",\n" ;
+          out << "      \"ns_mean\": " << res.mean() << ",\n" ;
+          out << "      \"ns_max\": " << res.max() << ",\n" ;
+          out << "      \"ns_stddev\": " << res.stddev() << ",\n" ;
+          out << "      \"ns_mad\": " << res.mad() << ",\n" ;
+          out << "      \"ns_p90\": " << res.quantile( 0.9 ) << ",\n" ;
+          out << "      \"bytes_per_second\": " << ( median > 0. ? 1e9 * res._bytes / median : 0. ) << ",\n" ;
+          out << "      \"items_per_second\": " << ( median > 0. ? 1e9 * res._items / median : 0. ) << "\n" ;
+          out << "    }" ;
+        }
+        out << "\n  ]\n" ;
+        out << "}" << std::endl ;
+      }
+
+    private:
+      /// Run a repetition of the function and get the elapsed time in seconds
+      template <typename Func>
+      static double repetition( std::size_t iterations, Func &func ) {
+        const auto start = clock::now() ;
+        for( std::size_t i=0 ; i<iterations ; i++ ) {
+          func() ;
+          clobber_memory() ;
+        }
+        return std::chrono::duration<double>( clock::now() - start ).count() ;
+      }
+
+      /// Print a summary line of a result on the standard error
+      static void print( const result &res ) {
+        const auto median = res.median() ;
+        std::cerr <<
+          std::setw(50) << std::left << res._name << " " <<
+          std::setw(12) << std::right << std::fixed << std::setprecision(1) << median << " ns " <<
+          "+/- " << std::setw(5) << std::setprecision(1) << ( median > 0. ? 100. * res.mad() / median : 0. ) << "% " ;
+        if( res._bytes > 0 and median > 0. ) {
+          std::cerr << std::setw(10) << std::setprecision(1) << ( 1e3 * res._bytes / median ) << " MB/s" ;
+        }
+        std::cerr << std::defaultfloat << std::left << std::endl ;
+      }
+
+    private:
+      ///< The benchmark tool name
+      const std::string                                    _tool ;
+      ///< The run settings
+      const config                                         _config ;
+      ///< The additional context entries
+      std::vector<std::pair<std::string, std::string>>     _context {} ;
+      ///< The collected results
+      std::vector<result>                                  _results {} ;
+    };
+
+  }
+
+}
@@ -0,0 +1,262 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/api.h>
+#include <sio/block.h>
+#include <sio/buffer.h>
+#include <sio/compression/zlib.h>
+#include <sio/io_device.h>
+#include <sio/memcpy.h>
+#include <sio/version.h>
+// -- sio bench headers
+#include <siobench/benchmark.h>
+// -- std headers
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+constexpr const char *USAGE = R"(Usage: sio-bench-micro [-r REPETITIONS] [-w WARMUP] [-t MINTIME] [-f FILTER] [-o OUTPUT])";
+
+constexpr const char *HELP = R"(Run the micro benchmarks of the SIO hot paths and write the results as JSON
+
+Optional arguments:
+  -h, --help       Show the help message and exit
+  -r REPETITIONS   The number of measured repetitions per benchmark (default 15)
+  -w WARMUP        The number of warm-up repetitions per benchmark (default 2)
+  -t MINTIME       The minimal duration of a repetition in seconds (default 0.01)
+  -f FILTER        Only run the benchmarks whose name contains FILTER
+  -o OUTPUT        Write the JSON results to OUTPUT instead of the standard output
+)";
+
+namespace {
+
+  /**
+   *  @brief  A block holding an array of floats: a smooth signal plus
+   *          some noise, to get compression ratios close to real data
+   */
+  class float_block : public sio::block {
+  public:
+    float_block( const std::string &nam, std::size_t nfloats, std::uint32_t seed ) :
+      sio::block( nam, sio::version::encode_version( 1, 0 ) ),
+      _data( nfloats ) {
+      std::uint32_t state = seed * 2654435761u + 1 ;
+      for( std::size_t i=0 ; i<nfloats ; i++ ) {
+        state = state * 1664525u + 1013904223u ;
+        // digitized values: a signal and 3 bits of noise in units of 1/64
+        const auto counts = static_cast<int>( 1000.f * std::sin( 0.01f * ( i + seed ) ) ) + static_cast<int>( state >> 29 ) ;
+        _data[i] = counts / 64.f ;
+      }
+    }
+
+    void read( sio::read_device &device, sio::version_type /*vers*/ ) override {
+      device.data( _data ) ;
+    }
+
+    void write( sio::write_device &device ) override {
+      device.data( _data ) ;
+    }
+
+  private:
+    ///< The block data
+    std::vector<float>         _data {} ;
+  };
+
+  /**
+   *  @brief  Write a record of nblocks blocks of nfloats floats
+   */
+  sio::record_info make_record( sio::buffer &rec_buf, std::size_t nblocks, std::size_t nfloats ) {
+    sio::block_list blocks ;
+    for( std::size_t b=0 ; b<nblocks ; b++ ) {
+      blocks.push_back( std::make_shared<float_block>( "block_" + std::to_string( b ), nfloats, b ) ) ;
+    }
+    return sio::api::write_record( "bench_record", rec_buf, blocks, 0 ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void bench_memcpy( sio::bench::runner &runner ) {
+    for( const std::size_t size : { 1, 2, 4, 8 } ) {
+      for( const std::size_t count : { 16, 1024, 65536 } ) {
+        std::vector<sio::byte> from( size * count, 1 ), dest( size * count, 0 ) ;
+        const auto name = "memcpy/copy/size:" + std::to_string( size ) + "/count:" + std::to_string( count ) ;
+        runner.run( name, size * count, count, [&]{
+          sio::memcpy::copy( from.data(), dest.data(), size, count ) ;
+          sio::bench::do_not_optimize( dest.data() ) ;
+        }) ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  void bench_api_type( sio::bench::runner &runner, const std::string &type ) {
+    sio::buffer buf( sio::mbyte ) ;
+    T scalar = T(42) ;
+    runner.run( "api/write/scalar/" + type, sizeof(T), 1, [&]{
+      sio::api::write( buf, &scalar, 0, 1 ) ;
+      sio::bench::do_not_optimize( buf.data() ) ;
+    }) ;
+    runner.run( "api/read/scalar/" + type, sizeof(T), 1, [&]{
+      sio::api::read( buf.span(), &scalar, 0, 1 ) ;
+      sio::bench::do_not_optimize( scalar ) ;
+    }) ;
+    for( const std::size_t count : { 16, 1024, 65536 } ) {
+      std::vector<T> array( count, T(3) ) ;
+      const auto suffix = type + "/count:" + std::to_string( count ) ;
+      runner.run( "api/write/array/" + suffix, sizeof(T) * count, count, [&]{
+        sio::api::write( buf, array.data(), 0, count ) ;
+        sio::bench::do_not_optimize( buf.data() ) ;
+      }) ;
+      runner.run( "api/read/array/" + suffix, sizeof(T) * count, count, [&]{
+        sio::api::read( buf.span(), array.data(), 0, count ) ;
+        sio::bench::do_not_optimize( array.data() ) ;
+      }) ;
+    }
+  }
+
+  void bench_api( sio::bench::runner &runner ) {
+    bench_api_type<char>( runner, "char" ) ;
+    bench_api_type<short>( runner, "short" ) ;
+    bench_api_type<int>( runner, "int" ) ;
+    bench_api_type<float>( runner, "float" ) ;
+    bench_api_type<double>( runner, "double" ) ;
+    bench_api_type<std::int64_t>( runner, "int64" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void bench_relocation( sio::bench::runner &runner ) {
+    for( const std::size_t npointers : { 1000, 10000, 100000, 1000000 } ) {
+      const auto suffix = "/pointers:" + std::to_string( npointers ) ;
+      if( not runner.selected( "relocation/write" + suffix ) and not runner.selected( "relocation/read" + suffix ) ) {
+        continue ;
+      }
+      // one object pointed at by one pointer each, as written by SIO_PTAG / SIO_PNTR
+      std::vector<sio::ptr_type> pointers( npointers, 0 ) ;
+      std::vector<sio::ptr_type> objects( npointers, 0 ) ;
+      sio::buffer rec_buf( 2 * sizeof(sio::ptr_type) * npointers + sio::kbyte ) ;
+      sio::pointed_at_map write_pointed_at, read_pointed_at ;
+      sio::pointer_to_map write_pointer_to, read_pointer_to ;
+      for( std::size_t i=0 ; i<npointers ; i++ ) {
+        const auto key = reinterpret_cast<void*>( ( i + 1 ) * sizeof(sio::ptr_type) ) ;
+        // on write: the positions of the pointed objects and pointers in the record
+        write_pointed_at.emplace( key, reinterpret_cast<void*>( i * sizeof(sio::ptr_type) ) ) ;
+        write_pointer_to.emplace( key, reinterpret_cast<void*>( ( npointers + i ) * sizeof(sio::ptr_type) ) ) ;
+        // on read: the addresses of the objects and pointers in memory
+        read_pointed_at.emplace( key, &objects[i] ) ;
+        read_pointer_to.emplace( key, &pointers[i] ) ;
+      }
+      runner.run( "relocation/write" + suffix, 0, npointers, [&]{
+        sio::api::write_relocation( rec_buf.data(), write_pointed_at, write_pointer_to ) ;
+        sio::bench::do_not_optimize( rec_buf.data() ) ;
+      }) ;
+      runner.run( "relocation/read" + suffix, 0, npointers, [&]{
+        sio::api::read_relocation( read_pointed_at, read_pointer_to ) ;
+        sio::bench::do_not_optimize( pointers.data() ) ;
+      }) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void bench_blocks( sio::bench::runner &runner ) {
+    for( const std::size_t nblocks : { 1, 16, 256 } ) {
+      sio::buffer rec_buf( sio::kbyte ) ;
+      const auto rec_info = make_record( rec_buf, nblocks, 16 ) ;
+      const auto data = rec_buf.span( rec_info._header_length, rec_info._data_length ) ;
+      const auto suffix = "/blocks:" + std::to_string( nblocks ) ;
+      runner.run( "api/extract_block" + suffix, data.size(), nblocks, [&]{
+        sio::buffer_span::index_type index = 0 ;
+        sio::block_info_view info ;
+        while( index < data.size() ) {
+          index += sio::api::extract_block( data, index, info ).size() ;
+        }
+        sio::bench::do_not_optimize( info ) ;
+      }) ;
+      runner.run( "api/read_block_infos" + suffix, data.size(), nblocks, [&]{
+        const auto infos = sio::api::read_block_infos( data ) ;
+        sio::bench::do_not_optimize( infos.data() ) ;
+      }) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void bench_zlib( sio::bench::runner &runner ) {
+    // a record of 64 blocks of 4096 floats (1 MB)
+    sio::buffer rec_buf( sio::kbyte ) ;
+    const auto rec_info = make_record( rec_buf, 64, 4096 ) ;
+    const auto data = rec_buf.span( rec_info._header_length, rec_info._data_length ) ;
+    sio::buffer comp_buf( sio::kbyte ) ;
+    sio::buffer uncomp_buf( data.size() ) ;
+    sio::zlib_compression compressor ;
+    for( int level=0 ; level<=9 ; level++ ) {
+      const auto suffix = "/level:" + std::to_string( level ) ;
+      if( not runner.selected( "zlib/compress" + suffix ) and not runner.selected( "zlib/uncompress" + suffix ) ) {
+        continue ;
+      }
+      compressor.set_level( level ) ;
+      runner.run( "zlib/compress" + suffix, data.size(), 1, [&]{
+        compressor.compress( data, comp_buf ) ;
+        sio::bench::do_not_optimize( comp_buf.data() ) ;
+      }) ;
+      compressor.compress( data, comp_buf ) ;
+      runner.add_context( "zlib_ratio" + suffix, std::to_string( static_cast<double>( data.size() ) / comp_buf.size() ) ) ;
+      runner.run( "zlib/uncompress" + suffix, data.size(), 1, [&]{
+        uncomp_buf.resize( data.size() ) ;
+        compressor.uncompress( comp_buf.span(), uncomp_buf ) ;
+        sio::bench::do_not_optimize( uncomp_buf.data() ) ;
+      }) ;
+    }
+  }
+
+}
+
+/**
+ *  @brief  Micro benchmarks of the sio hot paths
+ */
+int main( int argc, char **argv ) {
+  for( int i=1 ; i<argc ; i++ ) {
+    const std::string arg = argv[i] ;
+    if( arg == "-h" or arg == "--help" ) {
+      std::cout << USAGE << "\n\n" ;
+      std::cout << HELP << std::endl ;
+      return 0 ;
+    }
+  }
+  sio::bench::config cfg ;
+  if( not cfg.parse( argc, argv ) ) {
+    std::cout << USAGE << std::endl ;
+    return 1 ;
+  }
+  try {
+    sio::bench::runner runner( "sio-bench-micro", cfg ) ;
+    bench_memcpy( runner ) ;
+    bench_api( runner ) ;
+    bench_relocation( runner ) ;
+    bench_blocks( runner ) ;
+    bench_zlib( runner ) ;
+    if( cfg._output.empty() ) {
+      runner.write_json( std::cout ) ;
+    }
+    else {
+      std::ofstream out( cfg._output ) ;
+      runner.write_json( out ) ;
+      if( not out.good() ) {
+        std::cerr << "ERROR: couldn't write the results to '" << cfg._output << "'" << std::endl ;
+        return 1 ;
+      }
+      std::cout << "Written " << runner.results().size() << " benchmark results to " << cfg._output << std::endl ;
+    }
+  }
+  catch( const sio::exception &e ) {
+    std::cerr << "ERROR: " << e.what() << std::endl ;
+    return 1 ;
+  }
+  return 0 ;
+}
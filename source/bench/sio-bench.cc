@@ -0,0 +1,599 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/api.h>
+#include <sio/block.h>
+#include <sio/buffer.h>
+#include <sio/compression/zlib.h>
+#include <sio/concurrent_writer.h>
+#include <sio/exception.h>
+#include <sio/io_device.h>
+#include <sio/pread_reader.h>
+#include <sio/record_index.h>
+#include <sio/version.h>
+// -- sio bench headers
+#include <siobench/benchmark.h>
+// -- std headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+constexpr const char *USAGE = R"(Usage: sio-bench [-n NRECORDS] [-b NBLOCKS] [-a ARRAYSIZE] [-s NSTRINGS] [-p NPOINTERS] [-z LEVEL] [-j MAXTHREADS] [-r REPETITIONS] [-d DIR] [-o OUTPUT] [--seed SEED] [-k/--keep])";
+
+constexpr const char *HELP = R"(Generate a synthetic event file and measure the write and read throughput at 1..MAXTHREADS threads
+
+Optional arguments:
+  -h, --help       Show the help message and exit
+  -n NRECORDS      The number of records (default 10000)
+  -b NBLOCKS       The number of blocks per record (default 4)
+  -a ARRAYSIZE     The mean number of floats per block (default 1000)
+  -s NSTRINGS      The number of strings per block (default 10)
+  -p NPOINTERS     The number of pointers per block, to as many tagged objects (default 100)
+  -z LEVEL         The zlib compression level (0-9), -1 to write uncompressed records (default 6)
+  -j MAXTHREADS    The maximum number of threads (default: hardware threads).
+                   The runs use 1, 2, 4, ... and MAXTHREADS threads
+  -r REPETITIONS   The number of runs per thread count, the median run is reported (default 3)
+  -d DIR           The directory to write the benchmark file to (default .)
+                   Use a tmpfs directory (e.g /dev/shm) to measure without the disk
+  -o OUTPUT        Also write the results as JSON to OUTPUT
+  --seed SEED      The seed of the data generator (default 42)
+  -k, --keep       Keep the benchmark file and its index
+
+Note that the files are read back right after being written, so the reads are usually
+served by the page cache. Use a file larger than the memory to measure the disk reads.
+)";
+
+namespace {
+
+  /**
+   *  @brief  The workload settings
+   */
+  struct workload {
+    ///< The number of records
+    std::size_t                 _records {10000} ;
+    ///< The number of blocks per record
+    std::size_t                 _blocks {4} ;
+    ///< The mean number of floats per block
+    std::size_t                 _array_size {1000} ;
+    ///< The number of strings per block
+    std::size_t                 _strings {10} ;
+    ///< The number of pointers per block
+    std::size_t                 _pointers {100} ;
+    ///< The compression level (negative: no compression)
+    int                         _level {6} ;
+    ///< The data generator seed
+    std::uint64_t               _seed {42} ;
+  };
+
+  /**
+   *  @brief  A portable pseudo random generator (splitmix64),
+   *          for identical files on all platforms
+   */
+  class generator {
+  public:
+    generator( std::uint64_t seed ) :
+      _state( seed ) {
+      /* nop */
+    }
+
+    std::uint64_t next() {
+      std::uint64_t z = ( _state += 0x9e3779b97f4a7c15ULL ) ;
+      z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL ;
+      z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL ;
+      return z ^ ( z >> 31 ) ;
+    }
+
+    /// Get a number in [0, n)
+    std::size_t uniform( std::size_t n ) {
+      return ( n == 0 ) ? 0 : static_cast<std::size_t>( next() % n ) ;
+    }
+
+  private:
+    ///< The generator state
+    std::uint64_t               _state ;
+  };
+
+  /**
+   *  @brief  A tagged object, target of the block pointers
+   */
+  struct hit {
+    ///< The hit id
+    int                         _id {0} ;
+    ///< The hit energy
+    float                       _energy {0.f} ;
+    ///< The hit position
+    float                       _position[3] {0.f, 0.f, 0.f} ;
+  };
+
+  /**
+   *  @brief  A synthetic event block: a float array, strings,
+   *          tagged objects and pointers to them
+   */
+  class event_block : public sio::block {
+  public:
+    event_block( const std::string &nam ) :
+      sio::block( nam, sio::version::encode_version( 1, 0 ) ) {
+      /* nop */
+    }
+
+    /// Fill the block with random data
+    void generate( generator &gen, const workload &wl ) {
+      _values.resize( wl._array_size / 2 + gen.uniform( wl._array_size + 1 ) ) ;
+      // digitized values: a signal with a few bits of noise
+      const auto phase = gen.uniform( 1000 ) ;
+      for( std::size_t i=0 ; i<_values.size() ; i++ ) {
+        _values[i] = ( static_cast<int>( 100 * ( ( i + phase ) % 50 ) ) + static_cast<int>( gen.uniform( 8 ) ) ) / 64.f ;
+      }
+      _strings.resize( wl._strings ) ;
+      for( auto &str : _strings ) {
+        str = "collection_" + std::to_string( gen.uniform( 1000 ) ) ;
+        str.append( gen.uniform( 24 ), 'x' ) ;
+      }
+      _hits.resize( wl._pointers ) ;
+      for( std::size_t i=0 ; i<_hits.size() ; i++ ) {
+        _hits[i]._id = static_cast<int>( i ) ;
+        _hits[i]._energy = gen.uniform( 10000 ) / 100.f ;
+        for( auto &coord : _hits[i]._position ) {
+          coord = static_cast<float>( gen.uniform( 4096 ) ) / 8.f ;
+        }
+      }
+      _links.resize( wl._pointers ) ;
+      for( auto &link : _links ) {
+        link = &_hits[gen.uniform( _hits.size() )] ;
+      }
+    }
+
+    /// Get the number of items (values, strings, hits and resolved pointers)
+    std::size_t items() const {
+      const auto resolved = std::count_if( _links.begin(), _links.end(), []( const hit *h ){ return nullptr != h ; } ) ;
+      return _values.size() + _strings.size() + _hits.size() + resolved ;
+    }
+
+    void read( sio::read_device &device, sio::version_type /*vers*/ ) override {
+      SIO_SDATA( device, _values ) ;
+      SIO_SDATA( device, _strings ) ;
+      unsigned int nhits {0}, nlinks {0} ;
+      SIO_DATA( device, &nhits, 1 ) ;
+      _hits.resize( nhits ) ;
+      for( auto &h : _hits ) {
+        hit_data( h, device ) ;
+        SIO_PTAG( device, &h ) ;
+      }
+      SIO_DATA( device, &nlinks, 1 ) ;
+      _links.assign( nlinks, nullptr ) ;
+      for( auto &link : _links ) {
+        SIO_PNTR( device, &link ) ;
+      }
+    }
+
+    void write( sio::write_device &device ) override {
+      SIO_SDATA( device, _values ) ;
+      SIO_SDATA( device, _strings ) ;
+      const unsigned int nhits = _hits.size() ;
+      const unsigned int nlinks = _links.size() ;
+      SIO_DATA( device, &nhits, 1 ) ;
+      for( auto &h : _hits ) {
+        hit_data( h, device ) ;
+        SIO_PTAG( device, &h ) ;
+      }
+      SIO_DATA( device, &nlinks, 1 ) ;
+      for( auto &link : _links ) {
+        SIO_PNTR( device, &link ) ;
+      }
+    }
+
+  private:
+    template <class devT>
+    static void hit_data( hit &h, devT &device ) {
+      SIO_DATA( device, &h._id, 1 ) ;
+      SIO_DATA( device, &h._energy, 1 ) ;
+      SIO_DATA( device, h._position, 3 ) ;
+    }
+
+  private:
+    ///< The float array
+    std::vector<float>          _values {} ;
+    ///< The strings
+    std::vector<std::string>    _strings {} ;
+    ///< The tagged objects
+    std::vector<hit>            _hits {} ;
+    ///< The pointers to the tagged objects
+    std::vector<hit*>           _links {} ;
+  };
+
+  /**
+   *  @brief  The time spent in each stage, summed over the threads (seconds)
+   */
+  struct stage_times {
+    ///< Block serialization (write) or decoding with pointer relocation (read)
+    double                      _codec {0.} ;
+    ///< Compression (write) or decompression (read)
+    double                      _compression {0.} ;
+    ///< File writes or reads
+    double                      _io {0.} ;
+
+    void add( const stage_times &other ) {
+      _codec += other._codec ;
+      _compression += other._compression ;
+      _io += other._io ;
+    }
+  };
+
+  /**
+   *  @brief  The measurement of a write or read run
+   */
+  struct run_result {
+    ///< The number of threads
+    unsigned int                _threads {1} ;
+    ///< The wall clock time (seconds)
+    double                      _wall {0.} ;
+    ///< The per stage times
+    stage_times                 _stages {} ;
+    ///< The number of uncompressed record bytes
+    std::uint64_t               _bytes {0} ;
+    ///< The number of bytes in the file
+    std::uint64_t               _file_bytes {0} ;
+    ///< The number of items written or decoded (consistency check)
+    std::uint64_t               _items {0} ;
+  };
+
+  using clock = std::chrono::steady_clock ;
+
+  double seconds_since( const clock::time_point &start ) {
+    return std::chrono::duration<double>( clock::now() - start ).count() ;
+  }
+
+  sio::block_list make_blocks( const workload &wl ) {
+    sio::block_list blocks ;
+    for( std::size_t b=0 ; b<wl._blocks ; b++ ) {
+      blocks.push_back( std::make_shared<event_block>( "event_" + std::to_string( b ) ) ) ;
+    }
+    return blocks ;
+  }
+
+  /**
+   *  @brief  Run threads on a function, rethrow the first error
+   */
+  template <typename Func>
+  void run_threads( unsigned int nthreads, Func func ) {
+    std::vector<std::thread> threads ;
+    std::exception_ptr error {} ;
+    std::mutex error_mutex ;
+    for( unsigned int t=0 ; t<nthreads ; t++ ) {
+      threads.emplace_back( [&, t]{
+        try {
+          func( t ) ;
+        }
+        catch( ... ) {
+          std::lock_guard<std::mutex> lock( error_mutex ) ;
+          if( not error ) {
+            error = std::current_exception() ;
+          }
+        }
+      }) ;
+    }
+    for( auto &thread : threads ) {
+      thread.join() ;
+    }
+    if( error ) {
+      std::rethrow_exception( error ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  Write the records with nthreads threads, record i being written by thread i % nthreads
+   */
+  run_result write_file( const std::string &fname, const workload &wl, unsigned int nthreads ) {
+    run_result result ;
+    result._threads = nthreads ;
+    std::vector<run_result> thread_results( nthreads ) ;
+    const auto start = clock::now() ;
+    sio::concurrent_writer writer( fname ) ;
+    run_threads( nthreads, [&]( unsigned int t ) {
+      auto &res = thread_results[t] ;
+      auto blocks = make_blocks( wl ) ;
+      sio::buffer buf( sio::mbyte ) ;
+      sio::buffer compbuf( sio::mbyte ) ;
+      sio::zlib_compression compressor ;
+      if( wl._level >= 0 ) {
+        compressor.set_level( wl._level ) ;
+      }
+      for( std::size_t i=t ; i<wl._records ; i+=nthreads ) {
+        // the data generation is not measured
+        generator gen( wl._seed ^ ( i * 0x9e3779b97f4a7c15ULL ) ) ;
+        for( auto &blk : blocks ) {
+          auto &event = static_cast<event_block&>( *blk ) ;
+          event.generate( gen, wl ) ;
+          res._items += event.items() ;
+        }
+        auto stage_start = clock::now() ;
+        auto rec_info = sio::api::write_record( "event", buf, blocks, 0 ) ;
+        res._stages._codec += seconds_since( stage_start ) ;
+        res._bytes += rec_info._header_length + rec_info._uncompressed_length ;
+        if( wl._level >= 0 ) {
+          stage_start = clock::now() ;
+          sio::api::compress_record( rec_info, buf, compbuf, compressor ) ;
+          res._stages._compression += seconds_since( stage_start ) ;
+          stage_start = clock::now() ;
+          writer.write_record( buf.span( 0, rec_info._header_length ), compbuf.span(), rec_info, i ) ;
+        }
+        else {
+          stage_start = clock::now() ;
+          writer.write_record( buf.span(), rec_info, i ) ;
+        }
+        res._stages._io += seconds_since( stage_start ) ;
+      }
+    }) ;
+    const auto stage_start = clock::now() ;
+    writer.close() ;
+    result._stages._io += seconds_since( stage_start ) ;
+    result._wall = seconds_since( start ) ;
+    result._file_bytes = writer.size() ;
+    for( const auto &res : thread_results ) {
+      result._stages.add( res._stages ) ;
+      result._bytes += res._bytes ;
+      result._items += res._items ;
+    }
+    return result ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  Read back the records with nthreads threads, using the record index
+   */
+  run_result read_file( const std::string &fname, const workload &wl, unsigned int nthreads ) {
+    run_result result ;
+    result._threads = nthreads ;
+    std::vector<run_result> thread_results( nthreads ) ;
+    const auto start = clock::now() ;
+    sio::record_index index ;
+    index.read( sio::record_index::sidecar_name( fname ) ) ;
+    const sio::pread_reader reader( fname ) ;
+    if( index.size() != wl._records ) {
+      SIO_THROW( sio::error_code::bad_state, "The record index holds " + std::to_string( index.size() ) + " records" ) ;
+    }
+    run_threads( nthreads, [&]( unsigned int t ) {
+      auto &res = thread_results[t] ;
+      auto blocks = make_blocks( wl ) ;
+      sio::record_info rec_info ;
+      sio::buffer rec_buf( sio::mbyte ) ;
+      sio::buffer uncomp_buf( sio::mbyte ) ;
+      sio::zlib_compression compressor ;
+      for( std::size_t i=t ; i<index.size() ; i+=nthreads ) {
+        auto stage_start = clock::now() ;
+        reader.read_record( index.at( i )._position, rec_info, rec_buf ) ;
+        res._stages._io += seconds_since( stage_start ) ;
+        auto data = rec_buf.span( rec_info._header_length, rec_info._data_length ) ;
+        if( sio::api::is_compressed( rec_info._options ) ) {
+          stage_start = clock::now() ;
+          uncomp_buf.resize( rec_info._uncompressed_length ) ;
+          compressor.uncompress( data, uncomp_buf ) ;
+          res._stages._compression += seconds_since( stage_start ) ;
+          data = uncomp_buf.span() ;
+        }
+        stage_start = clock::now() ;
+        sio::api::read_blocks( data, blocks ) ;
+        res._stages._codec += seconds_since( stage_start ) ;
+        res._bytes += rec_info._header_length + rec_info._uncompressed_length ;
+        for( const auto &blk : blocks ) {
+          res._items += static_cast<const event_block&>( *blk ).items() ;
+        }
+      }
+    }) ;
+    result._wall = seconds_since( start ) ;
+    result._file_bytes = reader.file_size() ;
+    for( const auto &res : thread_results ) {
+      result._stages.add( res._stages ) ;
+      result._bytes += res._bytes ;
+      result._items += res._items ;
+    }
+    return result ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  /// Get the median run of a set of repetitions (by wall time)
+  run_result median_run( std::vector<run_result> runs ) {
+    std::sort( runs.begin(), runs.end(), []( const run_result &lhs, const run_result &rhs ) {
+      return lhs._wall < rhs._wall ;
+    }) ;
+    return runs[runs.size() / 2] ;
+  }
+
+  void print_result( const char *mode, const run_result &res, std::size_t nrecords ) {
+    const auto busy = std::max( res._stages._codec + res._stages._compression + res._stages._io, 1e-12 ) ;
+    std::cout <<
+      std::setw(6) << std::left << mode << " | " <<
+      std::setw(7) << res._threads << " | " <<
+      std::setw(9) << std::fixed << std::setprecision(1) << ( res._bytes / res._wall / 1e6 ) << " | " <<
+      std::setw(10) << std::setprecision(0) << ( nrecords / res._wall ) << " | " <<
+      std::setw(8) << std::setprecision(3) << res._wall << " | " <<
+      std::setw(15) << std::setprecision(1) << ( 100. * res._stages._codec / busy ) << " | " <<
+      std::setw(14) << ( 100. * res._stages._compression / busy ) << " | " <<
+      std::setw(6) << ( 100. * res._stages._io / busy ) <<
+      std::defaultfloat << std::endl ;
+  }
+
+  void write_json_run( std::ostream &out, const char *mode, const run_result &res, std::size_t nrecords ) {
+    out << "    {\n" ;
+    out << "      \"mode\": \"" << mode << "\",\n" ;
+    out << "      \"threads\": " << res._threads << ",\n" ;
+    out << "      \"wall_s\": " << res._wall << ",\n" ;
+    out << "      \"bytes\": " << res._bytes << ",\n" ;
+    out << "      \"file_bytes\": " << res._file_bytes << ",\n" ;
+    out << "      \"mb_per_s\": " << ( res._bytes / res._wall / 1e6 ) << ",\n" ;
+    out << "      \"records_per_s\": " << ( nrecords / res._wall ) << ",\n" ;
+    out << "      \"codec_s\": " << res._stages._codec << ",\n" ;
+    out << "      \"compression_s\": " << res._stages._compression << ",\n" ;
+    out << "      \"io_s\": " << res._stages._io << "\n" ;
+    out << "    }" ;
+  }
+
+  /**
+   *  @brief  Get an option value, or the default value if the option is absent
+   */
+  std::string option_val( std::vector<std::string> &args, const char *opt, const std::string &def_val ) {
+    const auto it = std::find( args.begin(), args.end(), opt ) ;
+    if( it == args.end() ) {
+      return def_val ;
+    }
+    if( it + 1 == args.end() ) {
+      std::cout << USAGE << std::endl ;
+      std::exit( 1 ) ;
+    }
+    const auto value = *( it + 1 ) ;
+    args.erase( it, it + 2 ) ;
+    return value ;
+  }
+
+  bool has_option( std::vector<std::string> &args, const char *opt_s, const char *opt_l ) {
+    const auto it = std::find_if( args.begin(), args.end(), [&]( const std::string &arg ) {
+      return arg == opt_s or arg == opt_l ;
+    }) ;
+    if( it == args.end() ) {
+      return false ;
+    }
+    args.erase( it ) ;
+    return true ;
+  }
+
+}
+
+/**
+ *  @brief  End-to-end write and read throughput benchmark on a synthetic workload
+ */
+int main( int argc, char **argv ) {
+  std::vector<std::string> args( argv + 1, argv + argc ) ;
+  if( has_option( args, "-h", "--help" ) ) {
+    std::cout << USAGE << "\n\n" ;
+    std::cout << HELP << std::endl ;
+    return 0 ;
+  }
+  workload wl ;
+  unsigned int max_threads {0} ;
+  std::size_t repetitions {0} ;
+  std::string dir, output ;
+  bool keep {false} ;
+  try {
+    wl._records = std::stoul( option_val( args, "-n", "10000" ) ) ;
+    wl._blocks = std::stoul( option_val( args, "-b", "4" ) ) ;
+    wl._array_size = std::stoul( option_val( args, "-a", "1000" ) ) ;
+    wl._strings = std::stoul( option_val( args, "-s", "10" ) ) ;
+    wl._pointers = std::stoul( option_val( args, "-p", "100" ) ) ;
+    wl._level = std::stoi( option_val( args, "-z", "6" ) ) ;
+    wl._seed = std::stoull( option_val( args, "--seed", "42" ) ) ;
+    max_threads = std::stoul( option_val( args, "-j", std::to_string( std::max( std::thread::hardware_concurrency(), 1u ) ) ) ) ;
+    repetitions = std::stoul( option_val( args, "-r", "3" ) ) ;
+    dir = option_val( args, "-d", "." ) ;
+    output = option_val( args, "-o", "" ) ;
+    keep = has_option( args, "-k", "--keep" ) ;
+  }
+  catch( const std::logic_error & ) {
+    std::cout << USAGE << std::endl ;
+    return 1 ;
+  }
+  if( not args.empty() or 0 == max_threads or 0 == repetitions or 0 == wl._records ) {
+    std::cout << USAGE << std::endl ;
+    return 1 ;
+  }
+  std::vector<unsigned int> thread_counts ;
+  for( unsigned int t=1 ; t<max_threads ; t*=2 ) {
+    thread_counts.push_back( t ) ;
+  }
+  thread_counts.push_back( max_threads ) ;
+  const auto fname = dir + "/sio-bench.sio" ;
+  try {
+    std::cout << "Workload: " << wl._records << " records, " << wl._blocks << " blocks/record, ~" << wl._array_size
+              << " floats, " << wl._strings << " strings and " << wl._pointers << " pointers per block, "
+              << ( wl._level >= 0 ? "zlib level " + std::to_string( wl._level ) : std::string( "no compression" ) ) << std::endl ;
+    std::cout << "File: " << fname << ", " << repetitions << " repetitions per run (median reported)" << std::endl ;
+    std::cout << std::string( 100, '-' ) << std::endl ;
+    std::cout <<
+      std::setw(6) << std::left << "Mode" << " | " <<
+      std::setw(7) << "Threads" << " | " <<
+      std::setw(9) << "MB/s" << " | " <<
+      std::setw(10) << "Records/s" << " | " <<
+      std::setw(8) << "Wall (s)" << " | " <<
+      std::setw(15) << "Encode/decode %" << " | " <<
+      std::setw(14) << "(De)compress %" << " | " <<
+      std::setw(6) << "I/O %" << std::endl ;
+    std::cout << std::string( 100, '-' ) << std::endl ;
+    std::vector<std::pair<run_result, run_result>> results ;
+    for( const auto nthreads : thread_counts ) {
+      std::vector<run_result> writes, reads ;
+      for( std::size_t r=0 ; r<repetitions ; r++ ) {
+        writes.push_back( write_file( fname, wl, nthreads ) ) ;
+        reads.push_back( read_file( fname, wl, nthreads ) ) ;
+        if( reads.back()._items != writes.back()._items ) {
+          SIO_THROW( sio::error_code::bad_state, "Decoded " + std::to_string( reads.back()._items ) + " items, written " + std::to_string( writes.back()._items ) ) ;
+        }
+      }
+      results.emplace_back( median_run( writes ), median_run( reads ) ) ;
+      print_result( "write", results.back().first, wl._records ) ;
+      print_result( "read", results.back().second, wl._records ) ;
+    }
+    std::cout << std::string( 100, '-' ) << std::endl ;
+    const auto &first = results.front().first ;
+    std::cout << "Data: " << first._bytes << " bytes uncompressed, " << first._file_bytes << " bytes in file (ratio "
+              << std::setprecision(3) << ( static_cast<double>( first._bytes ) / first._file_bytes ) << ")" << std::endl ;
+    if( not output.empty() ) {
+      std::ofstream out( output ) ;
+      out << "{\n" ;
+      out << "  \"tool\": \"sio-bench\",\n" ;
+      out << "  \"context\": {\n" ;
+      out << "    \"sio_version\": \"" << SIO_BENCH_VERSION << "\",\n" ;
+      out << "    \"compiler\": \"" << sio::bench::json_escape( sio::bench::compiler() ) << "\",\n" ;
+      out << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n" ;
+      out << "    \"file\": \"" << sio::bench::json_escape( fname ) << "\",\n" ;
+      out << "    \"repetitions\": " << repetitions << "\n" ;
+      out << "  },\n" ;
+      out << "  \"workload\": {\n" ;
+      out << "    \"records\": " << wl._records << ",\n" ;
+      out << "    \"blocks\": " << wl._blocks << ",\n" ;
+      out << "    \"array_size\": " << wl._array_size << ",\n" ;
+      out << "    \"strings\": " << wl._strings << ",\n" ;
+      out << "    \"pointers\": " << wl._pointers << ",\n" ;
+      out << "    \"compression_level\": " << wl._level << ",\n" ;
+      out << "    \"seed\": " << wl._seed << "\n" ;
+      out << "  },\n" ;
+      out << "  \"runs\": [\n" ;
+      for( std::size_t i=0 ; i<results.size() ; i++ ) {
+        write_json_run( out, "write", results[i].first, wl._records ) ;
+        out << ",\n" ;
+        write_json_run( out, "read", results[i].second, wl._records ) ;
+        out << ( i+1 < results.size() ? ",\n" : "\n" ) ;
+      }
+      out << "  ]\n" ;
+      out << "}" << std::endl ;
+      if( not out.good() ) {
+        std::cerr << "ERROR: couldn't write the results to '" << output << "'" << std::endl ;
+        return 1 ;
+      }
+      std::cout << "Results written to " << output << std::endl ;
+    }
+  }
+  catch( const sio::exception &e ) {
+    std::cerr << "ERROR: " << e.what() << std::endl ;
+    return 1 ;
+  }
+  if( not keep ) {
+    std::remove( fname.c_str() ) ;
+    std::remove( sio::record_index::sidecar_name( fname ).c_str() ) ;
+  }
+  return 0 ;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/compression/zlib.h>
+// -- sio examples headers
+#include <sioexamples/blocks.h>
+
+namespace sio {
+  
+  namespace example {
+    
+    /// The name of the records written by the records_write example
+    static constexpr const char *particle_record_name = "particle_record" ;
+    
+    /**
+     *  @brief  Decode the uncompressed data of a particle record written by
+     *          the records_write example. Returns the particle pid
+     */
+    inline int decode_particle_data( const sio::buffer_span &uncomp_data ) {
+      sio::block_list blocks {} ;
+      auto part_blk = std::make_shared<sio::example::particle_block>() ;
+      blocks.push_back( part_blk ) ;
+      sio::api::read_blocks( uncomp_data, blocks ) ;
+      return part_blk->get_particle()._pid ;
+    }
+    
+    /**
+     *  @brief  Decode a particle record written by the records_write example.
+     *  
+     *  Uncompress the record data if needed and decode the particle block. 
+     *  Returns the particle pid, which is the record index in the file.
+     */
+    template <typename infoT>
+    inline int decode_particle_record( const infoT &rec_info, const sio::buffer_span &rec_data, sio::buffer &uncomp_buffer ) {
+      if( sio::api::is_compressed( rec_info._options ) ) {
+        sio::zlib_compression compressor ;
+        uncomp_buffer.resize( rec_info._uncompressed_length ) ;
+        compressor.uncompress( rec_data, uncomp_buffer ) ;
+        return decode_particle_data( uncomp_buffer.span() ) ;
+      }
+      return decode_particle_data( rec_data ) ;
+    }
+    
+  }
+  
+}
@@ -0,0 +1,59 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/buffered_reader.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <iostream>
+#include <string>
+
+
+/**
+ *  This example reads the file written by records_write using the 
+ *  buffered reader. The records headers and data are parsed out of the
+ *  reader read-ahead window, so that the file is read with a few large
+ *  reads instead of several reads and seeks per record.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records.sio" ;
+    
+    sio::ifstream stream ;
+    stream.open( fname , std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+    }
+    
+    /// Use a small window for the example, to exercise the window refills
+    sio::buffered_reader reader( stream, 4*sio::kbyte ) ;
+    sio::buffer uncomp_buffer( sio::kbyte ) ;
+    sio::record_info_view rec_info ;
+    int nrecords = 0 ;
+    
+    /// next_record_info() returns false at the end of the file
+    while( reader.next_record_info( rec_info ) ) {
+      if( rec_info._name != sio::example::particle_record_name ) {
+        SIO_THROW( sio::error_code::invalid_argument, "Unexpected record name '" + rec_info._name.str() + "'" ) ;
+      }
+      /// The record data is not copied, the span points in the reader window
+      auto pid = sio::example::decode_particle_record( rec_info, reader.read_record_data(), uncomp_buffer ) ;
+      if( pid != nrecords ) {
+        SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+      }
+      ++ nrecords ;
+    }
+    
+    stream.close() ;
+    
+    std::cout << "Read " << nrecords << " records from sio file " << fname 
+              << " (" << reader.stream_reads() << " stream reads)" << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
@@ -0,0 +1,107 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/buffered_reader.h>
+#include <sio/pread_reader.h>
+#include <sio/record_cache.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+
+/**
+ *  This example reads the file written by records_write through a cache
+ *  of decoded records shared by several threads, as done to sample the
+ *  background records of a pile-up overlay. First all the threads request
+ *  all the records in the same order: each record is read out and
+ *  uncompressed once, the other threads get it from the cache or wait for
+ *  the load in progress. Then the threads request records at random with a
+ *  memory budget of a tenth of the file, evicting the least recently used
+ *  records.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records.sio" ;
+    const unsigned int nthreads = 4 ;
+    
+    /// Build a simple index of record positions
+    std::vector<sio::ifstream::pos_type> positions ;
+    sio::record_cache::size_type total_bytes = 0 ;
+    {
+      sio::ifstream stream ;
+      stream.open( fname , std::ios::binary ) ;
+      if( not stream.is_open() ) {
+        SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+      }
+      sio::buffered_reader reader( stream ) ;
+      sio::record_info_view rec_info ;
+      while( reader.next_record_info( rec_info ) ) {
+        positions.push_back( rec_info._file_start ) ;
+        total_bytes += rec_info._uncompressed_length ;
+      }
+    }
+    
+    const sio::pread_reader reader( fname ) ;
+    std::atomic<int> nerrors {0} ;
+    /// Run the requests of each thread and check the decoded records
+    auto run_threads = [&]( sio::record_cache &cache, const std::function<std::size_t(unsigned int, std::size_t)> &request, std::size_t nrequests ) {
+      std::vector<std::thread> threads ;
+      for( unsigned int t=0 ; t<nthreads ; t++ ) {
+        threads.emplace_back( [&, t]() {
+          try {
+            for( std::size_t r=0 ; r<nrequests ; r++ ) {
+              const auto i = request( t, r ) ;
+              auto rec = cache.get( reader, positions[i] ) ;
+              auto pid = sio::example::decode_particle_data( rec->_data.span() ) ;
+              if( pid != static_cast<int>( i ) ) {
+                SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+              }
+            }
+          }
+          catch( sio::exception &e ) {
+            std::cout << "Caught sio exception in thread " << t << " :\n" << e.what() << std::endl ;
+            ++ nerrors ;
+          }
+        }) ;
+      }
+      for( auto &thread : threads ) {
+        thread.join() ;
+      }
+    } ;
+    
+    /// All threads read all the records: one load per record
+    sio::record_cache cache( 64*sio::mbyte ) ;
+    run_threads( cache, []( unsigned int, std::size_t r ) { return r ; }, positions.size() ) ;
+    auto stats = cache.stats() ;
+    std::cout << "Loaded " << stats._misses << " records for " << nthreads*positions.size() << " requests ("
+              << stats._hits << " hits, " << stats._shared_loads << " shared loads, hit rate " << stats.hit_rate() << ")" << std::endl ;
+    
+    /// Random requests with a small budget
+    sio::record_cache small_cache( total_bytes / 10 ) ;
+    run_threads( small_cache, [&]( unsigned int t, std::size_t r ) {
+      std::uint64_t h = ( t + 1 ) * 0x9e3779b97f4a7c15ULL + r ;
+      h = ( h ^ ( h >> 30 ) ) * 0xbf58476d1ce4e5b9ULL ;
+      h = ( h ^ ( h >> 27 ) ) * 0x94d049bb133111ebULL ;
+      return static_cast<std::size_t>( ( h ^ ( h >> 31 ) ) % positions.size() ) ;
+    }, 2000 ) ;
+    stats = small_cache.stats() ;
+    std::cout << "Random access: " << stats._records << " cached records, " << stats._evictions << " evictions, hit rate "
+              << stats.hit_rate() << ", budget " << ( stats._bytes <= small_cache.max_bytes() ? "respected" : "exceeded" ) << std::endl ;
+    if( nerrors > 0 ) {
+      return 1 ;
+    }
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
@@ -0,0 +1,72 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/chain_reader.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+/**
+ *  This example reads several files written by records_write or
+ *  concurrent_write as a single chain of records. The particle pid of
+ *  each record is its record number in its file (in index order), which
+ *  is checked against the location of the global record number. It then
+ *  jumps to a few records across files with go_to_record().
+ */
+int main( int argc, char **argv ) {
+
+  try {
+    std::vector<std::string> fnames ;
+    for( int i=1 ; i<argc ; i++ ) {
+      fnames.push_back( argv[i] ) ;
+    }
+    if( fnames.empty() ) {
+      fnames = { "records.sio", "records_concurrent.sio" } ;
+    }
+
+    sio::chain_reader reader( fnames ) ;
+    sio::record_info rec_info ;
+    sio::buffer rec_buffer( sio::kbyte ) ;
+    sio::buffer uncomp_buffer( sio::kbyte ) ;
+
+    auto check_record = [&]( std::size_t record ) {
+      const auto loc = reader.locate( record ) ;
+      auto pid = sio::example::decode_particle_record( rec_info, rec_buffer.span( rec_info._header_length, rec_info._data_length ), uncomp_buffer ) ;
+      if( pid != static_cast<int>( loc.second ) ) {
+        SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) + " for record " + std::to_string( record ) ) ;
+      }
+    } ;
+
+    /// Read the chain sequentially
+    std::size_t nread = 0 ;
+    while( reader.read_next_record( rec_info, rec_buffer ) ) {
+      check_record( nread ) ;
+      ++ nread ;
+    }
+    std::size_t nindexed = 0 ;
+    for( std::size_t f=0 ; f<reader.files() ; f++ ) {
+      nindexed += reader.file_indexed( f ) ? 1 : 0 ;
+    }
+    std::cout << "Read " << nread << " records from " << reader.files() << " files ("
+              << nindexed << " indexed)" << std::endl ;
+
+    /// Random access across files
+    const auto total = reader.size() ;
+    const std::vector<std::size_t> records = { total-1, total/2, 0, total/2+1 } ;
+    for( const auto record : records ) {
+      reader.read_record( record, rec_info, rec_buffer ) ;
+      check_record( record ) ;
+    }
+    std::cout << "Checked " << records.size() << " records with go_to_record out of " << total << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+
+  return 0 ;
+}
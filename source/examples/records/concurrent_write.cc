@@ -0,0 +1,129 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/compression/zlib.h>
+#include <sio/buffer.h>
+#include <sio/buffered_reader.h>
+#include <sio/concurrent_writer.h>
+#include <sio/pread_reader.h>
+#include <sio/record_index.h>
+// -- sio examples headers
+#include <sioexamples/data.h>
+#include <sioexamples/blocks.h>
+#include <sioexamples/records.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+
+
+/**
+ *  This example writes particle records in a single file from several
+ *  threads using the concurrent writer. Each thread encodes and writes its
+ *  share of the records, the record index (particle pid) being used as
+ *  sequence number. Every second record is compressed using zlib.
+ *  The file is then read back twice:
+ *   - sequentially with the buffered reader, to check it is a valid sio file
+ *   - in sequence order, using the record index sidecar file
+ */
+int main( int argc, char **argv ) {
+
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records_concurrent.sio" ;
+    const int nrecords = (argc > 2) ? std::atoi( argv[2] ) : 1000 ;
+    const unsigned int nthreads = 4 ;
+
+    {
+      sio::concurrent_writer writer( fname ) ;
+      std::atomic<int> nerrors {0} ;
+      std::vector<std::thread> threads ;
+      for( unsigned int t=0 ; t<nthreads ; t++ ) {
+        threads.emplace_back( [&, t]() {
+          sio::block_list blocks {} ;
+          auto part_blk = std::make_shared<sio::example::particle_block>() ;
+          blocks.push_back( part_blk ) ;
+          sio::buffer buf( sio::kbyte ) ;
+          sio::buffer compbuf( sio::kbyte ) ;
+          sio::zlib_compression compressor ;
+          try {
+            for( int i=t ; i<nrecords ; i += nthreads ) {
+              sio::example::particle part ;
+              part._pid = i ;
+              part._energy = 0.5f * i ;
+              part._x = 0.01 * i ;
+              part._y = 0.02 * i ;
+              part._z = 0.03 * i ;
+              part_blk->set_particle( part ) ;
+              auto rec_info = sio::api::write_record( sio::example::particle_record_name, buf, blocks, 0 ) ;
+              if( i % 2 ) {
+                sio::api::compress_record( rec_info, buf, compbuf, compressor ) ;
+                writer.write_record( buf.span(0, rec_info._header_length), compbuf.span(), rec_info, i ) ;
+              }
+              else {
+                writer.write_record( buf.span(), rec_info, i ) ;
+              }
+            }
+          }
+          catch( sio::exception &e ) {
+            std::cout << "Caught sio exception in thread " << t << " :\n" << e.what() << std::endl ;
+            ++ nerrors ;
+          }
+        }) ;
+      }
+      for( auto &thread : threads ) {
+        thread.join() ;
+      }
+      if( nerrors > 0 ) {
+        return 1 ;
+      }
+      writer.close() ;
+      std::cout << "Written " << writer.records() << " records in sio file " << fname
+                << " (" << nthreads << " threads)" << std::endl ;
+    }
+
+    /// Sequential read: the records are in reservation order
+    {
+      sio::ifstream stream ;
+      stream.open( fname , std::ios::binary ) ;
+      if( not stream.is_open() ) {
+        SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+      }
+      sio::buffered_reader reader( stream ) ;
+      sio::record_info_view rec_info ;
+      int nread = 0 ;
+      while( reader.next_record_info( rec_info ) ) {
+        ++ nread ;
+      }
+      if( nread != nrecords ) {
+        SIO_THROW( sio::error_code::invalid_argument, "Read " + std::to_string( nread ) + " records sequentially" ) ;
+      }
+    }
+
+    /// Read in sequence order from the index
+    sio::record_index index ;
+    index.read( sio::record_index::sidecar_name( fname ) ) ;
+    const sio::pread_reader reader( fname ) ;
+    sio::record_info rec_info ;
+    sio::buffer rec_buffer( sio::kbyte ) ;
+    sio::buffer uncomp_buffer( sio::kbyte ) ;
+    int nread = 0 ;
+    for( const auto &entry : index ) {
+      reader.read_record( entry._position, rec_info, rec_buffer ) ;
+      auto pid = sio::example::decode_particle_record( rec_info, rec_buffer.span( rec_info._header_length, rec_info._data_length ), uncomp_buffer ) ;
+      if( pid != nread or static_cast<std::uint64_t>( pid ) != entry._sequence ) {
+        SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+      }
+      ++ nread ;
+    }
+    std::cout << "Read " << nread << " records in index order from sio file " << fname << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+
+  return 0 ;
+}
@@ -0,0 +1,99 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/source.h>
+#include <sio/sink.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <iostream>
+#include <string>
+
+
+/**
+ *  This example shows how to pass records between two processing stages
+ *  in memory, without going through the file system. The first stage reads
+ *  the file written by records_write with a file source and writes the
+ *  records in a memory sink. The second stage skips the first records and
+ *  decodes the other ones from a memory source. The same api functions are
+ *  used for both kind of sources and sinks.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records.sio" ;
+    const std::size_t nskip = 10 ;
+    
+    sio::ifstream stream ;
+    stream.open( fname , std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+    }
+    
+    /// Stage 1: copy the records from the file to the memory buffer
+    sio::buffer memory( sio::kbyte ) ;
+    sio::memory_sink sink( memory ) ;
+    {
+      sio::file_source source( stream ) ;
+      sio::buffer rec_buffer( sio::kbyte ) ;
+      sio::record_info rec_info ;
+      try {
+        while( 1 ) {
+          sio::api::read_record( source, rec_info, rec_buffer ) ;
+          sio::api::write_record( sink, rec_buffer.span(), rec_info ) ;
+        }
+      }
+      catch( sio::exception &e ) {
+        if( e.code() != sio::error_code::eof ) {
+          throw ;
+        }
+      }
+    }
+    /// The memory buffer is an exact copy of the file
+    stream.clear() ;
+    stream.seekg( 0, std::ios::end ) ;
+    const auto file_size = static_cast<std::size_t>( stream.tellg() ) ;
+    if( file_size != sink.span().size() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Memory copy and file size differ" ) ;
+    }
+    stream.close() ;
+    
+    /// Stage 2: read the records back from memory
+    sio::memory_source source( sink.span() ) ;
+    sio::buffer rec_buffer( sio::kbyte ) ;
+    sio::buffer uncomp_buffer( sio::kbyte ) ;
+    std::size_t counter = 0 ;
+    sio::api::skip_records( source, [&]( const sio::record_info & ) {
+      return ( ++ counter < nskip ) ;
+    }) ;
+    int nrecords = 0 ;
+    try {
+      sio::api::read_records( source, rec_buffer,
+      []( const sio::record_info & ) {
+        return true ;
+      },
+      [&]( const sio::record_info &rec_info, const sio::buffer_span &rec_data ) {
+        auto pid = sio::example::decode_particle_record( rec_info, rec_data, uncomp_buffer ) ;
+        if( pid != static_cast<int>( nskip ) + nrecords ) {
+          SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+        }
+        ++ nrecords ;
+        return true ;
+      }) ;
+    }
+    catch( sio::exception &e ) {
+      if( e.code() != sio::error_code::eof ) {
+        throw ;
+      }
+    }
+    
+    std::cout << "Read " << nrecords << " records from memory after skipping " << nskip 
+              << " records (" << sink.span().size() << " bytes)" << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
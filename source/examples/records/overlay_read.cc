@@ -0,0 +1,82 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/buffered_reader.h>
+#include <sio/overlay_sampler.h>
+#include <sio/record_index.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+/**
+ *  This example uses the file written by records_write (or the manifest
+ *  written by sharded_write, with the "manifest" argument) as background
+ *  sample of a pile-up overlay: for each of the 200 signal events, 20
+ *  background records are drawn at random. The overlay sampler reads
+ *  the records of the upcoming events ahead of the consumer, in file
+ *  offset order, and uncompresses them on its own threads.
+ *  The record index is built by scanning the record headers. It would
+ *  usually be read from the index sidecar file.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records.sio" ;
+    const bool use_manifest = (argc > 2) and std::string( argv[2] ) == "manifest" ;
+    const std::size_t nsignal = 200 ;
+    const std::size_t nbackground = 20 ;
+    
+    /// Build the record index, or read the manifest of a sharded file
+    sio::record_index index ;
+    if( use_manifest ) {
+      index.read( sio::record_index::sidecar_name( fname ) ) ;
+    }
+    else {
+      sio::ifstream stream ;
+      stream.open( fname , std::ios::binary ) ;
+      if( not stream.is_open() ) {
+        SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+      }
+      sio::buffered_reader reader( stream ) ;
+      sio::record_info_view rec_info ;
+      std::uint64_t sequence = 0 ;
+      while( reader.next_record_info( rec_info ) ) {
+        index.add( rec_info.to_info(), sequence++ ) ;
+      }
+    }
+    
+    auto plan = sio::overlay_sampler::make_plan( index.size(), nsignal, nbackground, 42 ) ;
+    const auto expected = plan ;
+    sio::overlay_sampler sampler( fname, index, std::move( plan ), 2, 16 ) ;
+    std::vector<sio::overlay_sampler::record_ptr> records ;
+    std::size_t nevents = 0 ;
+    std::size_t noverlaid = 0 ;
+    while( sampler.next_event( records ) ) {
+      /// The particle pid is the record number in the file
+      for( std::size_t i=0 ; i<records.size() ; i++ ) {
+        auto pid = sio::example::decode_particle_data( records[i]->_data.span() ) ;
+        if( pid != static_cast<int>( expected[nevents][i] ) ) {
+          SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+        }
+        ++ noverlaid ;
+      }
+      ++ nevents ;
+    }
+    const auto stats = sampler.stats() ;
+    std::cout << "Overlaid " << noverlaid << " background records on " << nevents << " signal events from "
+              << std::max( index.files().size(), std::size_t(1) ) << " file(s) ("
+              << stats._records << " records loaded with " << stats._reads << " reads, "
+              << stats._bytes_read << " bytes)" << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
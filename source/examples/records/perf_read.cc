@@ -0,0 +1,56 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/perf_counters.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <iostream>
+#include <string>
+
+
+/**
+ *  This example reads the file written by records_write and prints the
+ *  library performance counters: bytes and records read, blocks decoded,
+ *  time spent in reading, decompressing and decoding the records.
+ *  The counters are only compiled in with the CMake option SIO_PERF_COUNTERS.
+ *  Any other program can get the same printout at exit by setting the
+ *  environment variable SIO_PERF_DUMP=1.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records.sio" ;
+    
+    sio::ifstream stream ;
+    stream.open( fname , std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+    }
+    sio::perf::reset() ;
+    sio::record_info rec_info ;
+    sio::buffer rec_buffer( sio::kbyte ) ;
+    sio::buffer uncomp_buffer( sio::kbyte ) ;
+    int nrecords = 0 ;
+    while( stream.peek() != EOF ) {
+      sio::api::read_record( stream, rec_info, rec_buffer ) ;
+      auto pid = sio::example::decode_particle_record( rec_info, rec_buffer.span( rec_info._header_length, rec_info._data_length ), uncomp_buffer ) ;
+      if( pid != nrecords ) {
+        SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+      }
+      ++ nrecords ;
+    }
+    const auto counters = sio::perf::collect() ;
+    counters.print( std::cout ) ;
+    std::cout << "Counted " << counters.value( sio::perf::counter::records_read ) << " records, "
+              << counters.value( sio::perf::counter::blocks_read ) << " blocks and "
+              << counters.calls( sio::perf::timer::uncompress ) << " uncompress calls from sio file " << fname
+              << ( sio::perf::enabled() ? "" : " (counters not compiled in)" ) << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
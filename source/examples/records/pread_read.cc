@@ -0,0 +1,85 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/buffered_reader.h>
+#include <sio/pread_reader.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+
+/**
+ *  This example reads the file written by records_write from several
+ *  threads sharing a single pread reader. The record positions are first
+ *  collected with the buffered reader (this would usually come from a file
+ *  index). Each thread then reads and decodes its share of the records at
+ *  explicit positions, without any locking.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records.sio" ;
+    const unsigned int nthreads = 4 ;
+    
+    /// Build a simple index of record positions
+    std::vector<sio::ifstream::pos_type> positions ;
+    {
+      sio::ifstream stream ;
+      stream.open( fname , std::ios::binary ) ;
+      if( not stream.is_open() ) {
+        SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+      }
+      sio::buffered_reader reader( stream ) ;
+      sio::record_info_view rec_info ;
+      while( reader.next_record_info( rec_info ) ) {
+        positions.push_back( rec_info._file_start ) ;
+      }
+    }
+    
+    const sio::pread_reader reader( fname ) ;
+    std::atomic<int> nrecords {0} ;
+    std::atomic<int> nerrors {0} ;
+    std::vector<std::thread> threads ;
+    
+    for( unsigned int t=0 ; t<nthreads ; t++ ) {
+      threads.emplace_back( [&, t]() {
+        sio::record_info rec_info ;
+        sio::buffer rec_buffer( sio::kbyte ) ;
+        sio::buffer uncomp_buffer( sio::kbyte ) ;
+        try {
+          for( std::size_t i=t ; i<positions.size() ; i += nthreads ) {
+            reader.read_record( positions[i], rec_info, rec_buffer ) ;
+            auto pid = sio::example::decode_particle_record( rec_info, rec_buffer.span( rec_info._header_length, rec_info._data_length ), uncomp_buffer ) ;
+            if( pid != static_cast<int>( i ) ) {
+              SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+            }
+            ++ nrecords ;
+          }
+        }
+        catch( sio::exception &e ) {
+          std::cout << "Caught sio exception in thread " << t << " :\n" << e.what() << std::endl ;
+          ++ nerrors ;
+        }
+      }) ;
+    }
+    for( auto &thread : threads ) {
+      thread.join() ;
+    }
+    if( nerrors > 0 ) {
+      return 1 ;
+    }
+    std::cout << "Read " << nrecords << " records from sio file " << fname 
+              << " (" << nthreads << " threads)" << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
@@ -0,0 +1,61 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/prefetch_reader.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <iostream>
+#include <string>
+
+
+/**
+ *  This example reads the file written by records_write using the
+ *  prefetch reader. The next records are read out on a background
+ *  thread while the current record is decoded. In the middle of the
+ *  file, the reader is moved back to the first record to show that 
+ *  the read-ahead is cancelled on seek.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records.sio" ;
+    
+    sio::ifstream stream ;
+    stream.open( fname , std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+    }
+    
+    sio::prefetch_reader reader( stream, 32 ) ;
+    sio::record_info rec_info ;
+    sio::buffer rec_buffer( sio::kbyte ) ;
+    sio::buffer uncomp_buffer( sio::kbyte ) ;
+    int nrecords = 0 ;
+    bool rewinded = false ;
+    
+    /// The record buffer contains the record header followed by the record data
+    while( reader.read_next_record( rec_info, rec_buffer ) ) {
+      auto pid = sio::example::decode_particle_record( rec_info, rec_buffer.span( rec_info._header_length, rec_info._data_length ), uncomp_buffer ) ;
+      if( pid != nrecords ) {
+        SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+      }
+      ++ nrecords ;
+      /// Go back to the start of the file once, the records read ahead are dropped
+      if( nrecords == 100 and not rewinded ) {
+        reader.seek( 0 ) ;
+        nrecords = 0 ;
+        rewinded = true ;
+      }
+    }
+    
+    std::cout << "Read " << nrecords << " records from sio file " << fname 
+              << " (prefetch depth: " << reader.depth() << ")" << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
@@ -0,0 +1,71 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/pread_reader.h>
+#include <sio/range_reader.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+
+
+/**
+ *  This example splits the file written by records_write in byte ranges of
+ *  equal size, without index. Each range is read by its own thread, which
+ *  first resynchronizes on the next record marker. The example checks that
+ *  every record (particle pid) is read by exactly one range.
+ */
+int main( int argc, char **argv ) {
+
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records.sio" ;
+    const std::size_t nranges = (argc > 2) ? std::atoi( argv[2] ) : 8 ;
+
+    const sio::pread_reader reader( fname ) ;
+    const auto bounds = sio::range_reader::split( reader.file_size(), nranges ) ;
+    std::vector<std::atomic<int>> seen( reader.file_size() ) ;
+    std::atomic<int> nrecords {0} ;
+    std::atomic<int> nerrors {0} ;
+    std::vector<std::thread> threads ;
+
+    for( std::size_t r=0 ; r<nranges ; r++ ) {
+      threads.emplace_back( [&, r]() {
+        sio::range_reader range( reader, bounds[r], bounds[r+1] ) ;
+        sio::record_info rec_info ;
+        sio::buffer rec_buffer( sio::kbyte ) ;
+        sio::buffer uncomp_buffer( sio::kbyte ) ;
+        try {
+          while( range.read_next_record( rec_info, rec_buffer ) ) {
+            auto pid = sio::example::decode_particle_record( rec_info, rec_buffer.span( rec_info._header_length, rec_info._data_length ), uncomp_buffer ) ;
+            if( pid < 0 or static_cast<std::size_t>( pid ) >= seen.size() or seen[pid]++ != 0 ) {
+              SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+            }
+            ++ nrecords ;
+          }
+        }
+        catch( sio::exception &e ) {
+          std::cout << "Caught sio exception in range " << r << " :\n" << e.what() << std::endl ;
+          ++ nerrors ;
+        }
+      }) ;
+    }
+    for( auto &thread : threads ) {
+      thread.join() ;
+    }
+    if( nerrors > 0 ) {
+      return 1 ;
+    }
+    std::cout << "Read " << nrecords << " records from " << nranges << " byte ranges of sio file " << fname << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+
+  return 0 ;
+}
@@ -0,0 +1,73 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/compression/zlib.h>
+#include <sio/buffer.h>
+// -- sio examples headers
+#include <sioexamples/data.h>
+#include <sioexamples/blocks.h>
+#include <sioexamples/records.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <cstdlib>
+
+
+/**
+ *  This example writes many small records in a file. Every second record
+ *  is compressed using zlib. The particle pid is set to the record index,
+ *  so that the readers can check the records order.
+ *  The other examples in this directory read this file back.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records.sio" ;
+    const int nrecords = (argc > 2) ? std::atoi( argv[2] ) : 1000 ;
+    
+    sio::ofstream stream ;
+    stream.open( fname , std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open output stream '" + fname + "'" ) ;
+    }
+    
+    sio::block_list blocks {} ;
+    auto part_blk = std::make_shared<sio::example::particle_block>() ;
+    blocks.push_back( part_blk ) ;
+    
+    sio::buffer buf( sio::kbyte ) ;
+    sio::buffer compbuf( sio::kbyte ) ;
+    sio::zlib_compression compressor ;
+    
+    for( int i=0 ; i<nrecords ; i++ ) {
+      sio::example::particle part ;
+      part._pid = i ;
+      part._energy = 0.5f * i ;
+      part._x = 0.01 * i ;
+      part._y = 0.02 * i ;
+      part._z = 0.03 * i ;
+      part_blk->set_particle( part ) ;
+      
+      /// The buffer is moved in and out the write device, so we get
+      /// it back after each record and re-use it for the next one
+      auto rec_info = sio::api::write_record( sio::example::particle_record_name, buf, blocks, 0 ) ;
+      if( i % 2 ) {
+        sio::api::compress_record( rec_info, buf, compbuf, compressor ) ;
+        sio::api::write_record( stream, buf.span(0, rec_info._header_length), compbuf.span(), rec_info ) ;
+      }
+      else {
+        sio::api::write_record( stream, buf.span(), rec_info ) ;
+      }
+    }
+    
+    stream.close() ;
+    
+    std::cout << "Written " << nrecords << " records in sio file " << fname << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
@@ -0,0 +1,93 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/compression/zlib.h>
+#include <sio/buffer.h>
+#include <sio/pread_reader.h>
+#include <sio/record_index.h>
+#include <sio/sharded_writer.h>
+// -- sio examples headers
+#include <sioexamples/data.h>
+#include <sioexamples/blocks.h>
+#include <sioexamples/records.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+
+/**
+ *  This example writes particle records over several shard files with the
+ *  sharded writer, using the round robin or hash policy. The particle pid
+ *  (record index) is used as sequence number. Every second record is
+ *  compressed using zlib. The logical stream is then read back in the
+ *  original order by following the manifest written next to the shards.
+ */
+int main( int argc, char **argv ) {
+
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records_sharded.sio" ;
+    const std::string policy_name = (argc > 2) ? argv[2] : "round_robin" ;
+    const int nrecords = (argc > 3) ? std::atoi( argv[3] ) : 1000 ;
+    const std::size_t nshards = 4 ;
+    const auto policy = ( policy_name == "hash" ) ? sio::shard_policy::hash : sio::shard_policy::round_robin ;
+
+    {
+      sio::sharded_writer writer( fname, nshards, policy ) ;
+      sio::block_list blocks {} ;
+      auto part_blk = std::make_shared<sio::example::particle_block>() ;
+      blocks.push_back( part_blk ) ;
+      sio::buffer buf( sio::kbyte ) ;
+      sio::buffer compbuf( sio::kbyte ) ;
+      sio::zlib_compression compressor ;
+      for( int i=0 ; i<nrecords ; i++ ) {
+        sio::example::particle part ;
+        part._pid = i ;
+        part._energy = 0.5f * i ;
+        part._x = 0.01 * i ;
+        part._y = 0.02 * i ;
+        part._z = 0.03 * i ;
+        part_blk->set_particle( part ) ;
+        auto rec_info = sio::api::write_record( sio::example::particle_record_name, buf, blocks, 0 ) ;
+        if( i % 2 ) {
+          sio::api::compress_record( rec_info, buf, compbuf, compressor ) ;
+          writer.write_record( buf.span(0, rec_info._header_length), compbuf.span(), rec_info, i ) ;
+        }
+        else {
+          writer.write_record( buf.span(), rec_info, i ) ;
+        }
+      }
+      writer.close() ;
+      std::cout << "Written " << nrecords << " records in " << writer.shards() << " shards of " << fname
+                << " (" << policy_name << ")" << std::endl ;
+    }
+
+    /// Read the logical stream back from the manifest
+    sio::record_index manifest ;
+    manifest.read( sio::record_index::sidecar_name( fname ) ) ;
+    std::vector<std::unique_ptr<sio::pread_reader>> readers ;
+    for( const auto &file : manifest.files() ) {
+      readers.emplace_back( new sio::pread_reader( file ) ) ;
+    }
+    sio::record_info rec_info ;
+    sio::buffer rec_buffer( sio::kbyte ) ;
+    sio::buffer uncomp_buffer( sio::kbyte ) ;
+    int nread = 0 ;
+    for( const auto &entry : manifest ) {
+      readers.at( entry._file )->read_record( entry._position, rec_info, rec_buffer ) ;
+      auto pid = sio::example::decode_particle_record( rec_info, rec_buffer.span( rec_info._header_length, rec_info._data_length ), uncomp_buffer ) ;
+      if( pid != nread ) {
+        SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+      }
+      ++ nread ;
+    }
+    std::cout << "Read " << nread << " records in manifest order from " << readers.size() << " shards of " << fname << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+
+  return 0 ;
+}
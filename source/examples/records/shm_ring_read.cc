@@ -0,0 +1,93 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/buffered_reader.h>
+#include <sio/shm_ring.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <iostream>
+#include <string>
+// -- posix headers
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+/**
+ *  This example passes the records written by records_write from one
+ *  process to another through a shared memory ring. The parent process
+ *  reads the file and writes the records in the ring. The child process
+ *  decodes the records directly out of the shared memory, without copy.
+ *  The ring is kept small to exercise the wrapping and the backpressure.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records.sio" ;
+    const std::string ring_name = (argc > 2) ? argv[2] : "/dev/shm/sio_records_ring" ;
+    
+    sio::shm_ring_writer ring( ring_name, 16*sio::kbyte ) ;
+    std::cout.flush() ;
+    const pid_t child = ::fork() ;
+    if( child < 0 ) {
+      SIO_THROW( sio::error_code::bad_state, "Couldn't fork the consumer process" ) ;
+    }
+    
+    /// Consumer process
+    if( 0 == child ) {
+      int status = 0 ;
+      try {
+        sio::shm_ring_reader reader( ring_name ) ;
+        sio::buffer uncomp_buffer( sio::kbyte ) ;
+        sio::record_info_view rec_info ;
+        int nrecords = 0 ;
+        while( reader.next_record_info( rec_info ) ) {
+          /// The record data span points into the shared memory
+          auto pid = sio::example::decode_particle_record( rec_info, reader.read_record_data(), uncomp_buffer ) ;
+          if( pid != nrecords ) {
+            SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+          }
+          ++ nrecords ;
+        }
+        std::cout << "Read " << nrecords << " records from shared memory ring " << ring_name << std::endl ;
+      }
+      catch( sio::exception &e ) {
+        std::cout << "Caught sio exception in consumer :\n" << e.what() << std::endl ;
+        status = 1 ;
+      }
+      std::cout.flush() ;
+      /// Don't run the writer destructor in the child process
+      ::_exit( status ) ;
+    }
+    
+    /// Producer process
+    sio::ifstream stream ;
+    stream.open( fname , std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+    }
+    sio::buffered_reader reader( stream ) ;
+    sio::record_info_view rec_view ;
+    int nrecords = 0 ;
+    while( reader.next_record_info( rec_view ) ) {
+      /// The ring is a record sink, each record is published after being written
+      auto rec_info = rec_view.to_info() ;
+      sio::api::write_record( ring, reader.read_record(), rec_info ) ;
+      ++ nrecords ;
+    }
+    ring.close() ;
+    int status = 0 ;
+    ::waitpid( child, &status, 0 ) ;
+    if( not WIFEXITED( status ) or 0 != WEXITSTATUS( status ) ) {
+      SIO_THROW( sio::error_code::bad_state, "The consumer process failed" ) ;
+    }
+    std::cout << "Written " << nrecords << " records in shared memory ring " << ring_name << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
@@ -0,0 +1,107 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/buffered_reader.h>
+#include <sio/socket_stream.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+
+
+/**
+ *  This example fans out the records written by records_write to several
+ *  consumers over local sockets (Unix-domain by default, or TCP on the
+ *  loopback interface). The producer reads the file and streams every record
+ *  to each consumer. The consumers run in threads here, but could be other
+ *  processes of the node. The records are sent in batches and received in
+ *  pooled buffers.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records.sio" ;
+    const std::string mode = (argc > 2) ? argv[2] : "unix" ;
+    const unsigned int nconsumers = 2 ;
+    const std::string socket_path = "records.sock" ;
+    
+    if( mode != "unix" and mode != "tcp" ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Unknown socket mode '" + mode + "' (unix or tcp)" ) ;
+    }
+    const int listen_fd = ( mode == "unix" ) ? sio::sockets::listen_unix( socket_path ) : sio::sockets::listen_tcp( 0 ) ;
+    const unsigned short port = ( mode == "unix" ) ? 0 : sio::sockets::local_port( listen_fd ) ;
+    
+    /// Consumers: connect, then decode the records until the end of stream
+    std::vector<int> counts( nconsumers, 0 ) ;
+    std::atomic<int> nerrors {0} ;
+    std::vector<std::thread> consumers ;
+    for( unsigned int c=0 ; c<nconsumers ; c++ ) {
+      consumers.emplace_back( [&, c]() {
+        try {
+          const int fd = ( mode == "unix" ) ? sio::sockets::connect_unix( socket_path ) : sio::sockets::connect_tcp( "127.0.0.1", port ) ;
+          sio::socket_source source( fd ) ;
+          sio::buffer rec_buffer = source.take_buffer() ;
+          sio::buffer uncomp_buffer( sio::kbyte ) ;
+          sio::record_info rec_info ;
+          while( source.receive_record( rec_info, rec_buffer ) ) {
+            auto pid = sio::example::decode_particle_record( rec_info, rec_buffer.span( rec_info._header_length, rec_info._data_length ), uncomp_buffer ) ;
+            if( pid != counts[c] ) {
+              SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+            }
+            ++ counts[c] ;
+          }
+          source.give_buffer( std::move( rec_buffer ) ) ;
+        }
+        catch( sio::exception &e ) {
+          std::cout << "Caught sio exception in consumer " << c << " :\n" << e.what() << std::endl ;
+          ++ nerrors ;
+        }
+      }) ;
+    }
+    
+    /// Producer: stream each record to all the consumers
+    std::vector<std::unique_ptr<sio::socket_sink>> sinks ;
+    for( unsigned int c=0 ; c<nconsumers ; c++ ) {
+      sinks.emplace_back( new sio::socket_sink( sio::sockets::accept( listen_fd ) ) ) ;
+    }
+    sio::sockets::close( listen_fd ) ;
+    sio::ifstream stream ;
+    stream.open( fname , std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+    }
+    sio::buffered_reader reader( stream ) ;
+    sio::record_info_view rec_view ;
+    while( reader.next_record_info( rec_view ) ) {
+      auto rec_info = rec_view.to_info() ;
+      auto rec_span = reader.read_record() ;
+      for( auto &sink : sinks ) {
+        sio::api::write_record( *sink, rec_span, rec_info ) ;
+      }
+    }
+    /// Send the last batches and signal the end of stream
+    for( auto &sink : sinks ) {
+      sink->close() ;
+    }
+    for( auto &consumer : consumers ) {
+      consumer.join() ;
+    }
+    if( nerrors > 0 ) {
+      return 1 ;
+    }
+    for( unsigned int c=0 ; c<nconsumers ; c++ ) {
+      std::cout << "Consumer " << c << ": read " << counts[c] << " records over " << mode << " socket" << std::endl ;
+    }
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
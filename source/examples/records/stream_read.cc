@@ -0,0 +1,70 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/buffered_reader.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <iostream>
+#include <string>
+
+
+/**
+ *  This example reads the records written by records_write from a non
+ *  seekable source, by default the standard input:
+ *
+ *    cat records.sio | ./bin/examples/stream_read
+ *
+ *  The buffered reader detects that the stream can not seek and switches
+ *  to forward-only mode. Only the uncompressed records are decoded, the
+ *  data of the compressed records are read and discarded.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "/dev/stdin" ;
+    
+    sio::ifstream stream ;
+    stream.open( fname , std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+    }
+    
+    /// Use a small window for the example, to exercise the skipping of data
+    sio::buffered_reader reader( stream, sio::kbyte ) ;
+    sio::buffer uncomp_buffer( sio::kbyte ) ;
+    int nrecords = 0 ;
+    int nskipped = 0 ;
+    
+    /// Decode the uncompressed records only, until the end of the stream
+    try {
+      reader.read_records( [&]( const sio::record_info_view &rec_info ) {
+        const bool compressed = sio::api::is_compressed( rec_info._options ) ;
+        nskipped += compressed ? 1 : 0 ;
+        return not compressed ;
+      },
+      [&]( const sio::record_info_view &rec_info, const sio::buffer_span &rec_data ) {
+        auto pid = sio::example::decode_particle_record( rec_info, rec_data, uncomp_buffer ) ;
+        if( pid != nrecords + nskipped ) {
+          SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+        }
+        ++ nrecords ;
+        return true ;
+      }) ;
+    }
+    catch( sio::exception &e ) {
+      if( e.code() != sio::error_code::eof ) {
+        throw ;
+      }
+    }
+    
+    std::cout << "Read " << nrecords << " records and skipped " << nskipped << " records from " << fname 
+              << " (forward-only: " << ( reader.forward_only() ? "yes" : "no" ) << ")" << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
@@ -0,0 +1,61 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/prefetch_reader.h>
+#include <sio/trace.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <iostream>
+#include <string>
+
+
+/**
+ *  This example reads the file written by records_write with the
+ *  prefetch reader and writes a timeline of the library stages in
+ *  the Chrome trace format: the background reads, the decompression
+ *  and decoding of the records and the queue stalls, per thread.
+ *  Open the output file in chrome://tracing or https://ui.perfetto.dev.
+ *  Any other program can get the same trace by setting the environment
+ *  variable SIO_TRACE to the output file name.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records.sio" ;
+    const std::string trace_fname = (argc > 2) ? argv[2] : "records_trace.json" ;
+    
+    sio::ifstream stream ;
+    stream.open( fname , std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+    }
+    sio::trace::set_thread_name( "main" ) ;
+    sio::trace::start() ;
+    int nrecords = 0 ;
+    {
+      sio::prefetch_reader reader( stream, 32 ) ;
+      sio::record_info rec_info ;
+      sio::buffer rec_buffer( sio::kbyte ) ;
+      sio::buffer uncomp_buffer( sio::kbyte ) ;
+      while( reader.read_next_record( rec_info, rec_buffer ) ) {
+        auto pid = sio::example::decode_particle_record( rec_info, rec_buffer.span( rec_info._header_length, rec_info._data_length ), uncomp_buffer ) ;
+        if( pid != nrecords ) {
+          SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+        }
+        ++ nrecords ;
+      }
+    }
+    sio::trace::stop() ;
+    sio::trace::write_json( trace_fname ) ;
+    std::cout << "Read " << nrecords << " records from sio file " << fname << std::endl ;
+    std::cout << "Written " << sio::trace::size() << " trace events to " << trace_fname
+              << ( sio::trace::compiled() ? "" : " (tracing not compiled in)" ) << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
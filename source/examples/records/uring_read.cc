@@ -0,0 +1,88 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/buffered_reader.h>
+#include <sio/uring_reader.h>
+// -- sio examples headers
+#include <sioexamples/records.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+
+/**
+ *  This example reads the file written by records_write in random order
+ *  using the uring reader. The record positions are first collected with
+ *  the buffered reader (this would usually come from a file index). The
+ *  records are then read in batches: all the reads of a batch are in flight
+ *  at the same time when io_uring is available.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "records.sio" ;
+    
+    /// Build a simple index of record positions
+    std::vector<sio::ifstream::pos_type> positions ;
+    {
+      sio::ifstream stream ;
+      stream.open( fname , std::ios::binary ) ;
+      if( not stream.is_open() ) {
+        SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+      }
+      sio::buffered_reader reader( stream ) ;
+      sio::record_info_view rec_info ;
+      while( reader.next_record_info( rec_info ) ) {
+        positions.push_back( rec_info._file_start ) ;
+      }
+    }
+    
+    /// Shuffle the record indices to simulate random access
+    std::vector<std::size_t> order( positions.size() ) ;
+    for( std::size_t i=0 ; i<order.size() ; i++ ) {
+      order[i] = i ;
+    }
+    std::mt19937 generator( 42 ) ;
+    std::shuffle( order.begin(), order.end(), generator ) ;
+    
+    sio::uring_reader reader( fname ) ;
+    std::vector<sio::buffer> rec_buffers ;
+    std::vector<sio::record_info> rec_infos ;
+    sio::buffer uncomp_buffer( sio::kbyte ) ;
+    const std::size_t batch_size = 64 ;
+    int nrecords = 0 ;
+    
+    for( std::size_t first=0 ; first<order.size() ; first += batch_size ) {
+      const std::size_t last = std::min( first + batch_size, order.size() ) ;
+      std::vector<sio::ifstream::pos_type> batch ;
+      for( std::size_t i=first ; i<last ; i++ ) {
+        batch.push_back( positions[ order[i] ] ) ;
+      }
+      /// Read the record headers then the record data, each in one batch
+      reader.read_records( batch, rec_infos, rec_buffers ) ;
+      /// Once the headers are known, the records can be read in a single batch
+      reader.read_records( rec_infos, rec_buffers ) ;
+      for( std::size_t i=first ; i<last ; i++ ) {
+        const auto &rec_info = rec_infos[ i-first ] ;
+        const auto &rec_buffer = rec_buffers[ i-first ] ;
+        auto pid = sio::example::decode_particle_record( rec_info, rec_buffer.span( rec_info._header_length, rec_info._data_length ), uncomp_buffer ) ;
+        if( pid != static_cast<int>( order[i] ) ) {
+          SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( pid ) ) ;
+        }
+        ++ nrecords ;
+      }
+    }
+    
+    std::cout << "Read " << nrecords << " records from sio file " << fname 
+              << " (io_uring: " << ( reader.uses_io_uring() ? "yes" : "no" ) << ")" << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
@@ -0,0 +1,151 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/block.h>
+#include <sio/compression/adaptive.h>
+#include <sio/compression/zlib.h>
+#include <sio/buffer.h>
+#include <sio/io_device.h>
+#include <sio/version.h>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+
+/**
+ *  A collection of raw detector words
+ */
+class words_block : public sio::block {
+public:
+  words_block() :
+    sio::block( "words", sio::version::encode_version( 1, 0 ) ) {
+    /* nop */
+  }
+
+  std::vector<unsigned int> &words() { return _words ; }
+
+  void read( sio::read_device &device, sio::version_type /*vers*/ ) override {
+    device.data( _words ) ;
+  }
+
+  void write( sio::write_device &device ) override {
+    device.data( _words ) ;
+  }
+
+private:
+  ///< The detector words
+  std::vector<unsigned int>     _words {} ;
+};
+
+/**
+ *  This example writes two kinds of records with the adaptive compression
+ *  policy: "hits" records with digitized values, which compress well, and
+ *  "noise" records with random words, which don't. The noise records are
+ *  stored raw instead of being stored compressed with a larger size, and
+ *  the zlib level of the hits records is selected from the observed ratio
+ *  and throughput. The records are then read back and checked.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "adaptive_compressed.sio" ;
+    const unsigned int nrecords = 200 ;
+    const unsigned int nwords = 2000 ;
+    
+    auto hit = []( unsigned int rec, unsigned int i ) {
+      return ( rec * 7 + i * 31 ) % 512 ;
+    } ;
+    
+    /// Write the records
+    {
+      sio::ofstream stream ;
+      stream.open( fname , std::ios::binary ) ;
+      if( not stream.is_open() ) {
+        SIO_THROW( sio::error_code::not_open, "Couldn't open output stream '" + fname + "'" ) ;
+      }
+      auto words_blk = std::make_shared<words_block>() ;
+      sio::block_list blocks { words_blk } ;
+      sio::buffer buf( sio::kbyte ) ;
+      sio::buffer compbuf( sio::kbyte ) ;
+      /// Store the records raw if they don't compress below 90%
+      sio::adaptive_compression policy( 0.9 ) ;
+      std::mt19937 generator( 42 ) ;
+      for( unsigned int r=0 ; r<nrecords ; r++ ) {
+        auto &words = words_blk->words() ;
+        words.resize( nwords ) ;
+        for( unsigned int i=0 ; i<nwords ; i++ ) {
+          words[i] = hit( r, i ) ;
+        }
+        auto rec_info = sio::api::write_record( "hits", buf, blocks, 0 ) ;
+        policy.compress_record( rec_info, buf, compbuf ) ;
+        sio::api::write_record( stream, buf.span( 0, rec_info._header_length ), compbuf.span(), rec_info ) ;
+        for( unsigned int i=0 ; i<nwords ; i++ ) {
+          words[i] = generator() ;
+        }
+        rec_info = sio::api::write_record( "noise", buf, blocks, 0 ) ;
+        policy.compress_record( rec_info, buf, compbuf ) ;
+        sio::api::write_record( stream, buf.span( 0, rec_info._header_length ), compbuf.span(), rec_info ) ;
+      }
+      for( const auto &entry : policy.stats() ) {
+        const auto &st = entry.second ;
+        std::cout << "Record " << entry.first << ": level " << st._level << ", ratio " << st._ratio
+                  << ", " << st._throughput << " MB/s, " << st._compressed << " compressed, " << st._raw << " raw" << std::endl ;
+      }
+    }
+    
+    /// Read back and check the records
+    sio::ifstream stream ;
+    stream.open( fname , std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+    }
+    auto words_blk = std::make_shared<words_block>() ;
+    sio::block_list blocks { words_blk } ;
+    sio::record_info rec_info ;
+    sio::buffer rec_buffer( sio::kbyte ) ;
+    sio::buffer uncomp_rec_buffer( sio::kbyte ) ;
+    sio::zlib_compression compressor ;
+    std::mt19937 generator( 42 ) ;
+    unsigned int nhits = 0, nnoise = 0, ncompressed_hits = 0, nraw_noise = 0 ;
+    while( stream.peek() != EOF ) {
+      sio::api::read_record( stream, rec_info, rec_buffer ) ;
+      const bool compressed = sio::api::is_compressed( rec_info._options ) ;
+      if( compressed ) {
+        uncomp_rec_buffer.resize( rec_info._uncompressed_length ) ;
+        compressor.uncompress( rec_buffer.span( rec_info._header_length, rec_info._data_length ), uncomp_rec_buffer ) ;
+        sio::api::read_blocks( uncomp_rec_buffer.span(), blocks ) ;
+      }
+      else {
+        sio::api::read_blocks( rec_buffer.span( rec_info._header_length, rec_info._data_length ), blocks ) ;
+      }
+      const auto &words = words_blk->words() ;
+      if( words.size() != nwords ) {
+        SIO_THROW( sio::error_code::invalid_argument, "Unexpected number of words in record " + rec_info._name ) ;
+      }
+      for( unsigned int i=0 ; i<nwords ; i++ ) {
+        const unsigned int expected = ( "hits" == rec_info._name ) ? hit( nhits, i ) : static_cast<unsigned int>( generator() ) ;
+        if( words[i] != expected ) {
+          SIO_THROW( sio::error_code::invalid_argument, "Unexpected word in record " + rec_info._name ) ;
+        }
+      }
+      if( "hits" == rec_info._name ) {
+        ++ nhits ;
+        ncompressed_hits += compressed ? 1 : 0 ;
+      }
+      else {
+        ++ nnoise ;
+        nraw_noise += compressed ? 0 : 1 ;
+      }
+    }
+    std::cout << "Read " << ncompressed_hits << " of " << nhits << " hits records compressed and "
+              << nraw_noise << " of " << nnoise << " noise records raw in sio file " << fname << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
@@ -0,0 +1,140 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/block.h>
+#include <sio/block_iterator.h>
+#include <sio/compression/zlib.h>
+#include <sio/buffer.h>
+#include <sio/io_device.h>
+#include <sio/version.h>
+// -- sio examples headers
+#include <sioexamples/blocks.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/**
+ *  A collection of floats, e.g the energies of the hits of a sub-detector
+ */
+class collection_block : public sio::block {
+public:
+  collection_block( const std::string &nam ) :
+    sio::block( nam, sio::version::encode_version( 1, 0 ) ) {
+    /* nop */
+  }
+
+  std::vector<float> &values() { return _values ; }
+
+  void read( sio::read_device &device, sio::version_type /*vers*/ ) override {
+    device.data( _values ) ;
+  }
+
+  void write( sio::write_device &device ) override {
+    device.data( _values ) ;
+  }
+
+private:
+  ///< The collection values
+  std::vector<float>       _values {} ;
+};
+
+/**
+ *  This example writes records made of 40 collections and a small particle
+ *  block, with the blocks compressed individually instead of the whole
+ *  record: the collections are compressed, the particle block is below the
+ *  compression threshold and stays uncompressed. The records are then read
+ *  back with decoders for two collections only: only these two blocks are
+ *  inflated, the other ones are skipped without being uncompressed.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "block_compressed.sio" ;
+    const unsigned int nrecords = 100 ;
+    const unsigned int ncollections = 40 ;
+    
+    auto value = []( unsigned int rec, unsigned int coll, unsigned int i ) {
+      // digitized values: compressible, as real detector data
+      return static_cast<float>( ( rec * 7 + coll * 13 + i * 31 ) % 256 ) * 0.25f ;
+    } ;
+    
+    /// Write the records
+    {
+      sio::ofstream stream ;
+      stream.open( fname , std::ios::binary ) ;
+      if( not stream.is_open() ) {
+        SIO_THROW( sio::error_code::not_open, "Couldn't open output stream '" + fname + "'" ) ;
+      }
+      sio::block_list blocks {} ;
+      std::vector<std::shared_ptr<collection_block>> collections ;
+      for( unsigned int c=0 ; c<ncollections ; c++ ) {
+        collections.push_back( std::make_shared<collection_block>( "collection_" + std::to_string( c ) ) ) ;
+        blocks.push_back( collections.back() ) ;
+      }
+      auto part_blk = std::make_shared<sio::example::particle_block>() ;
+      blocks.push_back( part_blk ) ;
+      sio::buffer buf( sio::kbyte ) ;
+      sio::buffer compbuf( sio::kbyte ) ;
+      sio::zlib_compression compressor ;
+      unsigned int ncompressed = 0 ;
+      for( unsigned int r=0 ; r<nrecords ; r++ ) {
+        for( unsigned int c=0 ; c<ncollections ; c++ ) {
+          auto &values = collections[c]->values() ;
+          values.resize( 500 ) ;
+          for( unsigned int i=0 ; i<values.size() ; i++ ) {
+            values[i] = value( r, c, i ) ;
+          }
+        }
+        sio::example::particle part ;
+        part._pid = r ;
+        part_blk->set_particle( part ) ;
+        auto rec_info = sio::api::write_record( "event", buf, blocks, 0 ) ;
+        /// Compress the blocks individually, blocks below 1 kB are not compressed
+        sio::api::compress_blocks( rec_info, buf, compbuf, compressor, sio::kbyte ) ;
+        for( const auto &binfo : sio::block_range( compbuf.span() ) ) {
+          if( binfo._flags & sio::block_compression_flag ) {
+            ++ ncompressed ;
+          }
+        }
+        sio::api::write_record( stream, buf.span( 0, rec_info._header_length ), compbuf.span(), rec_info ) ;
+      }
+      std::cout << "Written " << nrecords << " records with " << ncompressed << " compressed blocks in sio file " << fname << std::endl ;
+    }
+    
+    /// Read back two collections out of 40
+    sio::ifstream stream ;
+    stream.open( fname , std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+    }
+    auto first = std::make_shared<collection_block>( "collection_3" ) ;
+    auto second = std::make_shared<collection_block>( "collection_27" ) ;
+    auto part_blk = std::make_shared<sio::example::particle_block>() ;
+    sio::block_list blocks { first, second, part_blk } ;
+    sio::record_info rec_info ;
+    sio::buffer rec_buffer( sio::kbyte ) ;
+    unsigned int nread = 0 ;
+    while( stream.peek() != EOF ) {
+      sio::api::read_record( stream, rec_info, rec_buffer ) ;
+      sio::api::read_blocks( rec_buffer.span( rec_info._header_length, rec_info._data_length ), blocks ) ;
+      for( unsigned int i=0 ; i<500 ; i++ ) {
+        if( first->values().at( i ) != value( nread, 3, i ) or second->values().at( i ) != value( nread, 27, i ) ) {
+          SIO_THROW( sio::error_code::invalid_argument, "Unexpected collection value in record " + std::to_string( nread ) ) ;
+        }
+      }
+      if( part_blk->get_particle()._pid != static_cast<int>( nread ) ) {
+        SIO_THROW( sio::error_code::invalid_argument, "Unexpected particle pid " + std::to_string( part_blk->get_particle()._pid ) ) ;
+      }
+      ++ nread ;
+    }
+    std::cout << "Read 2 of " << ncollections << " collections from " << nread << " records in sio file " << fname << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
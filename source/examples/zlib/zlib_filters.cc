@@ -0,0 +1,145 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/block.h>
+#include <sio/compression/zlib.h>
+#include <sio/buffer.h>
+#include <sio/io_device.h>
+#include <sio/version.h>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+
+/**
+ *  A calorimeter hit collection: sorted cell ids and energies
+ */
+class calo_hits_block : public sio::block {
+public:
+  calo_hits_block( const std::string &nam ) :
+    sio::block( nam, sio::version::encode_version( 1, 0 ) ) {
+    /* nop */
+  }
+
+  std::vector<unsigned int> &cell_ids() { return _cell_ids ; }
+  std::vector<float> &energies() { return _energies ; }
+
+  void read( sio::read_device &device, sio::version_type /*vers*/ ) override {
+    device.data( _cell_ids ) ;
+    device.data( _energies ) ;
+  }
+
+  void write( sio::write_device &device ) override {
+    device.data( _cell_ids ) ;
+    device.data( _energies ) ;
+  }
+
+private:
+  ///< The hit cell ids, in increasing order
+  std::vector<unsigned int>     _cell_ids {} ;
+  ///< The hit energies
+  std::vector<float>            _energies {} ;
+};
+
+/**
+ *  This example writes the same calorimeter records twice with per-block
+ *  compression: without and with the byte-shuffle and delta pre-compression
+ *  filters. The cell ids are delta encoded and shuffled, the energies are
+ *  shuffled. The filtered file is read back and checked.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "filtered.sio" ;
+    const unsigned int nrecords = 100 ;
+    const unsigned int nhits = 4000 ;
+    
+    auto fill = [&]( unsigned int rec, calo_hits_block &hits ) {
+      std::mt19937 generator( rec ) ;
+      std::uniform_int_distribution<unsigned int> step( 1, 64 ) ;
+      std::exponential_distribution<float> energy( 2.f ) ;
+      hits.cell_ids().resize( nhits ) ;
+      hits.energies().resize( nhits ) ;
+      unsigned int cell_id = 0x10000000 ;
+      for( unsigned int i=0 ; i<nhits ; i++ ) {
+        cell_id += step( generator ) ;
+        hits.cell_ids()[i] = cell_id ;
+        hits.energies()[i] = energy( generator ) ;
+      }
+    } ;
+    
+    /// The hits are two arrays in the same block: with the array counts,
+    /// the block data is a single array of 4 bytes elements. Both blocks
+    /// are shuffled. The hcal block is also delta encoded, which pays off
+    /// for the sorted cell ids (the energies are delta encoded too)
+    sio::block_filters hits_filters ;
+    hits_filters["ecal_hits"]._element_size = 4 ;
+    hits_filters["hcal_hits"]._element_size = 4 ;
+    hits_filters["hcal_hits"]._delta = true ;
+    
+    std::size_t file_sizes[2] = { 0, 0 } ;
+    for( unsigned int pass=0 ; pass<2 ; pass++ ) {
+      const std::string pass_fname = pass ? fname : fname + ".unfiltered" ;
+      sio::ofstream stream ;
+      stream.open( pass_fname , std::ios::binary ) ;
+      if( not stream.is_open() ) {
+        SIO_THROW( sio::error_code::not_open, "Couldn't open output stream '" + pass_fname + "'" ) ;
+      }
+      auto ecal_blk = std::make_shared<calo_hits_block>( "ecal_hits" ) ;
+      auto hcal_blk = std::make_shared<calo_hits_block>( "hcal_hits" ) ;
+      sio::block_list blocks { ecal_blk, hcal_blk } ;
+      sio::buffer buf( sio::kbyte ) ;
+      sio::buffer compbuf( sio::kbyte ) ;
+      sio::zlib_compression compressor ;
+      const sio::block_filters filters = pass ? hits_filters : sio::block_filters() ;
+      for( unsigned int r=0 ; r<nrecords ; r++ ) {
+        fill( r, *ecal_blk ) ;
+        fill( r + nrecords, *hcal_blk ) ;
+        auto rec_info = sio::api::write_record( "calo", buf, blocks, 0 ) ;
+        sio::api::compress_blocks( rec_info, buf, compbuf, compressor, sio::kbyte, filters ) ;
+        sio::api::write_record( stream, buf.span( 0, rec_info._header_length ), compbuf.span(), rec_info ) ;
+      }
+      file_sizes[pass] = static_cast<std::size_t>( stream.tellp() ) ;
+    }
+    std::cout << "File size without filters: " << file_sizes[0] << ", with filters: " << file_sizes[1] << std::endl ;
+    if( file_sizes[1] >= file_sizes[0] ) {
+      SIO_THROW( sio::error_code::bad_state, "The filters didn't improve the compression" ) ;
+    }
+    
+    /// Read back the filtered file: the filters are inverted by read_blocks()
+    sio::ifstream stream ;
+    stream.open( fname , std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+    }
+    auto ecal_blk = std::make_shared<calo_hits_block>( "ecal_hits" ) ;
+    auto hcal_blk = std::make_shared<calo_hits_block>( "hcal_hits" ) ;
+    sio::block_list blocks { ecal_blk, hcal_blk } ;
+    calo_hits_block expected( "expected" ) ;
+    sio::record_info rec_info ;
+    sio::buffer rec_buffer( sio::kbyte ) ;
+    unsigned int nread = 0 ;
+    while( stream.peek() != EOF ) {
+      sio::api::read_record( stream, rec_info, rec_buffer ) ;
+      sio::api::read_blocks( rec_buffer.span( rec_info._header_length, rec_info._data_length ), blocks ) ;
+      fill( nread, expected ) ;
+      if( ecal_blk->cell_ids() != expected.cell_ids() or ecal_blk->energies() != expected.energies() ) {
+        SIO_THROW( sio::error_code::bad_state, "Unexpected ecal hits in record " + std::to_string( nread ) ) ;
+      }
+      fill( nread + nrecords, expected ) ;
+      if( hcal_blk->cell_ids() != expected.cell_ids() or hcal_blk->energies() != expected.energies() ) {
+        SIO_THROW( sio::error_code::bad_state, "Unexpected hcal hits in record " + std::to_string( nread ) ) ;
+      }
+      ++ nread ;
+    }
+    std::cout << "Read " << nread << " records with filtered blocks from sio file " << fname << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
@@ -0,0 +1,151 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/exception.h>
+#include <sio/api.h>
+#include <sio/block.h>
+#include <sio/compression/zlib.h>
+#include <sio/buffer.h>
+#include <sio/io_device.h>
+#include <sio/version.h>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+
+/**
+ *  Simulated energy deposits, written with a reduced precision
+ */
+class deposits_block : public sio::block {
+public:
+  deposits_block( unsigned int mantissa_bits ) :
+    sio::block( "deposits", sio::version::encode_version( 1, 0 ) ),
+    _mantissa_bits( mantissa_bits ) {
+    /* nop */
+  }
+
+  std::vector<float> &energies() { return _energies ; }
+  std::vector<double> &times() { return _times ; }
+
+  void read( sio::read_device &device, sio::version_type /*vers*/ ) override {
+    device.data( _energies ) ;
+    device.data( _times ) ;
+  }
+
+  void write( sio::write_device &device ) override {
+    // keep only the requested mantissa bits: lossy, but compresses better
+    device.data( _energies, _mantissa_bits ) ;
+    device.data( _times, _mantissa_bits ) ;
+  }
+
+private:
+  ///< The number of mantissa bits to write
+  const unsigned int            _mantissa_bits ;
+  ///< The deposited energies
+  std::vector<float>            _energies {} ;
+  ///< The deposit times
+  std::vector<double>           _times {} ;
+};
+
+/**
+ *  This example writes the same simulated energy deposits with the full
+ *  precision and with 10 mantissa bits only, compressed with zlib. The
+ *  reduced precision file is read back and the relative error is checked.
+ */
+int main( int argc, char **argv ) {
+  
+  try {
+    const std::string fname = (argc > 1) ? argv[1] : "lossy.sio" ;
+    const unsigned int nrecords = 50 ;
+    const unsigned int ndeposits = 5000 ;
+    const unsigned int mantissa_bits = 10 ;
+    
+    auto fill = [&]( unsigned int rec, deposits_block &deposits ) {
+      std::mt19937 generator( rec ) ;
+      std::exponential_distribution<float> energy( 2.f ) ;
+      std::normal_distribution<double> time( 10., 2. ) ;
+      deposits.energies().resize( ndeposits ) ;
+      deposits.times().resize( ndeposits ) ;
+      for( unsigned int i=0 ; i<ndeposits ; i++ ) {
+        deposits.energies()[i] = energy( generator ) ;
+        deposits.times()[i] = time( generator ) ;
+      }
+    } ;
+    
+    /// Write the file with the full precision, then with a reduced precision
+    std::size_t file_sizes[2] = { 0, 0 } ;
+    for( unsigned int pass=0 ; pass<2 ; pass++ ) {
+      const std::string pass_fname = pass ? fname : fname + ".full" ;
+      sio::ofstream stream ;
+      stream.open( pass_fname , std::ios::binary ) ;
+      if( not stream.is_open() ) {
+        SIO_THROW( sio::error_code::not_open, "Couldn't open output stream '" + pass_fname + "'" ) ;
+      }
+      // 52 bits: the full double precision
+      auto deposits_blk = std::make_shared<deposits_block>( pass ? mantissa_bits : 52 ) ;
+      sio::block_list blocks { deposits_blk } ;
+      sio::buffer buf( sio::kbyte ) ;
+      sio::buffer compbuf( sio::kbyte ) ;
+      sio::zlib_compression compressor ;
+      for( unsigned int r=0 ; r<nrecords ; r++ ) {
+        fill( r, *deposits_blk ) ;
+        auto rec_info = sio::api::write_record( "deposits", buf, blocks, 0 ) ;
+        sio::api::compress_record( rec_info, buf, compbuf, compressor ) ;
+        sio::api::write_record( stream, buf.span( 0, rec_info._header_length ), compbuf.span(), rec_info ) ;
+      }
+      file_sizes[pass] = static_cast<std::size_t>( stream.tellp() ) ;
+    }
+    std::cout << "File size with full precision: " << file_sizes[0] << ", with " << mantissa_bits << " mantissa bits: " << file_sizes[1] << std::endl ;
+    if( file_sizes[1] >= file_sizes[0] ) {
+      SIO_THROW( sio::error_code::bad_state, "The precision reduction didn't improve the compression" ) ;
+    }
+    
+    /// Read back and check the precision
+    sio::ifstream stream ;
+    stream.open( fname , std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + fname + "'" ) ;
+    }
+    auto deposits_blk = std::make_shared<deposits_block>( mantissa_bits ) ;
+    sio::block_list blocks { deposits_blk } ;
+    deposits_block expected( mantissa_bits ) ;
+    sio::record_info rec_info ;
+    sio::buffer rec_buffer( sio::kbyte ) ;
+    sio::buffer uncomp_rec_buffer( sio::kbyte ) ;
+    sio::zlib_compression compressor ;
+    const double max_error = std::ldexp( 1., -static_cast<int>( mantissa_bits ) ) ;
+    double worst_error = 0. ;
+    unsigned int nread = 0 ;
+    while( stream.peek() != EOF ) {
+      sio::api::read_record( stream, rec_info, rec_buffer ) ;
+      uncomp_rec_buffer.resize( rec_info._uncompressed_length ) ;
+      compressor.uncompress( rec_buffer.span( rec_info._header_length, rec_info._data_length ), uncomp_rec_buffer ) ;
+      sio::api::read_blocks( uncomp_rec_buffer.span(), blocks ) ;
+      fill( nread, expected ) ;
+      for( unsigned int i=0 ; i<ndeposits ; i++ ) {
+        const double values[2][2] = {
+          { deposits_blk->energies()[i], expected.energies()[i] },
+          { deposits_blk->times()[i], expected.times()[i] }
+        } ;
+        for( const auto &value : values ) {
+          // truncated toward zero, within the relative error
+          const double error = ( value[1] != 0. ) ? ( value[1] - value[0] ) / value[1] : 0. ;
+          if( error < 0. or error > max_error ) {
+            SIO_THROW( sio::error_code::bad_state, "Unexpected precision loss in record " + std::to_string( nread ) ) ;
+          }
+          worst_error = std::max( worst_error, error ) ;
+        }
+      }
+      ++ nread ;
+    }
+    std::cout << "Worst relative error: " << worst_error << std::endl ;
+    std::cout << "Read " << nread << " records with " << mantissa_bits << " mantissa bits from sio file " << fname << std::endl ;
+  }
+  catch( sio::exception &e ) {
+    std::cout << "Caught sio exception :\n" << e.what() << std::endl ;
+  }
+  
+  return 0 ;
+}
@@ -17,6 +17,7 @@ namespace sio {
   class buffer_span ;
   class block ;
   class write_device ;
+  class zlib_compression ;
 
   /**
    *  @brief  api class.
@@ -128,6 +129,17 @@ namespace sio {
      */
     static void read_record_info( sio::ifstream &stream, record_info &rec_info, buffer &outbuf ) ;
 
+    /**
+     *  @brief  Parse a record header from a buffer holding the record header bytes.
+     *          The record name is not copied but points into the buffer. The
+     *          field _file_start must be set by the caller, _file_end is computed
+     *          from it and from the record lengths (including padding).
+     *
+     *  @param  hdr_buf the buffer starting with the record header
+     *  @param  rec_info the record info view to receive
+     */
+    static void read_record_info( const buffer_span &hdr_buf, record_info_view &rec_info ) ;
+
     /**
      *  @brief  Read out the record data from the input stream. The record data
      *          bytes are written in the buffer passed by reference. By default, the
@@ -246,6 +258,17 @@ namespace sio {
      */
     static std::pair<block_info, buffer_span> extract_block( const buffer_span &rec_buf, buffer_span::index_type index ) ;
 
+    /**
+     *  @brief  Extract the block info at the given index without allocating.
+     *          The block name in the block info view points into the record buffer.
+     *          Returns the buffer span of the block (header + data)
+     *
+     *  @param  rec_buf the record buffer
+     *  @param  index the index of block header start in the record buffer
+     *  @param  info the block info view to receive
+     */
+    static buffer_span extract_block( const buffer_span &rec_buf, buffer_span::index_type index, block_info_view &info ) ;
+
     /**
      *  @brief  Decode the record buffer using the block decoder.
      *          Loop over the blocks found in the buffer and try to decode it.
@@ -260,7 +283,8 @@ namespace sio {
      *  @brief  Dump the records from the input stream to the console.
      *          Note that if you use a detailed printout, the record
      *          is first uncompressed using zlib and the block infos
-     *          are printed out too.
+     *          are printed out too. Same as dump::records() with a
+     *          single thread.
      *
      *  @param  stream the input stream
      *  @param  skip the number of records to skip from the current position
@@ -307,6 +331,63 @@ namespace sio {
     template <typename compT>
     static void compress_record( record_info &rec_info, buffer &rec_buf, buffer &comp_buf, compT &compressor ) ;
 
+    /**
+     *  @brief  Compress the record buffer if compression pays off. The record
+     *          is compressed as in the overload above, then stored raw (not
+     *          flagged as compressed) if the compressed data is larger than
+     *          max_ratio times the uncompressed data, e.g already compressed
+     *          payloads or detector noise. In both cases comp_buf receives the
+     *          record data to write and the record header is overwritten in
+     *          the record buffer, so that the record is written the same way.
+     *
+     *  @param  rec_info the record info instance
+     *  @param  rec_buf the record buffer
+     *  @param  comp_buf the buffer to receive the record data (compressed or not)
+     *  @param  compressor the record compressor
+     *  @param  max_ratio the maximum compressed / uncompressed size ratio to store the record compressed
+     *  @return whether the record is stored compressed
+     */
+    template <typename compT>
+    static bool compress_record( record_info &rec_info, buffer &rec_buf, buffer &comp_buf, compT &compressor, double max_ratio ) ;
+
+    /**
+     *  @brief  Store the record data uncompressed, the counterpart of
+     *          compress_record() for records not worth compressing:
+     *          - the record data is copied in out_buf
+     *          - the record info is updated (no compression bit, uncompressed data length)
+     *          - the record header is overwritten in the record buffer
+     *          The record buffer can have been compressed already by compress_record().
+     *
+     *  @param  rec_info the record info instance
+     *  @param  rec_buf the record buffer
+     *  @param  out_buf the buffer to receive the record data
+     */
+    static void store_record( record_info &rec_info, buffer &rec_buf, buffer &out_buf ) ;
+
+    /**
+     *  @brief  Compress the blocks of the record buffer individually, as an
+     *          alternative to compress_record(). A block is then only inflated
+     *          when its decoder runs in read_blocks(), so that reading a few
+     *          blocks of a record doesn't require to inflate the whole record.
+     *          The compressed blocks are flagged in their block header (see
+     *          flagged_block_marker). Blocks smaller than the threshold, or
+     *          which don't shrink, are kept as is. The record is not flagged
+     *          as compressed:
+     *          - the record data with compressed blocks is received in comp_buf
+     *          - the record info is updated with the new record data length
+     *          - the record header is overwritten in the record buffer
+     *          The blocks are compressed with zlib, the only codec that
+     *          read_blocks() decodes.
+     *
+     *  @param  rec_info the record info instance
+     *  @param  rec_buf the record buffer
+     *  @param  comp_buf the buffer to receive the record data
+     *  @param  compressor the zlib compressor (sets the compression level)
+     *  @param  threshold the minimum block data size to compress
+     *  @param  filter_map the pre-compression filters per block name (see sio::filters)
+     */
+    static void compress_blocks( record_info &rec_info, buffer &rec_buf, buffer &comp_buf, zlib_compression &compressor, std::size_t threshold = sio::kbyte, const block_filters &filter_map = block_filters() ) ;
+
     /**
      *  @brief  Write the full record buffer in the output stream. The stream
      *          is flushed after writing the buffer
@@ -331,6 +412,93 @@ namespace sio {
     static void write_record( sio::ofstream &stream, const buffer_span &hdr_span, const buffer_span &data_span, record_info &rec_info ) ;
     ///@}
 
+    /**
+     *  @name Record I/O with sources and sinks
+     *  Same as the stream functions above but reading from a record source
+     *  and writing to a record sink (see sio/source.h and sio/sink.h), e.g a
+     *  memory buffer or a file
+     */
+    ///@{
+    /**
+     *  @brief  Read the next record header from the source.
+     *          See the stream version for details
+     *
+     *  @param  source the record source
+     *  @param  rec_info the record info to receive
+     *  @param  outbuf the buffer containing the record info bytes
+     */
+    template <class srcT>
+    static void read_record_info( srcT &source, record_info &rec_info, buffer &outbuf ) ;
+
+    /**
+     *  @brief  Read out the record data from the source.
+     *          The source is only moved if it is not already at the
+     *          record data position. See the stream version for details
+     *
+     *  @param  source the record source
+     *  @param  rec_info the record info
+     *  @param  outbuf the buffer to receive the record data bytes
+     *  @param  buffer_shift an optional shift from the start of the buffer
+     */
+    template <class srcT>
+    static void read_record_data( srcT &source, const record_info &rec_info, buffer &outbuf, std::size_t buffer_shift = 0 ) ;
+
+    /**
+     *  @brief  Read out the record (header + data) from the source
+     *
+     *  @param  source the record source
+     *  @param  rec_info the record info to receive
+     *  @param  outbuf the record header + data bytes to receive
+     */
+    template <class srcT>
+    static void read_record( srcT &source, record_info &rec_info, buffer &outbuf ) ;
+
+    /**
+     *  @brief  Read out the next records from the source.
+     *          See the stream version for details
+     *
+     *  @param  source the record source
+     *  @param  outbuf the record header + data bytes to receive
+     *  @param  valid the record info validation predicate
+     *  @param  func the function processing the record data
+     */
+    template <class srcT, typename ValidPred, typename ReadFunc>
+    static void read_records( srcT &source, buffer &outbuf, ValidPred valid, ReadFunc func ) ;
+
+    /**
+     *  @brief  Skip the next records from the source while the unary
+     *          predicate is true. See the stream version for details
+     *
+     *  @param  source the record source
+     *  @param  pred the unary predicate
+     */
+    template <class srcT, class UnaryPredicate>
+    static void skip_records( srcT &source, UnaryPredicate pred ) ;
+
+    /**
+     *  @brief  Write the full record buffer (header + data) in the sink.
+     *          The sink is flushed after writing the buffer
+     *
+     *  @param  sink the record sink
+     *  @param  rec_buf the full record buffer (header + data)
+     *  @param  rec_info the record info to update (start and end positions)
+     */
+    template <class sinkT>
+    static void write_record( sinkT &sink, const buffer_span &rec_buf, record_info &rec_info ) ;
+
+    /**
+     *  @brief  Write the record header and record data in the sink.
+     *          The sink is flushed after writing the two buffers
+     *
+     *  @param  sink the record sink
+     *  @param  hdr_span the record header buffer span
+     *  @param  data_span the record data buffer span
+     *  @param  rec_info the record info to update (start and end positions)
+     */
+    template <class sinkT>
+    static void write_record( sinkT &sink, const buffer_span &hdr_span, const buffer_span &data_span, record_info &rec_info ) ;
+    ///@}
+
     /**
      *  @name Compression
      */
@@ -351,6 +519,34 @@ namespace sio {
      */
     static bool set_compression( options_type &opts, bool value ) ;
     ///@}
+
+    /**
+     *  @name Record resynchronization
+     */
+    ///@{
+    /**
+     *  @brief  Find the next record marker in a buffer. Only the 4-byte
+     *          aligned positions (relative to the start of the buffer) are
+     *          considered. Returns the position of the marker, or the buffer
+     *          size if no marker is found. A record header starts 4 bytes
+     *          before its marker. The search uses SIMD instructions when
+     *          available (SSE2, AVX2 or NEON)
+     *
+     *  @param  buf the buffer to search in
+     *  @param  start the position to start the search from
+     */
+    static std::size_t find_record_marker( const buffer_span &buf, std::size_t start = 0 ) ;
+
+    /**
+     *  @brief  Check whether a buffer starts with a plausible record header.
+     *          Unlike read_record_info(), this function does not throw and
+     *          also checks the consistency of the header fields
+     *
+     *  @param  hdr_buf the buffer starting with the record header
+     *  @param  rec_info the record info to receive
+     */
+    static bool validate_record_info( const buffer_span &hdr_buf, record_info_view &rec_info ) ;
+    ///@}
   };
 
 }
@@ -358,6 +554,8 @@ namespace sio {
 #include <sio/exception.h>
 #include <sio/memcpy.h>
 #include <sio/io_device.h>
+#include <sio/perf_counters.h>
+#include <sio/trace.h>
 
 namespace sio {
 
@@ -447,6 +645,157 @@ namespace sio {
 
   //--------------------------------------------------------------------------
 
+  template <class srcT>
+  inline void api::read_record_info( srcT &source, record_info &rec_info, buffer &outbuf ) {
+    rec_info._file_start = source.position() ;
+    outbuf.resize( sio::max_record_info_len ) ;
+    if( source.read( outbuf.data(), 8 ) < 8 ) {
+      SIO_THROW( sio::error_code::eof, "Reached end of file !" ) ;
+    }
+    // Interpret: 1) The length of the record header.
+    //            2) The record marker.
+    unsigned int marker(0) ;
+    const auto first_bytes = outbuf.span( 0, 8 ) ;
+    api::read( first_bytes, &rec_info._header_length, 0, 1 ) ;
+    api::read( first_bytes, &marker, 4, 1 ) ;
+    if( marker != sio::record_marker ) {
+      SIO_THROW( sio::error_code::no_marker, "Record marker not found!" ) ;
+    }
+    if( rec_info._header_length < 8 or rec_info._header_length > sio::max_record_info_len ) {
+      SIO_THROW( sio::error_code::no_marker, "Invalid record header length" ) ;
+    }
+    // Read the rest of the header and interpret it from the buffer
+    if( source.read( outbuf.ptr(8), rec_info._header_length-8 ) < rec_info._header_length-8 ) {
+      SIO_THROW( sio::error_code::io_failure, "Reached end of file while reading the record header!" ) ;
+    }
+    record_info_view view ;
+    view._file_start = rec_info._file_start ;
+    api::read_record_info( outbuf.span( 0, rec_info._header_length ), view ) ;
+    rec_info._options = view._options ;
+    rec_info._data_length = view._data_length ;
+    rec_info._uncompressed_length = view._uncompressed_length ;
+    rec_info._name.assign( view._name._data, view._name._size ) ;
+    rec_info._file_end = view._file_end ;
+    SIO_DEBUG( "=== Read record info ====" ) ;
+    SIO_DEBUG( rec_info ) ;
+    outbuf.resize( rec_info._header_length ) ;
+    SIO_PERF_COUNT( bytes_read, rec_info._header_length ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <class srcT>
+  inline void api::read_record_data( srcT &source, const record_info &rec_info, buffer &outbuf, std::size_t buffer_shift ) {
+    SIO_PERF_TIMER( read_record_data ) ;
+    SIO_TRACE_RECORD_SCOPE( "io", "read_record_data", rec_info._name ) ;
+    outbuf.resize( buffer_shift + rec_info._data_length ) ;
+    auto data_pos = rec_info._file_start ;
+    data_pos += rec_info._header_length ;
+    if( source.position() != data_pos ) {
+      source.seek( data_pos ) ;
+    }
+    if( source.read( outbuf.ptr( buffer_shift ), rec_info._data_length ) < rec_info._data_length ) {
+      SIO_THROW( sio::error_code::io_failure, "Reached end of file while reading the record data!" ) ;
+    }
+    SIO_PERF_COUNT( bytes_read, rec_info._data_length ) ;
+    SIO_PERF_COUNT( records_read, 1 ) ;
+    // skip the padding bytes, if any
+    if( source.position() != rec_info._file_end ) {
+      source.seek( rec_info._file_end ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <class srcT>
+  inline void api::read_record( srcT &source, record_info &rec_info, buffer &outbuf ) {
+    api::read_record_info( source, rec_info, outbuf ) ;
+    api::read_record_data( source, rec_info, outbuf, rec_info._header_length ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <class srcT, typename ValidPred, typename ReadFunc>
+  inline void api::read_records( srcT &source, buffer &outbuf, ValidPred valid, ReadFunc func ) {
+    bool continue_extract = true ;
+    while( continue_extract ) {
+      sio::record_info rec_info {} ;
+      api::read_record_info( source, rec_info, outbuf ) ;
+      if( valid( rec_info ) ) {
+        api::read_record_data( source, rec_info, outbuf, rec_info._header_length ) ;
+        continue_extract = func( rec_info, outbuf.span( rec_info._header_length, rec_info._data_length ) ) ;
+      }
+      else {
+        source.seek( rec_info._file_end ) ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <class srcT, class UnaryPredicate>
+  inline void api::skip_records( srcT &source, UnaryPredicate pred ) {
+    sio::record_info rec_info ;
+    sio::buffer rec_buffer( sio::max_record_info_len ) ;
+    while( 1 ) {
+      api::read_record_info( source, rec_info, rec_buffer ) ;
+      source.seek( rec_info._file_end ) ;
+      if( not pred( rec_info ) ) {
+        break ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <class sinkT>
+  inline void api::write_record( sinkT &sink, const buffer_span &rec_buf, record_info &rec_info ) {
+    SIO_TRACE_RECORD_SCOPE( "io", "write_record", rec_info._name ) ;
+    if( not rec_buf.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The record buffer is not valid" ) ;
+    }
+    rec_info._file_start = sink.position() ;
+    sink.write( rec_buf.data(), rec_buf.size() ) ;
+    // always add some padding bytes at the end
+    auto padlen = (4 - (rec_buf.size() & sio::bit_align)) & sio::bit_align;
+    if( padlen > 0 ) {
+      sink.write( sio::padding_bytes, padlen ) ;
+    }
+    sink.flush() ;
+    rec_info._file_end = sink.position() ;
+    SIO_PERF_COUNT( bytes_written, rec_info._file_end - rec_info._file_start ) ;
+    SIO_PERF_COUNT( records_written, 1 ) ;
+    SIO_DEBUG( "Written record with info :\n" << rec_info ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <class sinkT>
+  inline void api::write_record( sinkT &sink, const buffer_span &hdr_span, const buffer_span &data_span, record_info &rec_info ) {
+    SIO_TRACE_RECORD_SCOPE( "io", "write_record", rec_info._name ) ;
+    if( not hdr_span.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The record header buffer is not valid" ) ;
+    }
+    if( not data_span.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The record data buffer is not valid" ) ;
+    }
+    rec_info._file_start = sink.position() ;
+    sink.write( hdr_span.data(), hdr_span.size() ) ;
+    sink.write( data_span.data(), data_span.size() ) ;
+    // always add some padding bytes at the end
+    auto padlen = (4 - (data_span.size() & sio::bit_align)) & sio::bit_align;
+    if( padlen > 0 ) {
+      sink.write( sio::padding_bytes, padlen ) ;
+    }
+    sink.flush() ;
+    rec_info._file_end = sink.position() ;
+    SIO_PERF_COUNT( bytes_written, rec_info._file_end - rec_info._file_start ) ;
+    SIO_PERF_COUNT( records_written, 1 ) ;
+    SIO_DEBUG( "Written record with info :\n" << rec_info ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
   template <typename compT>
   inline void api::compress_record( record_info &rec_info, buffer &rec_buf, buffer &comp_buf, compT &compressor ) {
     if( not rec_buf.valid() ) {
@@ -476,4 +825,17 @@ namespace sio {
     }
   }
 
+  //--------------------------------------------------------------------------
+
+  template <typename compT>
+  inline bool api::compress_record( record_info &rec_info, buffer &rec_buf, buffer &comp_buf, compT &compressor, double max_ratio ) {
+    compress_record( rec_info, rec_buf, comp_buf, compressor ) ;
+    if( comp_buf.size() <= max_ratio * rec_info._uncompressed_length ) {
+      return true ;
+    }
+    // compression doesn't pay: store the record data as is
+    store_record( rec_info, rec_buf, comp_buf ) ;
+    return false ;
+  }
+
 }
@@ -0,0 +1,159 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+
+// -- std headers
+#include <cstddef>
+#include <iterator>
+
+namespace sio {
+
+  /**
+   *  @brief  block_iterator class.
+   *
+   *  Forward iterator over the block headers of a record buffer.
+   *  The block headers are parsed on the fly in block_info_view
+   *  objects, so walking a record does not allocate. The block names
+   *  point into the record buffer, so the record buffer must outlive
+   *  the iterator and the views it returns.
+   */
+  class block_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag ;
+    using value_type = block_info_view ;
+    using difference_type = std::ptrdiff_t ;
+    using pointer = const block_info_view* ;
+    using reference = const block_info_view& ;
+
+  public:
+    /// Default copy constructor
+    block_iterator( const block_iterator& ) = default ;
+    /// Default move constructor
+    block_iterator( block_iterator&& ) = default ;
+    /// Default assignement operator
+    block_iterator& operator=( const block_iterator& ) = default ;
+    /// Default move assignment operator
+    block_iterator& operator=( block_iterator&& ) = default ;
+    /// Default destructor
+    ~block_iterator() = default ;
+
+    /**
+     *  @brief  Default constructor. Creates an end iterator
+     */
+    block_iterator() = default ;
+
+    /**
+     *  @brief  Constructor with the record buffer.
+     *          The first block header is parsed directly
+     *
+     *  @param  rec_buf the record buffer (uncompressed block data)
+     */
+    block_iterator( const buffer_span &rec_buf ) ;
+
+    /**
+     *  @brief  Get the current block info
+     */
+    reference operator*() const ;
+
+    /**
+     *  @brief  Get the current block info
+     */
+    pointer operator->() const ;
+
+    /**
+     *  @brief  Move to the next block (pre-increment)
+     */
+    block_iterator &operator++() ;
+
+    /**
+     *  @brief  Move to the next block (post-increment)
+     */
+    block_iterator operator++(int) ;
+
+    /**
+     *  @brief  Whether the two iterators point to the same block
+     */
+    bool operator==( const block_iterator &rhs ) const ;
+
+    /**
+     *  @brief  Whether the two iterators point to different blocks
+     */
+    bool operator!=( const block_iterator &rhs ) const ;
+
+    /**
+     *  @brief  Get the buffer span of the current block (header + data)
+     */
+    const buffer_span &block_span() const ;
+
+    /**
+     *  @brief  Get the buffer span of the current block data (without header)
+     */
+    buffer_span data_span() const ;
+
+  private:
+    /**
+     *  @brief  Parse the block header at the current position
+     */
+    void parse() ;
+
+  private:
+    ///< The record buffer
+    buffer_span                _buffer {} ;
+    ///< The current block span
+    buffer_span                _block {} ;
+    ///< The current block info
+    block_info_view            _info {} ;
+    ///< Whether the iterator reached the end of the record buffer
+    bool                       _end {true} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /**
+   *  @brief  block_range class.
+   *
+   *  Range over the block headers of a record buffer,
+   *  usable in a range-based for loop:
+   *  @code{cpp}
+   *  for( const auto &binfo : sio::block_range( rec_buf ) ) {
+   *    if( binfo._name == "MyBlock" ) { ... }
+   *  }
+   *  @endcode
+   */
+  class block_range {
+  public:
+    /// No default constructor
+    block_range() = delete ;
+    /// Default copy constructor
+    block_range( const block_range& ) = default ;
+    /// Default assignement operator
+    block_range& operator=( const block_range& ) = default ;
+    /// Default destructor
+    ~block_range() = default ;
+
+    /**
+     *  @brief  Constructor with the record buffer
+     *
+     *  @param  rec_buf the record buffer (uncompressed block data)
+     */
+    block_range( const buffer_span &rec_buf ) ;
+
+    /**
+     *  @brief  Get an iterator on the first block
+     */
+    block_iterator begin() const ;
+
+    /**
+     *  @brief  Get the end iterator
+     */
+    block_iterator end() const ;
+
+  private:
+    ///< The record buffer
+    buffer_span                _buffer ;
+  };
+
+}
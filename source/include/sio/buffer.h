@@ -19,16 +19,17 @@ namespace sio {
    *  work with the underlying byte array, except for the
    *  assignement operator which allow to change the underlying
    *  byte array span. Note that the implementation stores a
-   *  pair of const_iterator on a byte_array. Thus the validity
-   *  of the buffer_span object relies on the validity of these
-   *  iterators.
+   *  pair of pointers on the bytes. Thus the validity of the
+   *  buffer_span object relies on the validity of the underlying
+   *  memory. A buffer_span can also be constructed on memory not
+   *  owned by a byte_array, e.g a memory mapped region.
    */
   class buffer_span {
   public:
     // traits
     using container = sio::byte_array ;
     using element_type = container::value_type ;
-    using const_iterator = container::const_iterator ;
+    using const_iterator = container::const_pointer ;
     using index_type = std::size_t ;
     using size_type = std::size_t ;
     using reference = container::reference ;
@@ -66,7 +67,7 @@ namespace sio {
      *  @param  first the start of the span
      *  @param  last the end of the span (not included)
      */
-    buffer_span( const_iterator first, const_iterator last ) ;
+    buffer_span( container::const_iterator first, container::const_iterator last ) ;
 
     /**
      *  @brief  Constructor with iterator and bytes count
@@ -74,7 +75,15 @@ namespace sio {
      *  @param  first the start of the span
      *  @param  count the number of bytes to the end of the span
      */
-    buffer_span( const_iterator first, size_type count ) ;
+    buffer_span( container::const_iterator first, size_type count ) ;
+
+    /**
+     *  @brief  Constructor with a pointer and bytes count
+     *
+     *  @param  first the start of the span
+     *  @param  count the number of bytes to the end of the span
+     */
+    buffer_span( const_pointer first, size_type count ) ;
 
     /**
      *  @name Iterators
@@ -188,10 +197,10 @@ namespace sio {
     ///@}
 
   private:
-    ///< An iterator to the begin of a byte_array
-    const_iterator    _first{} ;
-    ///< An iterator to the end of a byte_array
-    const_iterator    _last{} ;
+    ///< A pointer to the begin of the bytes
+    const_iterator    _first{nullptr} ;
+    ///< A pointer to the end of the bytes
+    const_iterator    _last{nullptr} ;
     ///< Whether the span is null (invalid)
     bool              _isnull {false} ;
   };
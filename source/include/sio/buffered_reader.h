@@ -0,0 +1,240 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+
+// -- std headers
+#include <cstddef>
+
+namespace sio {
+
+  /**
+   *  @brief  buffered_reader class.
+   *
+   *  Sequential record reader keeping its own read-ahead window on top
+   *  of an input stream. Consecutive record headers and record data are
+   *  parsed directly out of the window and the stream is only accessed
+   *  when the window is exhausted, with a single large read. Reading a
+   *  file made of small records then costs one stream read per window
+   *  instead of several reads and seeks per record.
+   *
+   *  The buffer spans returned by the reader point into the window and
+   *  are valid until the next call to the reader. The record name in the
+   *  record info view is valid until the next record header is read out.
+   *  Records larger than the window are handled by growing the window.
+   *
+   *  Non seekable streams (pipes, FIFOs, /dev/stdin) are read in forward-only
+   *  mode: the stream is never moved with seekg(), the record data that are
+   *  skipped are read and discarded. Seeking backward outside of the window
+   *  is then an error. No data is read ahead of the requested bytes, so that
+   *  a record is available as soon as the producer has written it. The
+   *  forward-only mode is enabled automatically if the stream position can
+   *  not be queried and can be forced for any stream.
+   *
+   *  Example:
+   *  @code{cpp}
+   *  sio::buffered_reader reader( stream ) ;
+   *  sio::record_info_view rec_info ;
+   *  while( reader.next_record_info( rec_info ) ) {
+   *    if( rec_info._name == "MyRecord" ) {
+   *      auto data = reader.read_record_data() ;
+   *      // ... uncompress and decode
+   *    }
+   *  }
+   *  @endcode
+   */
+  class buffered_reader {
+  public:
+    using pos_type = sio::ifstream::pos_type ;
+    using size_type = std::size_t ;
+
+  public:
+    /// No default constructor
+    buffered_reader() = delete ;
+    /// No copy constructor
+    buffered_reader( const buffered_reader& ) = delete ;
+    /// No assignment by copy
+    buffered_reader& operator=( const buffered_reader& ) = delete ;
+    /// Default destructor
+    ~buffered_reader() = default ;
+
+    /**
+     *  @brief  Constructor. The reader starts reading at the current stream position
+     *
+     *  @param  stream the input stream to read from
+     *  @param  window_size the initial size of the read-ahead window
+     */
+    buffered_reader( sio::ifstream &stream, size_type window_size = 4*sio::mbyte ) ;
+
+    /**
+     *  @name Record I/O
+     */
+    ///@{
+    /**
+     *  @brief  Read the next record header. If the data of the previous record
+     *          has not been read out, it is skipped. Throws an exception with
+     *          error_code::eof if the end of the stream is reached.
+     *
+     *  @param  rec_info the record info view to receive
+     */
+    void read_record_info( record_info_view &rec_info ) ;
+
+    /**
+     *  @brief  Read the next record header (owning record info version)
+     *
+     *  @param  rec_info the record info to receive
+     */
+    void read_record_info( record_info &rec_info ) ;
+
+    /**
+     *  @brief  Read the next record header. Returns false on end of stream
+     *          instead of throwing an exception
+     *
+     *  @param  rec_info the record info view to receive
+     */
+    bool next_record_info( record_info_view &rec_info ) ;
+
+    /**
+     *  @brief  Get the data of the last record header read out.
+     *          The returned span points into the read-ahead window
+     */
+    buffer_span read_record_data() ;
+
+    /**
+     *  @brief  Copy the data of the last record header read out in a buffer.
+     *          Same semantic as api::read_record_data()
+     *
+     *  @param  outbuf the buffer to receive the record data bytes
+     *  @param  buffer_shift an optional shift from the start of the buffer
+     */
+    void read_record_data( buffer &outbuf, size_type buffer_shift = 0 ) ;
+
+    /**
+     *  @brief  Get the full record (header + data) of the last record header read out.
+     *          The returned span points into the read-ahead window
+     */
+    buffer_span read_record() ;
+
+    /**
+     *  @brief  Read out records while the user functions returns true.
+     *          Same semantic as api::read_records() but the record data
+     *          are not copied.
+     *
+     *  @param  valid the record info validation predicate
+     *  @param  func the function processing the record data
+     */
+    template <typename ValidPred, typename ReadFunc>
+    void read_records( ValidPred valid, ReadFunc func ) ;
+
+    /**
+     *  @brief  Skip the next records while the unary predicate is true.
+     *          Same semantic as api::skip_records()
+     *
+     *  @param  pred the unary predicate
+     */
+    template <class UnaryPredicate>
+    void skip_records( UnaryPredicate pred ) ;
+    ///@}
+
+    /**
+     *  @name Positioning
+     */
+    ///@{
+    /**
+     *  @brief  Get the position of the next record to read out
+     */
+    pos_type position() const ;
+
+    /**
+     *  @brief  Set the position of the next record to read out.
+     *          The stream is only accessed if the position is outside the window
+     *
+     *  @param  pos the position of a record header in the stream
+     */
+    void seek( pos_type pos ) ;
+
+    /**
+     *  @brief  Whether the reader is in forward-only mode (no stream seek)
+     */
+    bool forward_only() const ;
+
+    /**
+     *  @brief  Enable or disable the forward-only mode. Disabling it on a non
+     *          seekable stream will make the next seek operation fail
+     *
+     *  @param  enable whether to enable the forward-only mode
+     */
+    void set_forward_only( bool enable ) ;
+    ///@}
+
+    /**
+     *  @brief  Get the number of read operations performed on the stream
+     */
+    size_type stream_reads() const ;
+
+  private:
+    /**
+     *  @brief  Make sure the bytes [pos, pos+len) are in the window.
+     *          Returns the number of bytes actually available from pos
+     *
+     *  @param  pos the absolute stream position
+     *  @param  len the number of bytes required
+     */
+    size_type fill( size_type pos, size_type len ) ;
+
+  private:
+    ///< The input stream
+    sio::ifstream           &_stream ;
+    ///< The read-ahead window
+    sio::buffer              _window ;
+    ///< The stream position of the first window byte
+    size_type                _window_start {0} ;
+    ///< The number of valid bytes in the window
+    size_type                _window_len {0} ;
+    ///< The stream position of the next record
+    size_type                _next_pos {0} ;
+    ///< The last record header read out
+    record_info_view         _current {} ;
+    ///< A copy of the last record name (target of the record info view)
+    sio::byte                _name [sio::max_record_name_len] {} ;
+    ///< Whether a record header has been read out
+    bool                     _has_current {false} ;
+    ///< Whether the end of stream has been reached
+    bool                     _eof {false} ;
+    ///< Whether the stream is only read forward, without seeking
+    bool                     _forward_only {false} ;
+    ///< The number of stream read operations
+    size_type                _stream_reads {0} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  template <typename ValidPred, typename ReadFunc>
+  inline void buffered_reader::read_records( ValidPred valid, ReadFunc func ) {
+    bool continue_extract = true ;
+    record_info_view rec_info ;
+    while( continue_extract ) {
+      read_record_info( rec_info ) ;
+      if( valid( rec_info ) ) {
+        continue_extract = func( rec_info, read_record_data() ) ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <class UnaryPredicate>
+  inline void buffered_reader::skip_records( UnaryPredicate pred ) {
+    record_info_view rec_info ;
+    while( 1 ) {
+      read_record_info( rec_info ) ;
+      if( not pred( rec_info ) ) {
+        break ;
+      }
+    }
+    _has_current = false ;
+  }
+
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+#include <sio/pread_reader.h>
+#include <sio/record_index.h>
+
+// -- std headers
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sio {
+
+  /**
+   *  @brief  chain_reader class.
+   *
+   *  Reader treating an ordered list of sio files as a single logical stream
+   *  of records, numbered globally from 0. The files are opened lazily: when
+   *  a file is needed, the next files are opened in the background in
+   *  parallel, so that moving to the next file does not wait for the open
+   *  and the index loading.
+   *
+   *  The record locations of a file are taken from its index sidecar file
+   *  (see record_index) when it exists and matches the file size. No scan
+   *  of the file is needed in this case. Otherwise the record headers are
+   *  scanned once, when the file is opened. The records of a file are read
+   *  in the index order.
+   *
+   *  The reader itself must be used from a single thread.
+   *
+   *  Example:
+   *  @code{cpp}
+   *  sio::chain_reader reader( { "run1.sio", "run2.sio", "run3.sio" } ) ;
+   *  reader.go_to_record( 1500 ) ;
+   *  sio::record_info rec_info ;
+   *  sio::buffer rec_buffer( sio::mbyte ) ;
+   *  while( reader.read_next_record( rec_info, rec_buffer ) ) {
+   *    // rec_buffer contains the record header + data, as after api::read_record()
+   *  }
+   *  @endcode
+   */
+  class chain_reader {
+  public:
+    using size_type = std::size_t ;
+
+  public:
+    /// No default constructor
+    chain_reader() = delete ;
+    /// No copy constructor
+    chain_reader( const chain_reader& ) = delete ;
+    /// No assignment by copy
+    chain_reader& operator=( const chain_reader& ) = delete ;
+
+    /**
+     *  @brief  Constructor. No file is opened here
+     *
+     *  @param  fnames the ordered list of files
+     *  @param  lookahead the number of files to open in advance in parallel
+     */
+    chain_reader( const std::vector<std::string> &fnames, size_type lookahead = 4 ) ;
+
+    /**
+     *  @brief  Destructor. Wait for the background opens
+     */
+    ~chain_reader() ;
+
+    /**
+     *  @brief  Get the number of files in the chain
+     */
+    size_type files() const ;
+
+    /**
+     *  @brief  Get the number of records in a file. Opens the file
+     *
+     *  @param  file the file number in the chain
+     */
+    size_type file_records( size_type file ) ;
+
+    /**
+     *  @brief  Whether the record locations of a file come from its index
+     *          sidecar file (or from a scan). Opens the file
+     *
+     *  @param  file the file number in the chain
+     */
+    bool file_indexed( size_type file ) ;
+
+    /**
+     *  @brief  Get the total number of records. Opens all the files
+     */
+    size_type size() ;
+
+    /**
+     *  @brief  Get the file number and the record number in this file of
+     *          a global record number. Opens the files up to this record
+     *
+     *  @param  record the global record number
+     */
+    std::pair<size_type, size_type> locate( size_type record ) ;
+
+    /**
+     *  @brief  Move to a global record number. The next call to
+     *          read_next_record() reads this record
+     *
+     *  @param  record the global record number
+     */
+    void go_to_record( size_type record ) ;
+
+    /**
+     *  @brief  Get the global number of the next record to read
+     */
+    size_type current_record() const ;
+
+    /**
+     *  @brief  Read the next record (header + data). Returns false at the
+     *          end of the last file
+     *
+     *  @param  rec_info the record info to receive
+     *  @param  outbuf the buffer to receive the record header + data
+     */
+    bool read_next_record( record_info &rec_info, buffer &outbuf ) ;
+
+    /**
+     *  @brief  Read a record by global number (header + data)
+     *
+     *  @param  record the global record number
+     *  @param  rec_info the record info to receive
+     *  @param  outbuf the buffer to receive the record header + data
+     */
+    void read_record( size_type record, record_info &rec_info, buffer &outbuf ) ;
+
+  private:
+    /**
+     *  @brief  A file of the chain
+     */
+    struct chain_file {
+      ///< The file name
+      std::string                      _fname {} ;
+      ///< The file reader (null when closed)
+      std::unique_ptr<pread_reader>    _reader {} ;
+      ///< The record locations in the file
+      record_index                     _index {} ;
+      ///< Whether the locations come from the index sidecar file
+      bool                             _indexed {false} ;
+      ///< The background open (valid once launched)
+      std::shared_future<void>         _opened {} ;
+    };
+
+  private:
+    /**
+     *  @brief  Open a file and load its record locations (background thread)
+     *
+     *  @param  file the file to open
+     */
+    static void open_file( chain_file &file ) ;
+
+    /**
+     *  @brief  Start opening a file in the background if not done
+     *
+     *  @param  index the file number
+     */
+    void open_async( size_type index ) ;
+
+    /**
+     *  @brief  Get a file with its record locations loaded. Start opening
+     *          the next files in the background and wait for this one
+     *
+     *  @param  index the file number
+     */
+    chain_file &wait_open( size_type index ) ;
+
+    /**
+     *  @brief  Get a file ready for reading (re-opened if released)
+     *
+     *  @param  index the file number
+     */
+    chain_file &open( size_type index ) ;
+
+    /**
+     *  @brief  Get the number of records in a file, closing the file
+     *          if it is not the current one
+     *
+     *  @param  index the file number
+     */
+    size_type count_records( size_type index ) ;
+
+  private:
+    ///< The files of the chain
+    std::vector<std::unique_ptr<chain_file>>    _files {} ;
+    ///< The number of files to open in advance
+    const size_type                             _lookahead ;
+    ///< The current file number
+    size_type                                   _file {0} ;
+    ///< The next record number in the current file
+    size_type                                   _local {0} ;
+    ///< The global number of the next record
+    size_type                                   _global {0} ;
+  };
+
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+
+// -- std headers
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sio {
+
+  class buffer ;
+
+  /**
+   *  @brief  adaptive_compression class.
+   *
+   *  Online zlib compression policy for records. For each record name, the
+   *  compression ratio and throughput of a set of candidate zlib levels are
+   *  measured on the written records and the level to use is selected from
+   *  these observations:
+   *  - the candidate levels are first tried in turn on a few records,
+   *  - then the fastest level with a ratio close to the best observed ratio
+   *    is used, the other levels being re-probed from time to time so that
+   *    the selection follows the data,
+   *  - a record that doesn't compress below max_ratio is stored raw. If the
+   *    selected level doesn't reach max_ratio on average, the records of
+   *    this name are stored raw without spending time in compressing them,
+   *    up to the next probe.
+   *
+   *  The observations are averaged with an exponential decay. The policy is
+   *  thread safe: records can be compressed concurrently, e.g in the workers
+   *  of a concurrent writer.
+   *
+   *  Example:
+   *  @code{cpp}
+   *  sio::adaptive_compression policy ;
+   *  auto rec_info = sio::api::write_record( "event", buf, blocks, 0 ) ;
+   *  policy.compress_record( rec_info, buf, compbuf ) ;
+   *  sio::api::write_record( stream, buf.span( 0, rec_info._header_length ), compbuf.span(), rec_info ) ;
+   *  @endcode
+   */
+  class adaptive_compression {
+  public:
+    using size_type = std::size_t ;
+
+    /**
+     *  @brief  statistics struct.
+     *
+     *  The observations on the records of a given name
+     */
+    struct statistics {
+      ///< The zlib level currently selected
+      int                      _level {-1} ;
+      ///< The average compression ratio (compressed / uncompressed) of the selected level
+      double                   _ratio {1.} ;
+      ///< The average compression throughput of the selected level (MB/s of uncompressed data)
+      double                   _throughput {0.} ;
+      ///< The number of records stored compressed
+      std::uint64_t            _compressed {0} ;
+      ///< The number of records stored raw
+      std::uint64_t            _raw {0} ;
+    };
+
+  public:
+    /// No copy constructor
+    adaptive_compression( const adaptive_compression& ) = delete ;
+    /// No assignment by copy
+    adaptive_compression& operator=( const adaptive_compression& ) = delete ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  max_ratio the maximum compressed / uncompressed size ratio to store a record compressed
+     *  @param  levels the candidate zlib levels
+     */
+    adaptive_compression( double max_ratio = 0.9, const std::vector<int> &levels = { 1, 6, 9 } ) ;
+
+    /**
+     *  @brief  Set the ratio tolerance: a level is selected if its ratio is
+     *          within (1 + tolerance) times the best observed ratio. Default 0.02
+     *
+     *  @param  tolerance the ratio tolerance
+     */
+    void set_tolerance( double tolerance ) ;
+
+    /**
+     *  @brief  Set the probing periods
+     *
+     *  @param  probe_records the number of records to try each level on at startup
+     *  @param  reprobe_interval one record every reprobe_interval is compressed with another level
+     */
+    void set_probing( size_type probe_records, size_type reprobe_interval ) ;
+
+    /**
+     *  @brief  Compress a record with the level selected for its name, or
+     *          store it raw if compression doesn't pay (thread safe). See
+     *          api::compress_record() for the buffers handling
+     *
+     *  @param  rec_info the record info instance
+     *  @param  rec_buf the record buffer
+     *  @param  comp_buf the buffer to receive the record data (compressed or not)
+     *  @return whether the record is stored compressed
+     */
+    bool compress_record( record_info &rec_info, buffer &rec_buf, buffer &comp_buf ) ;
+
+    /**
+     *  @brief  Get the observations per record name
+     */
+    std::map<std::string, statistics> stats() const ;
+
+  private:
+    /**
+     *  @brief  level_state struct.
+     *
+     *  The averaged observations of a level
+     */
+    struct level_state {
+      ///< The number of records compressed with this level
+      std::uint64_t            _records {0} ;
+      ///< The average compression ratio
+      double                   _ratio {1.} ;
+      ///< The average compression throughput (MB/s)
+      double                   _throughput {0.} ;
+    };
+
+    /**
+     *  @brief  name_state struct.
+     *
+     *  The observations of the records of a given name
+     */
+    struct name_state {
+      ///< The observations per candidate level
+      std::vector<level_state> _levels {} ;
+      ///< The number of records seen
+      std::uint64_t            _records {0} ;
+      ///< The index of the selected level
+      size_type                _selected {0} ;
+      ///< The index of the next level to re-probe
+      size_type                _next_probe {0} ;
+      ///< The number of records stored compressed
+      std::uint64_t            _compressed {0} ;
+      ///< The number of records stored raw
+      std::uint64_t            _raw {0} ;
+    };
+
+    /**
+     *  @brief  Select the level to use from the observations. The mutex must be held
+     *
+     *  @param  state the name state to update
+     */
+    void select_level( name_state &state ) const ;
+
+  private:
+    ///< The maximum compression ratio to store a record compressed
+    const double                             _max_ratio ;
+    ///< The candidate zlib levels
+    const std::vector<int>                   _candidates ;
+    ///< The ratio tolerance of the level selection
+    double                                   _tolerance {0.02} ;
+    ///< The number of records to try each level on at startup
+    size_type                                _probe_records {2} ;
+    ///< The re-probing period
+    size_type                                _reprobe_interval {64} ;
+    ///< The observations per record name
+    std::map<std::string, name_state>        _states {} ;
+    ///< The policy mutex (not held during compression)
+    mutable std::mutex                       _mutex {} ;
+  };
+
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+#include <sio/record_index.h>
+
+// -- std headers
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace sio {
+
+  /**
+   *  @brief  concurrent_writer class.
+   *
+   *  Record writer that can be used by many threads at the same time to
+   *  write complete records in the same file. A writer first reserves a byte
+   *  range in the file by atomically moving the end of file offset by the
+   *  record length (header + data + padding, as in api::write_record()) and
+   *  then writes the record in this range with pwrite(). Different threads
+   *  never wait on each other for the file I/O.
+   *
+   *  The records land in the file in reservation order, which is not
+   *  deterministic. Each record is then written with a sequence number
+   *  (e.g an event number) and added to a record_index. The index is sorted
+   *  by sequence number and written in the index sidecar file on close(),
+   *  so that readers can iterate the records in a defined order. The file
+   *  itself remains a valid sio file that can be read sequentially.
+   *
+   *  Example:
+   *  @code{cpp}
+   *  sio::concurrent_writer writer( "file.sio" ) ;
+   *  // in any thread:
+   *  auto rec_info = sio::api::write_record( "event", rec_buffer, blocks, 0 ) ;
+   *  writer.write_record( rec_buffer.span(), rec_info, event_number ) ;
+   *  // once all threads are done:
+   *  writer.close() ;
+   *  @endcode
+   */
+  class concurrent_writer {
+  public:
+    using pos_type = sio::ofstream::pos_type ;
+    using size_type = std::size_t ;
+
+  public:
+    /// No default constructor
+    concurrent_writer() = delete ;
+    /// No copy constructor
+    concurrent_writer( const concurrent_writer& ) = delete ;
+    /// No assignment by copy
+    concurrent_writer& operator=( const concurrent_writer& ) = delete ;
+
+    /**
+     *  @brief  Constructor. Create (or truncate) the file
+     *
+     *  @param  fname the file name
+     *  @param  write_index whether to write the index sidecar file on close
+     */
+    concurrent_writer( const std::string &fname, bool write_index = true ) ;
+
+    /**
+     *  @brief  Destructor. Close the file if not done
+     */
+    ~concurrent_writer() ;
+
+    /**
+     *  @brief  Write a record (thread safe). The padding is computed on the
+     *          full record buffer size, as in api::write_record()
+     *
+     *  @param  rec_buf the record buffer (header + data)
+     *  @param  rec_info the record info, updated with the file positions
+     *  @param  sequence the record sequence number in the index
+     */
+    void write_record( const buffer_span &rec_buf, record_info &rec_info, std::uint64_t sequence ) ;
+
+    /**
+     *  @brief  Write a record from separate header and data buffers, e.g
+     *          after compression (thread safe)
+     *
+     *  @param  hdr_span the record header buffer
+     *  @param  data_span the record data buffer
+     *  @param  rec_info the record info, updated with the file positions
+     *  @param  sequence the record sequence number in the index
+     */
+    void write_record( const buffer_span &hdr_span, const buffer_span &data_span, record_info &rec_info, std::uint64_t sequence ) ;
+
+    /**
+     *  @brief  Get the number of bytes reserved in the file so far
+     */
+    size_type size() const ;
+
+    /**
+     *  @brief  Get the number of records written so far
+     */
+    size_type records() const ;
+
+    /**
+     *  @brief  Sort the index, write the index sidecar file (if enabled)
+     *          and close the file. Must only be called once every writer
+     *          thread has returned from write_record(): a write running
+     *          concurrently could use the closed (or reused) descriptor
+     */
+    void close() ;
+
+    /**
+     *  @brief  Get the record index. Sorted by sequence after close()
+     */
+    const record_index &index() const ;
+
+    /**
+     *  @brief  Get the file name
+     */
+    const std::string &file_name() const ;
+
+  private:
+    /**
+     *  @brief  Reserve a byte range, write the pieces and index the record
+     *
+     *  @param  pieces the record pieces (header, data)
+     *  @param  npieces the number of pieces
+     *  @param  padlen the number of padding bytes
+     *  @param  rec_info the record info to update
+     *  @param  sequence the record sequence number
+     */
+    void write_pieces( const buffer_span *pieces, size_type npieces, size_type padlen, record_info &rec_info, std::uint64_t sequence ) ;
+
+  private:
+    ///< The file name
+    const std::string              _fname ;
+    ///< Whether to write the index sidecar file
+    const bool                     _write_index ;
+    ///< The file descriptor (-1 once closed)
+    std::atomic<int>               _fd {-1} ;
+    ///< The end of the reserved file range
+    std::atomic<std::uint64_t>     _offset {0} ;
+    ///< The record index
+    record_index                   _index {} ;
+    ///< The record index mutex (never held during I/O)
+    mutable std::mutex             _index_mutex {} ;
+  };
+
+}
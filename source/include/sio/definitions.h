@@ -127,6 +127,18 @@ namespace sio {
   static constexpr unsigned int record_marker = 0xabadcafe ;
   /// The block marker
   static constexpr unsigned int block_marker  = 0xdeadbeef ;
+  /// The marker of the blocks with flags in the block header
+  static constexpr unsigned int flagged_block_marker = 0xdeadbeee ;
+  /// The block flag of the individually compressed blocks
+  static constexpr unsigned int block_compression_flag = 0x00000001 ;
+  /// The block flag of the byte-shuffled blocks (see sio::filters)
+  static constexpr unsigned int block_shuffle_flag = 0x00000002 ;
+  /// The block flag of the delta encoded blocks (see sio::filters)
+  static constexpr unsigned int block_delta_flag = 0x00000004 ;
+  /// The mask of the filter element size in the block flags
+  static constexpr unsigned int block_element_size_mask = 0x0000ff00 ;
+  /// The shift of the filter element size in the block flags
+  static constexpr unsigned int block_element_size_shift = 8 ;
   /// The maximum length of a record name
   static constexpr std::size_t max_record_name_len = 64 ;
   /// The maximum length of a record_info in memory
@@ -174,12 +186,171 @@ namespace sio {
     unsigned int                  _header_length {0} ;
     ///< The block version
     unsigned int                  _version {0} ;
-    ///< The size of the block data
+    ///< The size of the block data, as stored (compressed)
     unsigned int                  _data_length {0} ;
+    ///< The size of the block data once uncompressed
+    unsigned int                  _uncompressed_length {0} ;
+    ///< The block flags (see block_compression_flag and the filter flags)
+    unsigned int                  _flags {0} ;
     ///< The block name
     std::string                   _name {} ;
   };
 
+  /**
+   *  @brief  block_filter struct.
+   *
+   *  The pre-compression filters of a block holding an array (see sio::filters)
+   */
+  struct block_filter {
+    ///< The size of the array elements in bytes
+    unsigned int                  _element_size {4} ;
+    ///< Whether to byte-shuffle the block data by element size
+    bool                          _shuffle {true} ;
+    ///< Whether to delta encode the elements (sorted integer arrays)
+    bool                          _delta {false} ;
+  };
+
+  using block_filters = std::map<std::string, block_filter> ;
+
+  /**
+   *  @brief  name_view struct.
+   *
+   *  Non-owning view on a record or block name stored in a buffer.
+   *  Names are stored as raw bytes, so no endian conversion is needed
+   *  to compare them. The view is valid as long as the underlying buffer
+   *  is alive and not re-allocated.
+   */
+  struct name_view {
+    ///< The address of the first name character
+    const sio::byte              *_data {nullptr} ;
+    ///< The length of the name
+    std::size_t                   _size {0} ;
+
+    /**
+     *  @brief  Get a copy of the name as a string
+     */
+    std::string str() const {
+      return ( nullptr == _data ) ? std::string() : std::string( _data, _size ) ;
+    }
+  };
+
+  /**
+   *  @brief  Compare a name view with a string
+   */
+  inline bool operator==( const name_view &lhs, const std::string &rhs ) {
+    return ( lhs._size == rhs.size() ) and ( 0 == sio::byte_traits::compare( lhs._data, rhs.data(), lhs._size ) ) ;
+  }
+
+  /**
+   *  @brief  Compare a string with a name view
+   */
+  inline bool operator==( const std::string &lhs, const name_view &rhs ) {
+    return ( rhs == lhs ) ;
+  }
+
+  /**
+   *  @brief  Compare a name view with a string
+   */
+  inline bool operator!=( const name_view &lhs, const std::string &rhs ) {
+    return not ( lhs == rhs ) ;
+  }
+
+  /**
+   *  @brief  Compare a string with a name view
+   */
+  inline bool operator!=( const std::string &lhs, const name_view &rhs ) {
+    return not ( rhs == lhs ) ;
+  }
+
+  /**
+   *  @brief  record_info_view struct.
+   *
+   *  Same as record_info but the record name is a view into the
+   *  buffer holding the record header. Parsing it does not allocate
+   */
+  struct record_info_view {
+    ///< Position of the record start in the file
+    sio::ifstream::pos_type       _file_start {0} ;
+    ///< Position of the record end in the file
+    sio::ifstream::pos_type       _file_end {0} ;
+    ///< The size of the record header in memory
+    unsigned int                  _header_length {0} ;
+    ///< The record options
+    unsigned int                  _options {0} ;
+    ///< The size of the record data read out from the file
+    unsigned int                  _data_length {0} ;
+    ///< The size of the record data after uncompression (if compressed)
+    unsigned int                  _uncompressed_length {0} ;
+    ///< The record name (view in the header buffer)
+    name_view                     _name {} ;
+
+    /**
+     *  @brief  Convert to an owning record_info (copies the name)
+     */
+    record_info to_info() const {
+      record_info info ;
+      info._file_start = _file_start ;
+      info._file_end = _file_end ;
+      info._header_length = _header_length ;
+      info._options = _options ;
+      info._data_length = _data_length ;
+      info._uncompressed_length = _uncompressed_length ;
+      info._name = _name.str() ;
+      return info ;
+    }
+  };
+
+  /**
+   *  @brief  block_info_view struct.
+   *
+   *  Same as block_info but the block name is a view into the
+   *  record buffer. Parsing it does not allocate
+   */
+  struct block_info_view {
+    ///< The start position of the block in the record buffer
+    unsigned int                  _record_start {0} ;
+    ///< The end position of the block in the record buffer
+    unsigned int                  _record_end {0} ;
+    ///< The size of the block header in memory
+    unsigned int                  _header_length {0} ;
+    ///< The block version
+    unsigned int                  _version {0} ;
+    ///< The size of the block data, as stored (compressed)
+    unsigned int                  _data_length {0} ;
+    ///< The size of the block data once uncompressed
+    unsigned int                  _uncompressed_length {0} ;
+    ///< The block flags (see block_compression_flag and the filter flags)
+    unsigned int                  _flags {0} ;
+    ///< The block name (view in the record buffer)
+    name_view                     _name {} ;
+
+    /**
+     *  @brief  Convert to an owning block_info (copies the name)
+     */
+    block_info to_info() const {
+      block_info info ;
+      info._record_start = _record_start ;
+      info._record_end = _record_end ;
+      info._header_length = _header_length ;
+      info._version = _version ;
+      info._data_length = _data_length ;
+      info._uncompressed_length = _uncompressed_length ;
+      info._flags = _flags ;
+      info._name = _name.str() ;
+      return info ;
+    }
+  };
+
+  /**
+   *  @brief  Streaming operator for name_view
+   */
+  inline std::ostream &operator<<( std::ostream &stream, const name_view &name ) {
+    if( nullptr != name._data ) {
+      stream.write( name._data, name._size ) ;
+    }
+    return stream ;
+  }
+
   /**
    *  @brief  Streaming operator for record_info
    */
@@ -202,6 +373,8 @@ namespace sio {
     stream << "- header len:            " << info._header_length << std::endl ;
     stream << "- version:               " << info._version << std::endl ;
     stream << "- data len:              " << info._data_length << std::endl ;
+    stream << "- uncompressed len:      " << info._uncompressed_length << std::endl ;
+    stream << "- flags:                 " << info._flags << std::endl ;
     return stream ;
   }
 
@@ -0,0 +1,148 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+
+// -- std headers
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace sio {
+
+  /**
+   *  @brief  size_stats struct.
+   *
+   *  Size statistics of a set of records or blocks
+   */
+  struct size_stats {
+    /// The number of log2 bins of the size histogram
+    static constexpr std::size_t nbins = 40 ;
+
+    ///< The number of entries
+    std::size_t                         _count {0} ;
+    ///< The total number of bytes (on disk for the records)
+    std::uint64_t                       _bytes {0} ;
+    ///< The total number of uncompressed bytes
+    std::uint64_t                       _uncompressed_bytes {0} ;
+    ///< The smallest size
+    std::uint64_t                       _min {0} ;
+    ///< The largest size
+    std::uint64_t                       _max {0} ;
+    ///< The size histogram. Bin i counts the sizes in [2^(i-1), 2^i)
+    std::array<std::size_t, nbins>      _histogram {{}} ;
+
+    /**
+     *  @brief  Add an entry
+     *
+     *  @param  size the entry size (in the file)
+     *  @param  uncompressed_size the uncompressed size
+     */
+    void add( std::uint64_t size, std::uint64_t uncompressed_size ) ;
+
+    /**
+     *  @brief  Merge other statistics in these ones
+     *
+     *  @param  other the statistics to merge
+     */
+    void merge( const size_stats &other ) ;
+
+    /**
+     *  @brief  Get the compression ratio (uncompressed / compressed)
+     */
+    double ratio() const ;
+  };
+
+  /**
+   *  @brief  record_stats class.
+   *
+   *  Statistics of the records and blocks of one or several files,
+   *  aggregated per record name and per block name
+   */
+  class record_stats {
+  public:
+    using stats_map = std::map<std::string, size_stats> ;
+
+  public:
+    /**
+     *  @brief  Add a record
+     *
+     *  @param  rec_info the record info
+     *  @param  data the record data, uncompressed
+     */
+    void add_record( const record_info &rec_info, const buffer_span &data ) ;
+
+    /**
+     *  @brief  Merge other statistics in these ones
+     *
+     *  @param  other the statistics to merge
+     */
+    void merge( const record_stats &other ) ;
+
+    /**
+     *  @brief  Get the statistics per record name
+     */
+    const stats_map &records() const ;
+
+    /**
+     *  @brief  Get the statistics per block name
+     *          (as "record name/block name")
+     */
+    const stats_map &blocks() const ;
+
+    /**
+     *  @brief  Print the statistics tables and the size histograms
+     *
+     *  @param  out the output stream
+     */
+    void print( std::ostream &out ) const ;
+
+  private:
+    ///< The record statistics
+    stats_map                 _records {} ;
+    ///< The block statistics
+    stats_map                 _blocks {} ;
+  };
+
+  /**
+   *  @brief  dump class.
+   *
+   *  Record dump and statistics collection over the records of a file,
+   *  possibly multi-threaded. The records are read in batches by the calling
+   *  thread and a pool of threads decompresses and decodes the block headers.
+   *  The output comes out in the record order, whatever the number of
+   *  threads. api::dump_records() is the single threaded dump to the console.
+   */
+  class dump {
+  public:
+    // static API only
+    dump() = delete ;
+
+    /**
+     *  @brief  Dump the records from the input stream, see api::dump_records()
+     *
+     *  @param  stream the input stream
+     *  @param  skip the number of records to skip from the current position
+     *  @param  count the number of record to printout
+     *  @param  detailed whether to printout detailed information (block info)
+     *  @param  nthreads the number of threads decoding the records
+     *  @param  out the output stream
+     */
+    static void records( sio::ifstream &stream, std::size_t skip, std::size_t count, bool detailed, unsigned int nthreads, std::ostream &out = std::cout ) ;
+
+    /**
+     *  @brief  Collect the record and block statistics from the input stream
+     *
+     *  @param  stream the input stream
+     *  @param  skip the number of records to skip from the current position
+     *  @param  count the number of record to collect
+     *  @param  nthreads the number of threads decoding the records
+     */
+    static record_stats stats( sio::ifstream &stream, std::size_t skip, std::size_t count, unsigned int nthreads ) ;
+  };
+
+}
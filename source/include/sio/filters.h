@@ -0,0 +1,133 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+
+// -- std headers
+#include <cstddef>
+
+namespace sio {
+
+  class buffer ;
+  class buffer_span ;
+
+  /**
+   *  @brief  filters class.
+   *
+   *  Reversible pre-compression filters for the blocks holding arrays of
+   *  numbers, as written by SIO (big endian):
+   *  - byte-shuffle: the bytes of the elements are grouped by significance
+   *    (all the first bytes, then all the second bytes, ...), so that the
+   *    slowly varying bytes (exponents, high order bytes) form long runs
+   *    for the compressor,
+   *  - delta: each element is replaced by its difference to the previous
+   *    one (modulo 2^(8*element_size)), turning sorted integers (e.g cell
+   *    ids) into small numbers.
+   *
+   *  The elements are counted from the start of the data. The trailing bytes
+   *  that don't form a full element are left as is. The filters are applied
+   *  in this order: delta then shuffle. The 4 bytes shuffle uses SIMD
+   *  instructions when available (SSE2).
+   *
+   *  The filters of a compressed block are recorded in its block flags (see
+   *  api::compress_blocks()) and inverted by api::read_blocks().
+   *
+   *  The lossy mantissa truncation is applied on write instead, see
+   *  write_device::data(). It needs no inversion on read.
+   */
+  class filters {
+  public:
+    // static API only
+    filters() = delete ;
+
+    /**
+     *  @brief  Get the block flags of a filter (without the compression flag).
+     *          Throws if the element size is not supported by the filter
+     *
+     *  @param  filter the block filter
+     */
+    static unsigned int flags( const block_filter &filter ) ;
+
+    /**
+     *  @brief  Get the element size stored in block flags
+     *
+     *  @param  flags the block flags
+     */
+    static std::size_t element_size( unsigned int flags ) ;
+
+    /**
+     *  @brief  Apply the filters flagged in the block flags
+     *
+     *  @param  flags the block flags
+     *  @param  data the data to filter
+     *  @param  outbuf the buffer to receive the filtered data (resized)
+     */
+    static void apply( unsigned int flags, const buffer_span &data, buffer &outbuf ) ;
+
+    /**
+     *  @brief  Invert the filters flagged in the block flags
+     *
+     *  @param  flags the block flags
+     *  @param  data the filtered data, replaced by the original data
+     *  @param  workbuf a work buffer
+     */
+    static void invert( unsigned int flags, buffer &data, buffer &workbuf ) ;
+
+    /**
+     *  @brief  Byte-shuffle the elements
+     *
+     *  @param  from the input bytes
+     *  @param  dest the output bytes (not overlapping)
+     *  @param  size the number of bytes
+     *  @param  element_size the element size in bytes
+     */
+    static void shuffle( const sio::byte *const from, sio::byte *dest, std::size_t size, std::size_t element_size ) ;
+
+    /**
+     *  @brief  Invert the byte-shuffle of the elements
+     *
+     *  @param  from the shuffled bytes
+     *  @param  dest the output bytes (not overlapping)
+     *  @param  size the number of bytes
+     *  @param  element_size the element size in bytes
+     */
+    static void unshuffle( const sio::byte *const from, sio::byte *dest, std::size_t size, std::size_t element_size ) ;
+
+    /**
+     *  @brief  Delta encode the big endian unsigned elements, in place.
+     *          The element size must be 1, 2, 4 or 8
+     *
+     *  @param  data the bytes
+     *  @param  size the number of bytes
+     *  @param  element_size the element size in bytes
+     */
+    static void delta_encode( sio::byte *data, std::size_t size, std::size_t element_size ) ;
+
+    /**
+     *  @brief  Invert the delta encoding, in place
+     *
+     *  @param  data the bytes
+     *  @param  size the number of bytes
+     *  @param  element_size the element size in bytes
+     */
+    static void delta_decode( sio::byte *data, std::size_t size, std::size_t element_size ) ;
+
+    /**
+     *  @brief  Zero the low mantissa bits of big endian IEEE floating point
+     *          numbers, in place (lossy). Keeping n mantissa bits bounds the
+     *          relative error to 2^-n and makes the numbers compress better.
+     *          The values are truncated toward zero. Infinities are unchanged.
+     *          A NaN stays a NaN if at least one mantissa bit is kept, but a
+     *          NaN with a payload in the truncated low bits only becomes an
+     *          infinity. The truncation uses SIMD instructions when available
+     *          (SSE2)
+     *
+     *  @param  data the bytes of the numbers
+     *  @param  count the number of numbers
+     *  @param  element_size the size of the numbers: 4 (float) or 8 (double)
+     *  @param  mantissa_bits the number of mantissa bits to keep. No-op above the type mantissa size
+     */
+    static void truncate_mantissa( sio::byte *data, std::size_t count, std::size_t element_size, unsigned int mantissa_bits ) ;
+  };
+
+}
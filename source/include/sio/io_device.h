@@ -240,6 +240,30 @@ namespace sio {
     template <typename T>
     void data( const T *const var, size_type count ) ;
 
+    /**
+     *  @brief  Write out a floating point vector, keeping only the given
+     *          number of mantissa bits (lossy, see filters::truncate_mantissa()).
+     *          Move the cursor accordingly. The vector is left untouched
+     *
+     *  @param  vars the vector to write
+     *  @param  mantissa_bits the number of mantissa bits to keep
+     */
+    template <typename T>
+    void data( const std::vector<T> &vars, unsigned int mantissa_bits ) ;
+
+    /**
+     *  @brief  Write out an array of floating point variables, keeping only
+     *          the given number of mantissa bits (lossy, see
+     *          filters::truncate_mantissa()). Move the cursor accordingly.
+     *          The array is left untouched
+     *
+     *  @param  var the address of the array
+     *  @param  count the number of element to write out
+     *  @param  mantissa_bits the number of mantissa bits to keep
+     */
+    template <typename T>
+    void data( const T *const var, size_type count, unsigned int mantissa_bits ) ;
+
     /**
      *  @brief  Write out a "pointer to" pointer to the buffer.
      *          A new entry is created for a future relocation.
@@ -280,6 +304,7 @@ namespace sio {
 }
 
 #include <sio/api.h>
+#include <sio/filters.h>
 
 namespace sio {
   
@@ -383,4 +408,25 @@ namespace sio {
     _cursor += sio::api::write( _buffer, var, _cursor, count ) ;
   }
 
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline void write_device::data( const std::vector<T> &vars, unsigned int mantissa_bits ) {
+    data( (int)vars.size() ) ;
+    if( not vars.empty() ) {
+      data( &vars[0], vars.size(), mantissa_bits ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline void write_device::data( const T *const var, size_type count, unsigned int mantissa_bits ) {
+    static_assert( std::is_floating_point<T>::value, "The mantissa truncation applies to floating point types only" ) ;
+    const auto start = _cursor ;
+    data( var, count ) ;
+    // truncate the copy in the buffer, not the user data
+    sio::filters::truncate_mantissa( _buffer.ptr( start ), count, sizeof_helper<T>::size, mantissa_bits ) ;
+  }
+
 }
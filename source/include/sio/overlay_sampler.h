@@ -0,0 +1,208 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/pread_reader.h>
+#include <sio/record_cache.h>
+#include <sio/record_index.h>
+
+// -- std headers
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sio {
+
+  /**
+   *  @brief  overlay_sampler class.
+   *
+   *  Random record sampler for pile-up overlay and event mixing. The sampling
+   *  plan lists, for each signal event, the index entries of the background
+   *  records to overlay (see make_plan()). The plan is processed ahead of the
+   *  consumer in batches of signal events by a pool of threads. Each batch
+   *  is read in file offset order: the records of a batch are sorted by
+   *  position and records close to each other are read out with a single
+   *  pread() call. The records are then uncompressed by the same thread, so
+   *  that the batches are read and uncompressed in parallel.
+   *
+   *  The batches are handed out in the plan order. Each thread keeps at most
+   *  one batch ready, which bounds the memory to about nthreads batches.
+   *  A background record drawn several times in a batch is loaded once.
+   *
+   *  The index can be the index of a single file or a manifest written by
+   *  the sharded_writer. The files of a manifest are opened as listed in the
+   *  index, i.e relative to the manifest directory once read with
+   *  record_index::read().
+   *
+   *  Example:
+   *  @code{cpp}
+   *  sio::record_index index ;
+   *  index.read( sio::record_index::sidecar_name( "background.sio" ) ) ;
+   *  auto plan = sio::overlay_sampler::make_plan( index.size(), nsignal, 20, seed ) ;
+   *  sio::overlay_sampler sampler( "background.sio", index, std::move( plan ) ) ;
+   *  std::vector<sio::overlay_sampler::record_ptr> records ;
+   *  while( sampler.next_event( records ) ) {
+   *    // overlay the uncompressed records on the signal event
+   *  }
+   *  @endcode
+   */
+  class overlay_sampler {
+  public:
+    using size_type = std::size_t ;
+    using plan_type = std::vector<std::vector<size_type>> ;
+    using record_ptr = record_cache::record_ptr ;
+
+    /**
+     *  @brief  statistics struct.
+     *
+     *  The sampler I/O counts
+     */
+    struct statistics {
+      ///< The number of records loaded (read and uncompressed)
+      std::uint64_t            _records {0} ;
+      ///< The number of read calls
+      std::uint64_t            _reads {0} ;
+      ///< The number of bytes read, including the gaps between coalesced records
+      std::uint64_t            _bytes_read {0} ;
+    };
+
+  public:
+    /// No default constructor
+    overlay_sampler() = delete ;
+    /// No copy constructor
+    overlay_sampler( const overlay_sampler& ) = delete ;
+    /// No assignment by copy
+    overlay_sampler& operator=( const overlay_sampler& ) = delete ;
+
+    /**
+     *  @brief  Constructor. Open the files and start the prefetch threads
+     *
+     *  @param  fname the file name (single file index). Unused for a manifest
+     *  @param  index the record index
+     *  @param  plan the sampling plan: the index entries to load for each signal event
+     *  @param  nthreads the number of prefetch threads
+     *  @param  batch_events the number of signal events per batch
+     */
+    overlay_sampler( const std::string &fname, const record_index &index, plan_type plan, size_type nthreads = 2, size_type batch_events = 16 ) ;
+
+    /**
+     *  @brief  Destructor. Stop the prefetch threads
+     */
+    ~overlay_sampler() ;
+
+    /**
+     *  @brief  Get the background records of the next signal event, in the
+     *          plan order. Re-throws the errors of the prefetch threads
+     *
+     *  @param  records the uncompressed records to receive
+     *  @return false if the plan is exhausted
+     */
+    bool next_event( std::vector<record_ptr> &records ) ;
+
+    /**
+     *  @brief  Get the number of signal events in the plan
+     */
+    size_type events() const ;
+
+    /**
+     *  @brief  Get the I/O statistics
+     */
+    statistics stats() const ;
+
+    /**
+     *  @brief  Draw a uniform random sampling plan
+     *
+     *  @param  nentries the number of index entries to draw from
+     *  @param  nevents the number of signal events
+     *  @param  nbackground the number of background records per signal event
+     *  @param  seed the random seed
+     */
+    static plan_type make_plan( size_type nentries, size_type nevents, size_type nbackground, std::uint64_t seed ) ;
+
+  private:
+    /**
+     *  @brief  batch struct.
+     *
+     *  The loaded records of a batch of signal events
+     */
+    struct batch {
+      ///< The batch number
+      size_type                           _number {0} ;
+      ///< The records per signal event
+      std::vector<std::vector<record_ptr>>  _events {} ;
+    };
+
+    /**
+     *  @brief  worker struct.
+     *
+     *  A prefetch thread and its ready batch
+     */
+    struct worker {
+      ///< The ready batch
+      std::unique_ptr<batch>              _ready {} ;
+      ///< The error of the thread, if any
+      std::exception_ptr                  _error {} ;
+      ///< Whether the thread is done with its batches
+      bool                                _done {false} ;
+      ///< The worker mutex
+      std::mutex                          _mutex {} ;
+      ///< Notified when a batch is ready
+      std::condition_variable             _ready_cond {} ;
+      ///< Notified when the ready batch is taken
+      std::condition_variable             _taken_cond {} ;
+      ///< The thread
+      std::thread                         _thread {} ;
+    };
+
+    /**
+     *  @brief  The prefetch thread loop: load the batches worker, worker+nthreads, ...
+     *
+     *  @param  index the worker index
+     */
+    void run( size_type index ) ;
+
+    /**
+     *  @brief  Load the records of a batch
+     *
+     *  @param  number the batch number
+     */
+    std::unique_ptr<batch> load_batch( size_type number ) ;
+
+    /**
+     *  @brief  Stop and join the prefetch threads
+     */
+    void stop() ;
+
+  private:
+    ///< The record index
+    const record_index                    _index ;
+    ///< The sampling plan
+    const plan_type                       _plan ;
+    ///< The number of signal events per batch
+    const size_type                       _batch_events ;
+    ///< The readers, one per file of the index
+    std::vector<std::unique_ptr<pread_reader>> _readers {} ;
+    ///< The prefetch threads
+    std::vector<std::unique_ptr<worker>>  _workers {} ;
+    ///< The batch handed out by next_event()
+    std::unique_ptr<batch>                _current {} ;
+    ///< The next signal event to hand out
+    size_type                             _next_event {0} ;
+    ///< Whether the threads must stop
+    std::atomic<bool>                     _stop {false} ;
+    ///< The number of records loaded
+    std::atomic<std::uint64_t>            _records {0} ;
+    ///< The number of read calls
+    std::atomic<std::uint64_t>            _reads {0} ;
+    ///< The number of bytes read
+    std::atomic<std::uint64_t>            _bytes_read {0} ;
+  };
+
+}
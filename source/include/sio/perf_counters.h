@@ -0,0 +1,193 @@
+#pragma once
+
+// -- std headers
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace sio {
+
+  /**
+   *  @brief  perf class.
+   *
+   *  Opt-in performance counters of the library, compiled in with the
+   *  CMake option SIO_PERF_COUNTERS (compile definition SIO_PERF_COUNTERS).
+   *  When disabled, the instrumentation macros expand to nothing and the
+   *  snapshots only hold zeros.
+   *
+   *  The counters and timers are incremented by each thread in its own
+   *  slot, without locking nor sharing cache lines with the other threads.
+   *  A snapshot sums the slots of all the threads, past and present: the
+   *  slot of a finished thread is reused by the next new thread and keeps
+   *  its counts. The timers are inclusive: e.g the read_blocks timer also
+   *  covers the read relocation.
+   *
+   *  The counters can be printed at exit by setting the environment variable
+   *  SIO_PERF_DUMP to 1 (standard error) or to a file name, or by calling
+   *  dump_at_exit().
+   */
+  class perf {
+  public:
+    /// The counters
+    enum class counter : unsigned int {
+      bytes_read,             ///< Bytes read from files (record headers and data)
+      bytes_written,          ///< Bytes written to files (records and padding)
+      records_read,           ///< Records read from files (data read out)
+      records_written,        ///< Records written to files
+      blocks_read,            ///< Blocks decoded
+      blocks_written,         ///< Blocks encoded
+      buffer_reallocations,   ///< Buffer resizes beyond the buffer capacity
+      count                   ///< The number of counters
+    };
+
+    /// The timers
+    enum class timer : unsigned int {
+      read_record_data,       ///< api::read_record_data() and pread_reader::read_record_data()
+      compress,               ///< zlib_compression::compress()
+      uncompress,             ///< zlib_compression::uncompress()
+      read_blocks,            ///< api::read_blocks()
+      write_blocks,           ///< api::write_blocks()
+      read_relocation,        ///< api::read_relocation()
+      write_relocation,       ///< api::write_relocation()
+      count                   ///< The number of timers
+    };
+
+    static constexpr std::size_t ncounters = static_cast<std::size_t>( counter::count ) ;
+    static constexpr std::size_t ntimers = static_cast<std::size_t>( timer::count ) ;
+
+    /**
+     *  @brief  snapshot struct.
+     *
+     *  The counter values summed over all the threads
+     */
+    struct snapshot {
+      ///< The counter values
+      std::array<std::uint64_t, ncounters>   _counters {{}} ;
+      ///< The number of timed calls
+      std::array<std::uint64_t, ntimers>     _calls {{}} ;
+      ///< The timed durations (nanoseconds)
+      std::array<std::uint64_t, ntimers>     _nanoseconds {{}} ;
+      ///< The number of threads which have counted
+      std::size_t                            _threads {0} ;
+
+      /// Get a counter value
+      std::uint64_t value( counter cnt ) const ;
+      /// Get the number of calls of a timer
+      std::uint64_t calls( timer tmr ) const ;
+      /// Get the time spent in a timer (seconds)
+      double seconds( timer tmr ) const ;
+
+      /**
+       *  @brief  Print the counters and timers
+       *
+       *  @param  out the output stream
+       */
+      void print( std::ostream &out ) const ;
+    };
+
+    /**
+     *  @brief  scoped_timer class.
+     *
+     *  Time its own lifetime into a timer
+     */
+    class scoped_timer {
+    public:
+      /// No default constructor
+      scoped_timer() = delete ;
+      /// No copy constructor
+      scoped_timer( const scoped_timer& ) = delete ;
+      /// No assignment by copy
+      scoped_timer& operator=( const scoped_timer& ) = delete ;
+
+      /**
+       *  @brief  Constructor. Start the timer
+       *
+       *  @param  tmr the timer to fill
+       */
+      scoped_timer( timer tmr ) :
+        _timer( tmr ),
+        _start( std::chrono::steady_clock::now() ) {
+        /* nop */
+      }
+
+      /// Destructor. Add the elapsed time
+      ~scoped_timer() {
+        const auto elapsed = std::chrono::steady_clock::now() - _start ;
+        perf::add_time( _timer, std::chrono::duration_cast<std::chrono::nanoseconds>( elapsed ).count() ) ;
+      }
+
+    private:
+      ///< The timer to fill
+      const timer                                      _timer ;
+      ///< The start time
+      const std::chrono::steady_clock::time_point      _start ;
+    };
+
+  public:
+    // static API only
+    perf() = delete ;
+
+    /**
+     *  @brief  Whether the counters are compiled in the library
+     */
+    static bool enabled() ;
+
+    /**
+     *  @brief  Add a value to a counter of the calling thread
+     *
+     *  @param  cnt the counter
+     *  @param  value the value to add
+     */
+    static void add( counter cnt, std::uint64_t value ) ;
+
+    /**
+     *  @brief  Add a timed call to a timer of the calling thread
+     *
+     *  @param  tmr the timer
+     *  @param  nanoseconds the call duration
+     */
+    static void add_time( timer tmr, std::uint64_t nanoseconds ) ;
+
+    /**
+     *  @brief  Sum the counters of all the threads
+     */
+    static snapshot collect() ;
+
+    /**
+     *  @brief  Reset all the counters to zero. The increments
+     *          made concurrently by other threads may be lost
+     */
+    static void reset() ;
+
+    /**
+     *  @brief  Print the counters at exit
+     *
+     *  @param  fname the output file name, or empty for the standard error
+     */
+    static void dump_at_exit( const std::string &fname = "" ) ;
+
+    /**
+     *  @brief  Get the name of a counter
+     */
+    static const char *name( counter cnt ) ;
+
+    /**
+     *  @brief  Get the name of a timer
+     */
+    static const char *name( timer tmr ) ;
+  };
+
+}
+
+#ifdef SIO_PERF_COUNTERS
+// Add a value to a counter, e.g SIO_PERF_COUNT( bytes_read, len )
+#define SIO_PERF_COUNT( cnt, value ) sio::perf::add( sio::perf::counter::cnt, value )
+// Time the enclosing scope, e.g SIO_PERF_TIMER( compress )
+#define SIO_PERF_TIMER( tmr ) const sio::perf::scoped_timer sio_perf_timer_##tmr ( sio::perf::timer::tmr )
+#else
+#define SIO_PERF_COUNT( cnt, value )
+#define SIO_PERF_TIMER( tmr )
+#endif
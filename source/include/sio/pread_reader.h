@@ -0,0 +1,119 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+
+// -- std headers
+#include <cstddef>
+#include <string>
+
+namespace sio {
+
+  /**
+   *  @brief  pread_reader class.
+   *
+   *  Position independent record reader. All reads are done with pread()
+   *  at explicit file positions, so the reader has no shared cursor. A single
+   *  reader (one file descriptor) can then be used by many threads at the
+   *  same time to fetch different records, without any locking. The record
+   *  positions come from record_info::_file_start/_file_end, for example
+   *  from a file index or from a previous record.
+   *
+   *  Example:
+   *  @code{cpp}
+   *  sio::pread_reader reader( "file.sio" ) ;
+   *  // in any thread:
+   *  sio::record_info rec_info ;
+   *  sio::buffer rec_buffer( sio::mbyte ) ;
+   *  reader.read_record( position, rec_info, rec_buffer ) ;
+   *  // next record is at rec_info._file_end
+   *  @endcode
+   */
+  class pread_reader {
+  public:
+    using pos_type = sio::ifstream::pos_type ;
+    using size_type = std::size_t ;
+    /// The number of record data bytes read along with the record header in read_record()
+    static constexpr size_type read_ahead = 4*sio::kbyte ;
+
+  public:
+    /// No default constructor
+    pread_reader() = delete ;
+    /// No copy constructor
+    pread_reader( const pread_reader& ) = delete ;
+    /// No assignment by copy
+    pread_reader& operator=( const pread_reader& ) = delete ;
+
+    /**
+     *  @brief  Constructor. Open the file in read mode
+     *
+     *  @param  fname the file name
+     */
+    pread_reader( const std::string &fname ) ;
+
+    /**
+     *  @brief  Destructor. Close the file
+     */
+    ~pread_reader() ;
+
+    /**
+     *  @brief  Get the file size in bytes
+     */
+    size_type file_size() const ;
+
+    /**
+     *  @brief  Get the file name
+     */
+    const std::string &file_name() const ;
+
+    /**
+     *  @brief  Read the record header at the given position. The record header
+     *          bytes are stored in the buffer. Throws an exception with code
+     *          error_code::eof if the position is at the end of file.
+     *
+     *  @param  pos the position of the record in the file
+     *  @param  rec_info the record info to receive
+     *  @param  outbuf the buffer to receive the record header bytes
+     */
+    void read_record_info( pos_type pos, record_info &rec_info, buffer &outbuf ) const ;
+
+    /**
+     *  @brief  Read out the record data. Same semantic as api::read_record_data()
+     *
+     *  @param  rec_info the record info
+     *  @param  outbuf the buffer to receive the record data bytes
+     *  @param  buffer_shift an optional shift from the start of the buffer
+     */
+    void read_record_data( const record_info &rec_info, buffer &outbuf, size_type buffer_shift = 0 ) const ;
+
+    /**
+     *  @brief  Read out the record (header + data) at the given position.
+     *          Same semantic as api::read_record(). The header is read with
+     *          the first read_ahead bytes of data, so that small records are
+     *          read out with a single pread() call, whatever the buffer size.
+     *
+     *  @param  pos the position of the record in the file
+     *  @param  rec_info the record info to receive
+     *  @param  outbuf the buffer to receive the record header + data bytes
+     */
+    void read_record( pos_type pos, record_info &rec_info, buffer &outbuf ) const ;
+
+    /**
+     *  @brief  Read bytes at the given position. Returns the number of bytes
+     *          read, which is less than the requested length at the end of file
+     *
+     *  @param  dest where to write the bytes
+     *  @param  offset the file position
+     *  @param  length the number of bytes to read
+     */
+    size_type read_bytes( sio::byte *dest, size_type offset, size_type length ) const ;
+
+  private:
+    ///< The file name
+    const std::string             _fname ;
+    ///< The file descriptor
+    int                           _fd {-1} ;
+  };
+
+}
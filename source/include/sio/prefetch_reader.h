@@ -0,0 +1,179 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+#include <sio/buffered_reader.h>
+
+// -- std headers
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <exception>
+
+namespace sio {
+
+  /**
+   *  @brief  prefetch_reader class.
+   *
+   *  Opt-in record reader reading the next records ahead of the consumer
+   *  on a background thread. While the consumer decodes the current record,
+   *  the next records (up to a number of records and a number of bytes)
+   *  are read out into pooled buffers. This hides the latency of network
+   *  file systems behind the record decoding.
+   *
+   *  The prefetch depth adapts to the consumer speed: it grows when the
+   *  consumer has to wait for a record and shrinks slowly when the queue
+   *  of prefetched records stays full. A call to seek() cancels the
+   *  read-ahead and discards the prefetched records.
+   *
+   *  The input stream must not be used by the caller while the reader is alive.
+   *
+   *  Example:
+   *  @code{cpp}
+   *  sio::prefetch_reader reader( stream ) ;
+   *  sio::record_info rec_info ;
+   *  sio::buffer rec_buffer( sio::mbyte ) ;
+   *  while( reader.read_next_record( rec_info, rec_buffer ) ) {
+   *    // rec_buffer contains the record header + data, as after api::read_record()
+   *  }
+   *  @endcode
+   */
+  class prefetch_reader {
+  public:
+    using pos_type = sio::ifstream::pos_type ;
+    using size_type = std::size_t ;
+
+  public:
+    /// No default constructor
+    prefetch_reader() = delete ;
+    /// No copy constructor
+    prefetch_reader( const prefetch_reader& ) = delete ;
+    /// No assignment by copy
+    prefetch_reader& operator=( const prefetch_reader& ) = delete ;
+
+    /**
+     *  @brief  Constructor. Starts the background thread reading records
+     *          from the current stream position
+     *
+     *  @param  stream the input stream to read from
+     *  @param  max_records the maximum number of records to read ahead
+     *  @param  max_bytes the maximum number of bytes to read ahead
+     */
+    prefetch_reader( sio::ifstream &stream, size_type max_records = 16, size_type max_bytes = 64*sio::mbyte ) ;
+
+    /**
+     *  @brief  Destructor. Stops the background thread
+     */
+    ~prefetch_reader() ;
+
+    /**
+     *  @brief  Get the next record (header + data). The record bytes are
+     *          swapped into the output buffer and the previous buffer content
+     *          goes back to the buffer pool. Returns false at the end of the
+     *          stream. Exceptions thrown while reading ahead are re-thrown here.
+     *
+     *  @param  rec_info the record info to receive
+     *  @param  outbuf the buffer to receive the record header + data bytes
+     */
+    bool read_next_record( record_info &rec_info, buffer &outbuf ) ;
+
+    /**
+     *  @brief  Cancel the read-ahead and restart reading from a new position
+     *
+     *  @param  pos the position of a record header in the stream
+     */
+    void seek( pos_type pos ) ;
+
+    /**
+     *  @brief  Get the current prefetch depth (number of records)
+     */
+    size_type depth() const ;
+
+    /**
+     *  @brief  Get the number of times the consumer had to wait for a record
+     */
+    size_type consumer_waits() const ;
+
+  private:
+    /**
+     *  @brief  The background thread main loop
+     */
+    void run() ;
+
+    /**
+     *  @brief  Whether there is room for a new record in the queue (lock held)
+     */
+    bool has_room() const ;
+
+    /**
+     *  @brief  Take a buffer out of the pool or create a new one (lock held)
+     */
+    buffer take_buffer() ;
+
+    /**
+     *  @brief  Clear the queue and give the buffers back to the pool (lock held)
+     */
+    void clear_queue() ;
+
+  private:
+    /**
+     *  @brief  A record read ahead by the background thread
+     */
+    struct entry {
+      entry( record_info &&info, buffer &&buf ) :
+        _info( std::move(info) ),
+        _buffer( std::move(buf) ) {
+        /* nop */
+      }
+      ///< The record info
+      record_info            _info ;
+      ///< The record bytes (header + data)
+      buffer                 _buffer ;
+    };
+
+  private:
+    ///< The reader used by the background thread
+    buffered_reader                _reader ;
+    ///< The maximum number of records to read ahead
+    const size_type                _max_records ;
+    ///< The maximum number of bytes to read ahead
+    const size_type                _max_bytes ;
+    ///< The current prefetch depth
+    size_type                      _depth {2} ;
+    ///< The number of consecutive records served from a full queue
+    size_type                      _full_streak {0} ;
+    ///< The number of times the consumer had to wait
+    size_type                      _consumer_waits {0} ;
+    ///< The records read ahead
+    std::deque<entry>              _queue {} ;
+    ///< The number of bytes in the queue
+    size_type                      _queued_bytes {0} ;
+    ///< The pool of free buffers
+    std::vector<buffer>            _pool {} ;
+    ///< The read-ahead generation, incremented on seek
+    size_type                      _generation {0} ;
+    ///< The requested seek position
+    pos_type                       _seek_pos {0} ;
+    ///< Whether a seek has been requested
+    bool                           _seek_requested {false} ;
+    ///< Whether the end of stream has been reached
+    bool                           _eof {false} ;
+    ///< An exception thrown by the background thread
+    std::exception_ptr             _error {} ;
+    ///< Whether the background thread should stop
+    bool                           _stop {false} ;
+    ///< The mutex protecting the shared state
+    mutable std::mutex             _mutex {} ;
+    ///< Condition variable to wake up the background thread
+    std::condition_variable        _producer_cond {} ;
+    ///< Condition variable to wake up the consumer
+    std::condition_variable        _consumer_cond {} ;
+    ///< The background thread
+    std::thread                    _thread {} ;
+  };
+
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+#include <sio/pread_reader.h>
+
+// -- std headers
+#include <cstddef>
+#include <vector>
+
+namespace sio {
+
+  /**
+   *  @brief  range_reader class.
+   *
+   *  Reader of the records starting in a byte range of a file. The range
+   *  can start at an arbitrary byte offset: the reader first scans forward
+   *  for the next record marker (see api::find_record_marker()) and checks
+   *  the record header found there and the header of the following record
+   *  before reading from this position. The records are then read until
+   *  the first record starting at or after the end of the range.
+   *
+   *  A file can then be split in consecutive byte ranges (see split()),
+   *  processed by different threads without index and without a sequential
+   *  pre-scan. Each record is read by exactly one range. The ranges share a
+   *  single pread_reader.
+   *
+   *  Example:
+   *  @code{cpp}
+   *  sio::pread_reader reader( "file.sio" ) ;
+   *  auto bounds = sio::range_reader::split( reader.file_size(), nthreads ) ;
+   *  // in thread i:
+   *  sio::range_reader range( reader, bounds[i], bounds[i+1] ) ;
+   *  while( range.read_next_record( rec_info, rec_buffer ) ) {
+   *    // process the record
+   *  }
+   *  @endcode
+   */
+  class range_reader {
+  public:
+    using size_type = std::size_t ;
+
+    /// The size of the blocks read while scanning for a record marker
+    static constexpr size_type scan_block_size = 64*sio::kbyte ;
+
+  public:
+    /// No default constructor
+    range_reader() = delete ;
+    /// No copy constructor
+    range_reader( const range_reader& ) = delete ;
+    /// No assignment by copy
+    range_reader& operator=( const range_reader& ) = delete ;
+
+    /**
+     *  @brief  Constructor. No I/O is done here
+     *
+     *  @param  reader the file reader
+     *  @param  begin the start of the byte range
+     *  @param  end the end of the byte range (excluded)
+     */
+    range_reader( const pread_reader &reader, size_type begin, size_type end ) ;
+
+    /**
+     *  @brief  Split a file in byte ranges of (almost) equal size.
+     *          Returns the nranges+1 range boundaries
+     *
+     *  @param  file_size the file size
+     *  @param  nranges the number of ranges
+     */
+    static std::vector<size_type> split( size_type file_size, size_type nranges ) ;
+
+    /**
+     *  @brief  Get the position of the first record in the range. Scans
+     *          for it on first call. Returns the end of the range if no
+     *          record starts in the range
+     */
+    size_type first_record() ;
+
+    /**
+     *  @brief  Read the next record of the range (header + data).
+     *          Returns false once the end of the range is reached
+     *
+     *  @param  rec_info the record info to receive
+     *  @param  outbuf the buffer to receive the record header + data
+     */
+    bool read_next_record( record_info &rec_info, buffer &outbuf ) ;
+
+    /**
+     *  @brief  Get the number of bytes scanned to find the first record
+     */
+    size_type scanned_bytes() const ;
+
+  private:
+    /**
+     *  @brief  Check whether a valid record starts at the given position,
+     *          followed by another valid record or the end of file
+     *
+     *  @param  pos the candidate record position
+     *  @param  hdr_buf a scratch buffer for the record headers
+     */
+    bool valid_record( size_type pos, buffer &hdr_buf ) const ;
+
+  private:
+    ///< The file reader
+    const pread_reader         &_reader ;
+    ///< The file size
+    const size_type             _file_size ;
+    ///< The start of the byte range
+    const size_type             _begin ;
+    ///< The end of the byte range
+    const size_type             _end ;
+    ///< The position of the first record
+    size_type                   _first {0} ;
+    ///< The position of the next record
+    size_type                   _next {0} ;
+    ///< Whether the first record has been searched for
+    bool                        _synced {false} ;
+    ///< The number of bytes scanned for the first record
+    size_type                   _scanned {0} ;
+  };
+
+}
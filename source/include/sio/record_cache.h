@@ -0,0 +1,207 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+
+// -- std headers
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace sio {
+
+  class pread_reader ;
+
+  /**
+   *  @brief  record_cache class.
+   *
+   *  A thread safe cache of decoded records for repeated random access,
+   *  e.g the background records of a pile-up overlay. The records are
+   *  keyed by (file name, record position) and kept uncompressed, so that
+   *  a hit costs neither I/O nor decompression.
+   *
+   *  The cache holds at most max_bytes of record data and evicts the least
+   *  recently used records beyond. The records are handed out as shared
+   *  pointers: an evicted record stays valid as long as it is used.
+   *
+   *  Concurrent requests for the same missing record are served by a single
+   *  load: the first caller loads the record, the others wait for it. A
+   *  failed load is not cached, its exception is re-thrown to all waiting
+   *  callers.
+   *
+   *  Example:
+   *  @code{cpp}
+   *  sio::pread_reader reader( "background.sio" ) ;
+   *  sio::record_cache cache( 256*sio::mbyte ) ;
+   *  // in any thread:
+   *  auto rec = cache.get( reader, position ) ;
+   *  sio::api::read_blocks( rec->_data.span(), blocks ) ;
+   *  @endcode
+   */
+  class record_cache {
+  public:
+    using pos_type = sio::ifstream::pos_type ;
+    using size_type = std::size_t ;
+
+    /**
+     *  @brief  record struct.
+     *
+     *  A cached record
+     */
+    struct record {
+      ///< The record info, as read from the record header
+      record_info              _info {} ;
+      ///< The uncompressed record data (without header)
+      buffer                   _data { buffer::container() } ;
+    };
+
+    using record_ptr = std::shared_ptr<const record> ;
+    using load_function = std::function<void( record& )> ;
+
+    /**
+     *  @brief  statistics struct.
+     *
+     *  The cache usage counts
+     */
+    struct statistics {
+      ///< The requests served from the cache
+      std::uint64_t            _hits {0} ;
+      ///< The requests which loaded the record
+      std::uint64_t            _misses {0} ;
+      ///< The requests which waited for the load of another request
+      std::uint64_t            _shared_loads {0} ;
+      ///< The records evicted from the cache
+      std::uint64_t            _evictions {0} ;
+      ///< The number of records in the cache
+      size_type                _records {0} ;
+      ///< The number of bytes in the cache
+      size_type                _bytes {0} ;
+
+      /**
+       *  @brief  Get the fraction of the requests that didn't load a record
+       */
+      double hit_rate() const ;
+    };
+
+  public:
+    /// No default constructor
+    record_cache() = delete ;
+    /// No copy constructor
+    record_cache( const record_cache& ) = delete ;
+    /// No assignment by copy
+    record_cache& operator=( const record_cache& ) = delete ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  max_bytes the memory budget of the cached record data
+     */
+    record_cache( size_type max_bytes ) ;
+
+    /**
+     *  @brief  Get a record, read out and uncompressed on a miss (thread safe)
+     *
+     *  @param  reader the reader of the file
+     *  @param  pos the record position in the file
+     */
+    record_ptr get( const pread_reader &reader, pos_type pos ) ;
+
+    /**
+     *  @brief  Get a record, loaded with the user function on a miss (thread safe)
+     *
+     *  @param  fname the file name (cache key)
+     *  @param  pos the record position in the file (cache key)
+     *  @param  load the function filling the record on a miss
+     */
+    record_ptr get( const std::string &fname, pos_type pos, const load_function &load ) ;
+
+    /**
+     *  @brief  Whether a record is in the cache. Doesn't count as a request
+     *
+     *  @param  fname the file name
+     *  @param  pos the record position in the file
+     */
+    bool contains( const std::string &fname, pos_type pos ) const ;
+
+    /**
+     *  @brief  Drop all the cached records. The loads in progress complete
+     */
+    void clear() ;
+
+    /**
+     *  @brief  Get the usage statistics
+     */
+    statistics stats() const ;
+
+    /**
+     *  @brief  Get the memory budget
+     */
+    size_type max_bytes() const ;
+
+    /**
+     *  @brief  Read out and uncompress a record with a pread reader.
+     *          The default load function of get()
+     *
+     *  @param  reader the reader of the file
+     *  @param  pos the record position in the file
+     *  @param  rec the record to fill
+     */
+    static void load_record( const pread_reader &reader, pos_type pos, record &rec ) ;
+
+    /**
+     *  @brief  Fill a record from its record info and its record data,
+     *          uncompressed if needed
+     *
+     *  @param  rec_info the record info
+     *  @param  rec_data the record data, as read from the file
+     *  @param  rec the record to fill
+     */
+    static void unpack_record( const record_info &rec_info, const buffer_span &rec_data, record &rec ) ;
+
+  private:
+    using key_type = std::pair<std::string, std::uint64_t> ;
+
+    /**
+     *  @brief  slot struct.
+     *
+     *  A cache entry, loaded or being loaded
+     */
+    struct slot {
+      ///< The loaded record, or the load in progress
+      std::shared_future<record_ptr>         _future {} ;
+      ///< The position in the recently used list (loaded records only)
+      std::list<key_type>::iterator          _lru {} ;
+      ///< The record size in bytes
+      size_type                              _bytes {0} ;
+      ///< Whether the record is loaded
+      bool                                   _loaded {false} ;
+    };
+
+    /**
+     *  @brief  Evict the least recently used records beyond the memory budget.
+     *          The cache mutex must be held
+     */
+    void evict() ;
+
+  private:
+    ///< The memory budget
+    const size_type                          _max_bytes ;
+    ///< The cache entries
+    std::map<key_type, slot>                 _slots {} ;
+    ///< The loaded records, most recently used first
+    std::list<key_type>                      _lru {} ;
+    ///< The usage statistics
+    statistics                               _stats {} ;
+    ///< The cache mutex (never held during a load)
+    mutable std::mutex                       _mutex {} ;
+  };
+
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+
+// -- std headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sio {
+
+  /**
+   *  @brief  record_index_entry struct.
+   *
+   *  The location of a record in a file and its logical sequence number
+   */
+  struct record_index_entry {
+    ///< The logical record number (defines the reading order)
+    std::uint64_t             _sequence {0} ;
+    ///< The record position in the file
+    std::uint64_t             _position {0} ;
+    ///< The record length in the file (header + data + padding)
+    std::uint64_t             _length {0} ;
+    ///< The record name
+    std::string               _name {} ;
+    ///< The file number in the index file list (see record_index::files())
+    std::uint32_t             _file {0} ;
+  };
+
+  /**
+   *  @brief  record_index class.
+   *
+   *  A list of record locations in a file, ordered by a logical sequence
+   *  number. The index gives readers a defined order to iterate over the
+   *  records, even if the records were written in a different order in the
+   *  file (e.g by several threads), and allows random access with the
+   *  pread or uring readers.
+   *
+   *  The index is stored in a sidecar file next to the sio file (see
+   *  sidecar_name()). The sidecar is itself a sio file made of a single
+   *  record with a single block, so it can be inspected with sio-dump.
+   *
+   *  An index can also span several files (e.g the shards written by the
+   *  sharded_writer). The index then holds the list of files and each entry
+   *  refers to a file by its number in this list.
+   */
+  class record_index {
+  public:
+    using entry = record_index_entry ;
+    using container = std::vector<entry> ;
+    using const_iterator = container::const_iterator ;
+    using size_type = std::size_t ;
+    using pos_type = sio::ifstream::pos_type ;
+
+    /// The record name used in the sidecar file
+    static constexpr const char *record_name = "sio_record_index" ;
+    /// The block name used in the sidecar file
+    static constexpr const char *block_name = "record_index" ;
+
+  public:
+    /// Default constructor
+    record_index() = default ;
+    /// Default copy constructor
+    record_index( const record_index& ) = default ;
+    /// Default move constructor
+    record_index( record_index&& ) = default ;
+    /// Default assignment by copy
+    record_index& operator=( const record_index& ) = default ;
+    /// Default assignment by move
+    record_index& operator=( record_index&& ) = default ;
+    /// Default destructor
+    ~record_index() = default ;
+
+    /**
+     *  @brief  Get the sidecar index file name of a sio file
+     *
+     *  @param  fname the sio file name
+     */
+    static std::string sidecar_name( const std::string &fname ) ;
+
+    /**
+     *  @brief  Add a record to the index
+     *
+     *  @param  rec_info the record info (name, file start and end)
+     *  @param  sequence the record sequence number
+     */
+    void add( const record_info &rec_info, std::uint64_t sequence ) ;
+
+    /**
+     *  @brief  Add an entry to the index
+     *
+     *  @param  ent the entry to add
+     */
+    void add( const entry &ent ) ;
+
+    /**
+     *  @brief  Add a file to the index file list. Returns the file number
+     *
+     *  @param  fname the file name
+     */
+    std::uint32_t add_file( const std::string &fname ) ;
+
+    /**
+     *  @brief  Get the list of files referred to by the index entries.
+     *          Empty for a single file index
+     */
+    const std::vector<std::string> &files() const ;
+
+    /**
+     *  @brief  Sort the entries by sequence number (stable)
+     */
+    void sort() ;
+
+    /**
+     *  @brief  Remove all the entries and files
+     */
+    void clear() ;
+
+    /**
+     *  @brief  Get the number of entries
+     */
+    size_type size() const ;
+
+    /**
+     *  @brief  Whether the index is empty
+     */
+    bool empty() const ;
+
+    /**
+     *  @brief  Get an entry
+     *
+     *  @param  index the entry index
+     */
+    const entry &at( size_type index ) const ;
+
+    /**
+     *  @brief  Get the record positions in the index order
+     */
+    std::vector<pos_type> positions() const ;
+
+    /// Iterator to the first entry
+    const_iterator begin() const ;
+    /// Iterator past the last entry
+    const_iterator end() const ;
+
+    /**
+     *  @brief  Write the index in a sidecar file
+     *
+     *  @param  fname the index file name
+     */
+    void write( const std::string &fname ) const ;
+
+    /**
+     *  @brief  Read the index from a sidecar file. Relative file names in
+     *          the file list are resolved from the index file directory
+     *
+     *  @param  fname the index file name
+     */
+    void read( const std::string &fname ) ;
+
+  private:
+    ///< The index entries
+    container                 _entries {} ;
+    ///< The list of files
+    std::vector<std::string>  _files {} ;
+  };
+
+}
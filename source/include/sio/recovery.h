@@ -0,0 +1,89 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+
+// -- std headers
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sio {
+
+  /**
+   *  @brief  recovery_report struct.
+   *
+   *  The outcome of a recovery scan
+   */
+  struct recovery_report {
+    using range = std::pair<std::size_t, std::size_t> ;
+    ///< The file size
+    std::size_t                 _file_size {0} ;
+    ///< The number of intact records
+    std::size_t                 _records {0} ;
+    ///< The number of bytes in intact records
+    std::size_t                 _record_bytes {0} ;
+    ///< The byte ranges skipped as corrupted [begin, end)
+    std::vector<range>          _skipped {} ;
+    ///< The number of skipped bytes
+    std::size_t                 _skipped_bytes {0} ;
+  };
+
+  /**
+   *  @brief  recovery class.
+   *
+   *  Salvage the intact records of a damaged sio file, e.g a file truncated
+   *  in the middle of a record by a killed writer. The file is read in large
+   *  chunks and walked record by record. At each position the record header
+   *  is validated (see api::validate_record_info()), the record must fit in
+   *  the file and its blocks must be well formed. When a record is not
+   *  intact, the file is scanned forward for the next record marker (with
+   *  api::find_record_marker()) and the bytes in between are reported as
+   *  skipped.
+   *
+   *  The block structure of compressed records can only be checked after
+   *  decompression, which is done only on request (deep check), so that the
+   *  default scan runs at disk speed.
+   */
+  class recovery {
+  public:
+    using record_function = std::function<void( const record_info&, const buffer_span& )> ;
+
+    /// The size of the chunks read from the file
+    static constexpr std::size_t chunk_size = 16*sio::mbyte ;
+
+  public:
+    // static API only
+    recovery() = delete ;
+
+    /**
+     *  @brief  Scan a file and call a function for every intact record,
+     *          with the record info and the record bytes (header + data + padding)
+     *
+     *  @param  fname the file to scan
+     *  @param  func the function called for every intact record
+     *  @param  deep whether to also check the blocks of the compressed records
+     */
+    static recovery_report scan( const std::string &fname, const record_function &func, bool deep = false ) ;
+
+    /**
+     *  @brief  Copy the intact records of a file in a new file
+     *
+     *  @param  input the damaged file
+     *  @param  output the file to write the intact records to
+     *  @param  deep whether to also check the blocks of the compressed records
+     */
+    static recovery_report recover( const std::string &input, const std::string &output, bool deep = false ) ;
+
+    /**
+     *  @brief  Check the block structure of a (uncompressed) record data buffer
+     *
+     *  @param  data the record data
+     */
+    static bool valid_blocks( const buffer_span &data ) ;
+  };
+
+}
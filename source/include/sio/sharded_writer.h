@@ -0,0 +1,219 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+#include <sio/record_index.h>
+
+// -- std headers
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sio {
+
+  /**
+   *  @brief  shard_policy enum.
+   *
+   *  How the sharded_writer distributes the records over the output files
+   */
+  enum class shard_policy {
+    round_robin,    ///< The records go to the files in turn
+    hash            ///< The file is chosen from a hash of the record sequence number
+  };
+
+  /**
+   *  @brief  sharded_writer class.
+   *
+   *  Record writer distributing the records of a logical stream over N output
+   *  files (shards). Each shard is written by its own background thread, so
+   *  that the aggregated bandwidth scales with the number of files on file
+   *  systems capping the per-file bandwidth. The caller only copies the
+   *  encoded record in a queue; a full queue blocks the caller until the
+   *  shard thread catches up.
+   *
+   *  Each record is written with a sequence number. On close(), every shard
+   *  gets its own index sidecar file and a manifest, the merged index of all
+   *  shards sorted by sequence number, is written in the index sidecar file
+   *  of the logical file name (see record_index::sidecar_name()). Readers use
+   *  the manifest to iterate the logical stream in the original order.
+   *
+   *  Example:
+   *  @code{cpp}
+   *  // writes out_0.sio ... out_3.sio and the manifest out.sio.idx
+   *  sio::sharded_writer writer( "out.sio", 4 ) ;
+   *  auto rec_info = sio::api::write_record( "event", rec_buffer, blocks, 0 ) ;
+   *  writer.write_record( rec_buffer.span(), rec_info, event_number ) ;
+   *  writer.close() ;
+   *  @endcode
+   */
+  class sharded_writer {
+  public:
+    using size_type = std::size_t ;
+
+  public:
+    /// No default constructor
+    sharded_writer() = delete ;
+    /// No copy constructor
+    sharded_writer( const sharded_writer& ) = delete ;
+    /// No assignment by copy
+    sharded_writer& operator=( const sharded_writer& ) = delete ;
+
+    /**
+     *  @brief  Constructor. Create the shard files and start the shard threads
+     *
+     *  @param  fname the logical file name
+     *  @param  nshards the number of shards
+     *  @param  policy how to distribute the records over the shards
+     *  @param  max_queued the maximum number of records queued per shard
+     */
+    sharded_writer( const std::string &fname, size_type nshards, shard_policy policy = shard_policy::round_robin, size_type max_queued = 64 ) ;
+
+    /**
+     *  @brief  Destructor. Close the writer if not done
+     */
+    ~sharded_writer() ;
+
+    /**
+     *  @brief  Get the file name of a shard
+     *
+     *  @param  fname the logical file name
+     *  @param  shard the shard number
+     */
+    static std::string shard_name( const std::string &fname, size_type shard ) ;
+
+    /**
+     *  @brief  Queue a record for writing (thread safe). Returns the shard
+     *          number. Exceptions thrown by the shard thread are re-thrown here
+     *
+     *  @param  rec_buf the record buffer (header + data)
+     *  @param  rec_info the record info
+     *  @param  sequence the record sequence number in the logical stream
+     */
+    size_type write_record( const buffer_span &rec_buf, const record_info &rec_info, std::uint64_t sequence ) ;
+
+    /**
+     *  @brief  Queue a record for writing from separate header and data
+     *          buffers, e.g after compression (thread safe). Returns the shard number
+     *
+     *  @param  hdr_span the record header buffer
+     *  @param  data_span the record data buffer
+     *  @param  rec_info the record info
+     *  @param  sequence the record sequence number in the logical stream
+     */
+    size_type write_record( const buffer_span &hdr_span, const buffer_span &data_span, const record_info &rec_info, std::uint64_t sequence ) ;
+
+    /**
+     *  @brief  Wait for the queued records, close the shard files and write
+     *          the shard indices and the manifest. All callers must be done:
+     *          a record written concurrently with close() is rejected with
+     *          error_code::not_open
+     */
+    void close() ;
+
+    /**
+     *  @brief  Get the number of shards
+     */
+    size_type shards() const ;
+
+    /**
+     *  @brief  Get the manifest (merged index). Valid after close()
+     */
+    const record_index &index() const ;
+
+  private:
+    /**
+     *  @brief  A record waiting to be written
+     */
+    struct item {
+      ///< The record bytes (header + data)
+      buffer                 _buffer {sio::kbyte} ;
+      ///< The record header length in the buffer
+      size_type              _header_length {0} ;
+      ///< Whether the padding is computed on the data only (split header/data)
+      bool                   _split {false} ;
+      ///< The record info
+      record_info            _info {} ;
+      ///< The record sequence number
+      std::uint64_t          _sequence {0} ;
+    };
+
+    /**
+     *  @brief  An output file and its writing thread
+     */
+    struct shard {
+      ///< The shard file name
+      std::string                    _fname {} ;
+      ///< The shard output stream
+      sio::ofstream                  _stream {} ;
+      ///< The shard index
+      record_index                   _index {} ;
+      ///< The records waiting to be written
+      std::deque<item>               _queue {} ;
+      ///< The pool of free items
+      std::vector<item>              _pool {} ;
+      ///< An exception thrown by the shard thread
+      std::exception_ptr             _error {} ;
+      ///< Whether the shard thread should stop once the queue is empty
+      bool                           _stop {false} ;
+      ///< The mutex protecting the queue
+      std::mutex                     _mutex {} ;
+      ///< Condition variable to wake up the shard thread
+      std::condition_variable        _writer_cond {} ;
+      ///< Condition variable to wake up the callers waiting for room
+      std::condition_variable        _caller_cond {} ;
+      ///< The shard thread
+      std::thread                    _thread {} ;
+    };
+
+  private:
+    /**
+     *  @brief  Choose the shard of the next record
+     *
+     *  @param  sequence the record sequence number
+     */
+    size_type select_shard( std::uint64_t sequence ) ;
+
+    /**
+     *  @brief  Copy the record pieces in a shard queue
+     */
+    size_type enqueue( const buffer_span &hdr_span, const buffer_span &data_span, bool split, const record_info &rec_info, std::uint64_t sequence ) ;
+
+    /**
+     *  @brief  The shard thread main loop
+     *
+     *  @param  sh the shard to write
+     */
+    void run( shard &sh ) ;
+
+    /**
+     *  @brief  Stop the shard threads and close the files
+     */
+    void stop() ;
+
+  private:
+    ///< The logical file name
+    const std::string                      _fname ;
+    ///< The shard distribution policy
+    const shard_policy                     _policy ;
+    ///< The maximum number of queued records per shard
+    const size_type                        _max_queued ;
+    ///< The shards
+    std::vector<std::unique_ptr<shard>>    _shards {} ;
+    ///< The round robin counter
+    std::atomic<std::uint64_t>             _counter {0} ;
+    ///< The merged index
+    record_index                           _index {} ;
+    ///< Whether the writer has been closed
+    std::atomic<bool>                      _closed {false} ;
+  };
+
+}
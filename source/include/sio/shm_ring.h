@@ -0,0 +1,253 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+
+// -- std headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sio {
+
+  /**
+   *  @brief  shm_ring class.
+   *
+   *  Single producer / single consumer ring buffer in shared memory, used to
+   *  pass complete records (header + data, possibly compressed) between two
+   *  processes of the same node without going through a file. The ring is a
+   *  memory mapped file (typically in /dev/shm) made of a control page and a
+   *  data area. The data area is mapped twice in a row, so that any record
+   *  stored in the ring is contiguous in memory, even if it wraps around the
+   *  end of the data area. The producer and consumer positions are lock-free
+   *  atomic counters. A waiting side sleeps on a futex (Linux) and is only
+   *  woken up if it announced itself, so that the other side doesn't pay a
+   *  system call per record when nobody waits.
+   *
+   *  This class holds the shared mapping. Use the shm_ring_writer and
+   *  shm_ring_reader classes to produce and consume records.
+   */
+  class shm_ring {
+  public:
+    using pos_type = sio::ifstream::pos_type ;
+    using size_type = std::size_t ;
+
+  public:
+    /// No default constructor
+    shm_ring() = delete ;
+    /// No copy constructor
+    shm_ring( const shm_ring& ) = delete ;
+    /// No assignment by copy
+    shm_ring& operator=( const shm_ring& ) = delete ;
+
+    /**
+     *  @brief  Get the ring file name
+     */
+    const std::string &name() const ;
+
+    /**
+     *  @brief  Get the capacity of the ring data area
+     */
+    size_type capacity() const ;
+
+  protected:
+    /**
+     *  @brief  Constructor. Create or open the ring file and map it
+     *
+     *  @param  fname the ring file name
+     *  @param  capacity the capacity of the data area (rounded up to the page size)
+     *  @param  create whether to create the ring or to open an existing one
+     */
+    shm_ring( const std::string &fname, size_type capacity, bool create ) ;
+
+    /**
+     *  @brief  Destructor. Unmap the ring
+     */
+    ~shm_ring() ;
+
+    /// Get the current producer position
+    std::uint64_t head() const ;
+    /// Get the current consumer position
+    std::uint64_t tail() const ;
+    /// Whether the producer has closed the ring
+    bool closed() const ;
+    /// Get a pointer in the data area for a ring position
+    sio::byte *address( std::uint64_t pos ) const ;
+    /// Producer: make the bytes up to pos visible to the consumer
+    void publish( std::uint64_t pos ) ;
+    /// Producer: close the ring (end of stream)
+    void close() ;
+    /// Producer: wait until the bytes up to pos can be written
+    void wait_space( std::uint64_t pos ) ;
+    /// Consumer: give back the bytes up to pos to the producer
+    void release( std::uint64_t pos ) ;
+    /// Consumer: wait until the bytes up to pos are published. False if the ring is closed before
+    bool wait_data( std::uint64_t pos ) ;
+
+  private:
+    struct control ;
+    ///< The ring file name
+    const std::string       _fname ;
+    ///< The file descriptor
+    int                     _fd {-1} ;
+    ///< The shared control block
+    control                *_control {nullptr} ;
+    ///< The data area (mapped twice in a row)
+    sio::byte              *_data {nullptr} ;
+    ///< The capacity of the data area
+    size_type               _capacity {0} ;
+    ///< The size of the control block mapping
+    size_type               _control_size {0} ;
+  };
+
+  /**
+   *  @brief  shm_ring_writer class.
+   *
+   *  Producer side of a shared memory ring. Creates the ring file, which is
+   *  removed when the writer is destroyed. The writer is a record sink (see
+   *  sio/sink.h), so records are written with api::write_record(). A record
+   *  becomes visible to the consumer when the sink is flushed, which
+   *  api::write_record() does after each record. If the ring is full, the
+   *  writer waits for the consumer to release records (backpressure).
+   *
+   *  Example:
+   *  @code{cpp}
+   *  sio::shm_ring_writer ring( "/dev/shm/my-ring" ) ;
+   *  // ... for each record
+   *  sio::api::write_record( ring, rec_buffer.span(), rec_info ) ;
+   *  // end of stream
+   *  ring.close() ;
+   *  @endcode
+   */
+  class shm_ring_writer : public shm_ring {
+  public:
+    /// No default constructor
+    shm_ring_writer() = delete ;
+    /// No copy constructor
+    shm_ring_writer( const shm_ring_writer& ) = delete ;
+    /// No assignment by copy
+    shm_ring_writer& operator=( const shm_ring_writer& ) = delete ;
+
+    /**
+     *  @brief  Constructor. Create the ring
+     *
+     *  @param  fname the ring file name
+     *  @param  capacity the ring capacity, limiting the size of a single record
+     */
+    shm_ring_writer( const std::string &fname, size_type capacity = 64*sio::mbyte ) ;
+
+    /**
+     *  @brief  Destructor. Close the ring and remove the ring file
+     */
+    ~shm_ring_writer() ;
+
+    /**
+     *  @brief  Write bytes in the ring. Wait for free space if needed
+     *
+     *  @param  src the bytes to write
+     *  @param  length the number of bytes to write
+     */
+    void write( const sio::byte *src, size_type length ) ;
+
+    /**
+     *  @brief  Get the current position in the ring stream
+     */
+    pos_type position() const ;
+
+    /**
+     *  @brief  Make the bytes written so far visible to the consumer
+     */
+    void flush() ;
+
+    /**
+     *  @brief  Flush and close the ring. The consumer gets an end of
+     *          stream once all records are read out
+     */
+    void close() ;
+
+  private:
+    ///< The write position (not yet published)
+    std::uint64_t          _write_pos {0} ;
+    ///< The last published position
+    std::uint64_t          _published {0} ;
+  };
+
+  /**
+   *  @brief  shm_ring_reader class.
+   *
+   *  Consumer side of a shared memory ring. The records are not copied out
+   *  of the ring: the buffer spans returned by the reader point into the
+   *  shared memory and can be passed directly to api::read_blocks() (or to
+   *  a decompression function). A record is released to the producer when
+   *  the next record header is read out, so the spans and the record name
+   *  are valid until then.
+   *
+   *  Example:
+   *  @code{cpp}
+   *  sio::shm_ring_reader ring( "/dev/shm/my-ring" ) ;
+   *  sio::record_info_view rec_info ;
+   *  while( ring.next_record_info( rec_info ) ) {
+   *    sio::api::read_blocks( ring.read_record_data(), blocks ) ;
+   *  }
+   *  @endcode
+   */
+  class shm_ring_reader : public shm_ring {
+  public:
+    /// No default constructor
+    shm_ring_reader() = delete ;
+    /// No copy constructor
+    shm_ring_reader( const shm_ring_reader& ) = delete ;
+    /// No assignment by copy
+    shm_ring_reader& operator=( const shm_ring_reader& ) = delete ;
+    /// Default destructor
+    ~shm_ring_reader() = default ;
+
+    /**
+     *  @brief  Constructor. Open an existing ring
+     *
+     *  @param  fname the ring file name
+     */
+    shm_ring_reader( const std::string &fname ) ;
+
+    /**
+     *  @brief  Release the previous record and read the next record header.
+     *          Wait for the producer if needed. Throws an exception with
+     *          error_code::eof if the ring is closed and empty
+     *
+     *  @param  rec_info the record info view to receive
+     */
+    void read_record_info( record_info_view &rec_info ) ;
+
+    /**
+     *  @brief  Read the next record header. Returns false on end of stream
+     *          instead of throwing an exception
+     *
+     *  @param  rec_info the record info view to receive
+     */
+    bool next_record_info( record_info_view &rec_info ) ;
+
+    /**
+     *  @brief  Get the data of the last record header read out.
+     *          The returned span points into the ring
+     */
+    buffer_span read_record_data() ;
+
+    /**
+     *  @brief  Get the full record (header + data) of the last record header
+     *          read out. The returned span points into the ring
+     */
+    buffer_span read_record() ;
+
+  private:
+    ///< The position of the current record
+    std::uint64_t          _read_pos {0} ;
+    ///< The position of the next record
+    std::uint64_t          _next_pos {0} ;
+    ///< The last record header read out
+    record_info_view       _current {} ;
+    ///< Whether a record header has been read out
+    bool                   _has_current {false} ;
+  };
+
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+
+// -- std headers
+#include <cstddef>
+
+namespace sio {
+
+  /**
+   *  @brief  Record sinks.
+   *
+   *  A record sink is any class providing the following interface:
+   *  @code{cpp}
+   *  // write length bytes. Throws on failure
+   *  void write( const sio::byte *src, size_type length ) ;
+   *  // the current position in the sink
+   *  pos_type position() const ;
+   *  // make the bytes written so far visible to the readers
+   *  void flush() ;
+   *  @endcode
+   *  The api::write_record functions are templated on the sink type, so that
+   *  no virtual call is involved in writing records. The classes below
+   *  provide the sinks for memory buffers and output file streams.
+   */
+
+  /**
+   *  @brief  memory_sink class.
+   *
+   *  Write records in a memory buffer, e.g to pass them to a next processing
+   *  stage with a memory_source, without going through the file system.
+   *  The records are written from the start of the buffer, which is expanded
+   *  as needed. The buffer must outlive the sink.
+   */
+  class memory_sink {
+  public:
+    using pos_type = sio::ofstream::pos_type ;
+    using size_type = std::size_t ;
+
+  public:
+    /// No default constructor
+    memory_sink() = delete ;
+    /// No copy constructor
+    memory_sink( const memory_sink& ) = delete ;
+    /// No assignment by copy
+    memory_sink& operator=( const memory_sink& ) = delete ;
+    /// Default destructor
+    ~memory_sink() = default ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  buf the buffer to write to
+     */
+    memory_sink( buffer &buf ) ;
+
+    /**
+     *  @brief  Write bytes in the buffer
+     *
+     *  @param  src the bytes to write
+     *  @param  length the number of bytes to write
+     */
+    void write( const sio::byte *src, size_type length ) ;
+
+    /**
+     *  @brief  Get the current position in the buffer
+     */
+    pos_type position() const ;
+
+    /**
+     *  @brief  Nothing to do for a memory sink
+     */
+    void flush() ;
+
+    /**
+     *  @brief  Get the span of the bytes written so far
+     */
+    buffer_span span() const ;
+
+    /**
+     *  @brief  Restart writing from the start of the buffer
+     */
+    void clear() ;
+
+  private:
+    ///< The buffer to write to
+    buffer                  &_buffer ;
+    ///< The current position in the buffer
+    size_type                _position {0} ;
+  };
+
+  /**
+   *  @brief  file_sink class.
+   *
+   *  Write records in an output file stream. The stream must outlive the sink.
+   */
+  class file_sink {
+  public:
+    using pos_type = sio::ofstream::pos_type ;
+    using size_type = std::size_t ;
+
+  public:
+    /// No default constructor
+    file_sink() = delete ;
+    /// No copy constructor
+    file_sink( const file_sink& ) = delete ;
+    /// No assignment by copy
+    file_sink& operator=( const file_sink& ) = delete ;
+    /// Default destructor
+    ~file_sink() = default ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  stream the output stream to write to
+     */
+    file_sink( sio::ofstream &stream ) ;
+
+    /**
+     *  @brief  Write bytes in the stream
+     *
+     *  @param  src the bytes to write
+     *  @param  length the number of bytes to write
+     */
+    void write( const sio::byte *src, size_type length ) ;
+
+    /**
+     *  @brief  Get the current position in the stream
+     */
+    pos_type position() const ;
+
+    /**
+     *  @brief  Flush the stream
+     */
+    void flush() ;
+
+  private:
+    ///< The output stream
+    sio::ofstream           &_stream ;
+  };
+
+}
@@ -0,0 +1,330 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+
+// -- std headers
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sio {
+
+  /**
+   *  @brief  sockets class.
+   *
+   *  Helper functions to create connected stream sockets (Unix-domain or
+   *  TCP) for the socket_sink and socket_source classes. The functions
+   *  return a file descriptor and throw on failure.
+   */
+  class sockets {
+  public:
+    // static API only
+    sockets() = delete ;
+
+    /**
+     *  @brief  Create a Unix-domain socket listening on the given path.
+     *          An existing socket file at this path is removed
+     *
+     *  @param  path the socket file path
+     *  @param  backlog the maximum number of pending connections
+     */
+    static int listen_unix( const std::string &path, int backlog = 16 ) ;
+
+    /**
+     *  @brief  Connect to a Unix-domain socket
+     *
+     *  @param  path the socket file path
+     */
+    static int connect_unix( const std::string &path ) ;
+
+    /**
+     *  @brief  Create a TCP socket listening on the given port
+     *
+     *  @param  port the port number (0: let the system choose, see local_port())
+     *  @param  loopback_only whether to accept local connections only
+     *  @param  backlog the maximum number of pending connections
+     */
+    static int listen_tcp( unsigned short port, bool loopback_only = true, int backlog = 16 ) ;
+
+    /**
+     *  @brief  Connect to a TCP socket
+     *
+     *  @param  host the host IPv4 address (e.g 127.0.0.1)
+     *  @param  port the port number
+     */
+    static int connect_tcp( const std::string &host, unsigned short port ) ;
+
+    /**
+     *  @brief  Get the local port a TCP socket is bound to
+     *
+     *  @param  fd the socket file descriptor
+     */
+    static unsigned short local_port( int fd ) ;
+
+    /**
+     *  @brief  Accept a connection on a listening socket
+     *
+     *  @param  fd the listening socket file descriptor
+     */
+    static int accept( int fd ) ;
+
+    /**
+     *  @brief  Close a socket
+     *
+     *  @param  fd the socket file descriptor
+     */
+    static void close( int fd ) ;
+  };
+
+  /**
+   *  @brief  socket_sink class.
+   *
+   *  Record sink (see sio/sink.h) streaming records over a connected socket.
+   *  The records written with api::write_record() are not sent one by one:
+   *  a record is complete when the sink is flushed and the complete records
+   *  are sent in batches, with a single sendmsg() call per batch. The small
+   *  writes (record headers, small records) are copied in a batch buffer,
+   *  the large ones are sent from the caller memory without copy, in which
+   *  case the batch is sent before api::write_record() returns.
+   *
+   *  A batch is also sent when its first record is older than max_delay at
+   *  the time a record is flushed, which bounds the latency of a steady
+   *  stream of records. With a zero max_delay, each record is sent on flush.
+   *  The sink has no timer thread though: the records of a partial batch
+   *  stay in the sink until the next flush. Callers must call sync() to
+   *  send them when the producer goes idle.
+   */
+  class socket_sink {
+  public:
+    using pos_type = sio::ofstream::pos_type ;
+    using size_type = std::size_t ;
+
+  public:
+    /// No default constructor
+    socket_sink() = delete ;
+    /// No copy constructor
+    socket_sink( const socket_sink& ) = delete ;
+    /// No assignment by copy
+    socket_sink& operator=( const socket_sink& ) = delete ;
+
+    /**
+     *  @brief  Constructor. The sink owns the socket
+     *
+     *  @param  fd a connected socket file descriptor
+     *  @param  max_records the maximum number of records per batch
+     *  @param  max_bytes the maximum number of bytes per batch
+     *  @param  copy_threshold the maximum size of a write copied in the batch buffer
+     *  @param  max_delay the maximum age of the first record of a batch, checked on flush
+     */
+    socket_sink( int fd, size_type max_records = 32, size_type max_bytes = 256*sio::kbyte, size_type copy_threshold = 16*sio::kbyte, std::chrono::microseconds max_delay = std::chrono::milliseconds(10) ) ;
+
+    /**
+     *  @brief  Destructor. Send the pending records and close the socket
+     */
+    ~socket_sink() ;
+
+    /**
+     *  @brief  Add bytes to the current batch
+     *
+     *  @param  src the bytes to write
+     *  @param  length the number of bytes to write
+     */
+    void write( const sio::byte *src, size_type length ) ;
+
+    /**
+     *  @brief  Get the current position in the socket stream
+     */
+    pos_type position() const ;
+
+    /**
+     *  @brief  Mark the end of a record. Send the batch if it is full or if
+     *          its first record is older than the maximum delay
+     */
+    void flush() ;
+
+    /**
+     *  @brief  Send the pending records now. To call when no more records
+     *          are written for a while, to push a partial batch
+     */
+    void sync() ;
+
+    /**
+     *  @brief  Send the pending records and shutdown the sending side.
+     *          The peer gets an end of stream once all records are read out
+     */
+    void close() ;
+
+    /**
+     *  @brief  Get the number of sendmsg() calls
+     */
+    size_type send_calls() const ;
+
+  private:
+    /**
+     *  @brief  A piece of the current batch
+     */
+    struct chunk {
+      ///< The caller memory (not copied), or null if in the batch buffer
+      const sio::byte    *_ptr {nullptr} ;
+      ///< The offset in the batch buffer (if copied)
+      size_type           _offset {0} ;
+      ///< The chunk length
+      size_type           _length {0} ;
+    };
+
+  private:
+    ///< The socket file descriptor
+    int                      _fd {-1} ;
+    ///< The maximum number of records per batch
+    const size_type          _max_records ;
+    ///< The maximum number of bytes per batch
+    const size_type          _max_bytes ;
+    ///< The maximum size of a copied write
+    const size_type          _copy_threshold ;
+    ///< The maximum age of the first record of a batch
+    const std::chrono::microseconds _max_delay ;
+    ///< The batch buffer for the copied writes
+    sio::buffer              _batch ;
+    ///< The number of bytes used in the batch buffer
+    size_type                _batch_len {0} ;
+    ///< The pieces of the current batch
+    std::vector<chunk>       _chunks {} ;
+    ///< The number of complete records in the batch
+    size_type                _batch_records {0} ;
+    ///< The number of bytes in the batch
+    size_type                _batch_bytes {0} ;
+    ///< The time the first record of the batch was flushed
+    std::chrono::steady_clock::time_point _batch_start {} ;
+    ///< Whether the batch refers to caller memory
+    bool                     _borrowed {false} ;
+    ///< The number of bytes written in the sink
+    std::uint64_t            _position {0} ;
+    ///< The number of sendmsg calls
+    size_type                _send_calls {0} ;
+    ///< Whether the sink has been closed
+    bool                     _closed {false} ;
+  };
+
+  /**
+   *  @brief  socket_source class.
+   *
+   *  Record source (see sio/source.h) reading records from a connected
+   *  socket, e.g with api::read_record(). Small reads are served from a
+   *  receive buffer, so that a batch of small records costs a single recv()
+   *  call. Large reads, typically the record data, are received directly in
+   *  the destination buffer. The source can only move forward: seeking
+   *  forward discards bytes.
+   *
+   *  receive_record() reads the next record in a buffer sized from the
+   *  record lengths. The source keeps a pool of buffers that the consumers
+   *  can give back once a record is processed, possibly from another thread.
+   */
+  class socket_source {
+  public:
+    using pos_type = sio::ifstream::pos_type ;
+    using size_type = std::size_t ;
+
+  public:
+    /// No default constructor
+    socket_source() = delete ;
+    /// No copy constructor
+    socket_source( const socket_source& ) = delete ;
+    /// No assignment by copy
+    socket_source& operator=( const socket_source& ) = delete ;
+
+    /**
+     *  @brief  Constructor. The source owns the socket
+     *
+     *  @param  fd a connected socket file descriptor
+     *  @param  recv_size the size of the receive buffer
+     */
+    socket_source( int fd, size_type recv_size = 64*sio::kbyte ) ;
+
+    /**
+     *  @brief  Destructor. Close the socket
+     */
+    ~socket_source() ;
+
+    /**
+     *  @brief  Read bytes from the socket. Wait until all bytes are
+     *          received or the peer closed the connection
+     *
+     *  @param  dest where to write the bytes
+     *  @param  length the number of bytes to read
+     */
+    size_type read( sio::byte *dest, size_type length ) ;
+
+    /**
+     *  @brief  Get the current position in the socket stream
+     */
+    pos_type position() const ;
+
+    /**
+     *  @brief  Move forward in the socket stream, discarding the bytes
+     *
+     *  @param  pos the new position
+     */
+    void seek( pos_type pos ) ;
+
+    /**
+     *  @brief  Receive the next record (header + data). The output buffer
+     *          is replaced by a buffer from the pool if it is not valid.
+     *          Returns false on end of stream
+     *
+     *  @param  rec_info the record info to receive
+     *  @param  outbuf the buffer to receive the record header + data
+     */
+    bool receive_record( record_info &rec_info, buffer &outbuf ) ;
+
+    /**
+     *  @brief  Take a buffer from the pool (thread safe)
+     */
+    buffer take_buffer() ;
+
+    /**
+     *  @brief  Give back a buffer to the pool (thread safe)
+     *
+     *  @param  buf the buffer to give back
+     */
+    void give_buffer( buffer &&buf ) ;
+
+    /**
+     *  @brief  Get the number of recv() calls
+     */
+    size_type recv_calls() const ;
+
+  private:
+    /**
+     *  @brief  Receive at least one byte and at most length bytes.
+     *          Returns 0 on end of stream
+     *
+     *  @param  dest where to write the bytes
+     *  @param  length the maximum number of bytes
+     */
+    size_type receive( sio::byte *dest, size_type length ) ;
+
+  private:
+    ///< The socket file descriptor
+    int                      _fd {-1} ;
+    ///< The receive buffer
+    sio::buffer              _recv ;
+    ///< The read position in the receive buffer
+    size_type                _recv_pos {0} ;
+    ///< The number of valid bytes in the receive buffer
+    size_type                _recv_len {0} ;
+    ///< The position in the socket stream
+    std::uint64_t            _position {0} ;
+    ///< The number of recv calls
+    size_type                _recv_calls {0} ;
+    ///< The buffer pool
+    std::vector<buffer>      _pool {} ;
+    ///< The buffer pool mutex
+    std::mutex               _pool_mutex {} ;
+  };
+
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+
+// -- std headers
+#include <cstddef>
+
+namespace sio {
+
+  /**
+   *  @brief  Record sources.
+   *
+   *  A record source is any class providing the following interface:
+   *  @code{cpp}
+   *  // read up to length bytes. Returns the number of bytes read out,
+   *  // smaller than length only if the end of the source is reached
+   *  size_type read( sio::byte *dest, size_type length ) ;
+   *  // the current position in the source
+   *  pos_type position() const ;
+   *  // move to a position in the source
+   *  void seek( pos_type pos ) ;
+   *  @endcode
+   *  The record functions of the sio::api class (read_record_info,
+   *  read_record_data, read_records, skip_records) are templated on the source
+   *  type, so that no virtual call is involved in reading out records. The
+   *  classes below provide the sources for memory buffers and input file
+   *  streams. Sources that can only move forward (pipes, sockets) implement
+   *  seek() by discarding bytes and throw if asked to move backward.
+   */
+
+  /**
+   *  @brief  memory_source class.
+   *
+   *  Read out records from a memory buffer, e.g a buffer filled by a
+   *  memory_sink in a previous processing stage. The buffer is not copied
+   *  and must outlive the source.
+   */
+  class memory_source {
+  public:
+    using pos_type = sio::ifstream::pos_type ;
+    using size_type = std::size_t ;
+
+  public:
+    /// No default constructor
+    memory_source() = delete ;
+    /// Default copy constructor
+    memory_source( const memory_source& ) = default ;
+    /// Default assignment by copy
+    memory_source& operator=( const memory_source& ) = default ;
+    /// Default destructor
+    ~memory_source() = default ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  buf the buffer span to read from
+     */
+    memory_source( const buffer_span &buf ) ;
+
+    /**
+     *  @brief  Read bytes from the buffer
+     *
+     *  @param  dest where to write the bytes
+     *  @param  length the number of bytes to read
+     */
+    size_type read( sio::byte *dest, size_type length ) ;
+
+    /**
+     *  @brief  Get the current position in the buffer
+     */
+    pos_type position() const ;
+
+    /**
+     *  @brief  Set the current position in the buffer
+     *
+     *  @param  pos the new position
+     */
+    void seek( pos_type pos ) ;
+
+    /**
+     *  @brief  Get the buffer span of the source
+     */
+    const buffer_span &span() const ;
+
+  private:
+    ///< The buffer to read from
+    buffer_span              _buffer ;
+    ///< The current position in the buffer
+    size_type                _position {0} ;
+  };
+
+  /**
+   *  @brief  file_source class.
+   *
+   *  Read out records from an input file stream. The stream must outlive
+   *  the source.
+   */
+  class file_source {
+  public:
+    using pos_type = sio::ifstream::pos_type ;
+    using size_type = std::size_t ;
+
+  public:
+    /// No default constructor
+    file_source() = delete ;
+    /// No copy constructor
+    file_source( const file_source& ) = delete ;
+    /// No assignment by copy
+    file_source& operator=( const file_source& ) = delete ;
+    /// Default destructor
+    ~file_source() = default ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  stream the input stream to read from
+     */
+    file_source( sio::ifstream &stream ) ;
+
+    /**
+     *  @brief  Read bytes from the stream
+     *
+     *  @param  dest where to write the bytes
+     *  @param  length the number of bytes to read
+     */
+    size_type read( sio::byte *dest, size_type length ) ;
+
+    /**
+     *  @brief  Get the current position in the stream
+     */
+    pos_type position() const ;
+
+    /**
+     *  @brief  Set the current position in the stream
+     *
+     *  @param  pos the new position
+     */
+    void seek( pos_type pos ) ;
+
+  private:
+    ///< The input stream
+    sio::ifstream           &_stream ;
+  };
+
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+// -- std headers
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace sio {
+
+  /**
+   *  @brief  trace class.
+   *
+   *  Timeline tracing of the library stages (I/O, (de)compression, block
+   *  encoding/decoding, pointer relocation and queue stalls), exported in
+   *  the Chrome trace JSON format (chrome://tracing, https://ui.perfetto.dev).
+   *
+   *  The tracing points are compiled in with the CMake option SIO_TRACING
+   *  (ON by default) and record nothing until tracing is started: a disabled
+   *  tracing point costs a relaxed atomic load. Once started, each traced
+   *  scope adds a complete event (begin time and duration) with the thread
+   *  id and, when known, the record name, in a buffer owned by the calling
+   *  thread.
+   *
+   *  Tracing can be started from the environment: setting SIO_TRACE to a
+   *  file name starts the tracing when the library is loaded and writes the
+   *  trace to this file at exit.
+   *  @code{cpp}
+   *  sio::trace::start() ;
+   *  // ... read or write records
+   *  sio::trace::stop() ;
+   *  sio::trace::write_json( "sio_trace.json" ) ;
+   *  @endcode
+   */
+  class trace {
+  public:
+    /// The maximum number of events kept per thread
+    static constexpr std::size_t max_thread_events = 1 << 20 ;
+
+    /**
+     *  @brief  scope class.
+     *
+     *  Trace its own lifetime as a complete event
+     */
+    class scope {
+    public:
+      /// No default constructor
+      scope() = delete ;
+      /// No copy constructor
+      scope( const scope& ) = delete ;
+      /// No assignment by copy
+      scope& operator=( const scope& ) = delete ;
+
+      /**
+       *  @brief  Constructor. Start the event if tracing is enabled
+       *
+       *  @param  category the event category (static string)
+       *  @param  name the event name (static string)
+       *  @param  record the record name, if any. Read when the scope
+       *          ends, so it can be filled within the scope
+       */
+      scope( const char *category, const char *name, const std::string *record = nullptr ) :
+        _category( category ),
+        _name( name ),
+        _record( record ) {
+        if( trace::enabled() ) {
+          _start = trace::now() ;
+        }
+      }
+
+      /// Destructor. Add the event
+      ~scope() {
+        if( _start >= 0 ) {
+          trace::add_event( _category, _name, _record, _start, trace::now() ) ;
+        }
+      }
+
+    private:
+      ///< The event category
+      const char                 *_category ;
+      ///< The event name
+      const char                 *_name ;
+      ///< The record name, if any
+      const std::string          *_record ;
+      ///< The start time (nanoseconds), negative if not traced
+      std::int64_t                _start {-1} ;
+    };
+
+  public:
+    // static API only
+    trace() = delete ;
+
+    /**
+     *  @brief  Whether the tracing points are compiled in the library
+     */
+    static bool compiled() ;
+
+    /**
+     *  @brief  Whether the tracing is running
+     */
+    static bool enabled() {
+      return _enabled.load( std::memory_order_relaxed ) ;
+    }
+
+    /**
+     *  @brief  Start the tracing
+     */
+    static void start() ;
+
+    /**
+     *  @brief  Stop the tracing. The events are kept
+     */
+    static void stop() ;
+
+    /**
+     *  @brief  Clear the recorded events
+     */
+    static void clear() ;
+
+    /**
+     *  @brief  Name the calling thread in the trace
+     *
+     *  @param  name the thread name
+     */
+    static void set_thread_name( const std::string &name ) ;
+
+    /**
+     *  @brief  Get the number of recorded events
+     */
+    static std::size_t size() ;
+
+    /**
+     *  @brief  Get the number of events dropped because
+     *          a thread buffer was full
+     */
+    static std::size_t dropped() ;
+
+    /**
+     *  @brief  Write the recorded events in the Chrome trace JSON format
+     *
+     *  @param  out the output stream
+     */
+    static void write_json( std::ostream &out ) ;
+
+    /**
+     *  @brief  Write the recorded events in the Chrome trace JSON format
+     *
+     *  @param  fname the output file name
+     */
+    static void write_json( const std::string &fname ) ;
+
+    /**
+     *  @brief  Get the current time of the trace clock (nanoseconds)
+     */
+    static std::int64_t now() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count() ;
+    }
+
+    /**
+     *  @brief  Add a complete event for the calling thread
+     *
+     *  @param  category the event category (static string)
+     *  @param  name the event name (static string)
+     *  @param  record the record name or nullptr
+     *  @param  start the event start time (see now())
+     *  @param  end the event end time (see now())
+     */
+    static void add_event( const char *category, const char *name, const std::string *record, std::int64_t start, std::int64_t end ) ;
+
+  private:
+    ///< Whether the tracing is running
+    static std::atomic<bool>      _enabled ;
+  };
+
+}
+
+#ifdef SIO_TRACING
+// Unique scope variable names, for nested traced scopes
+#define SIO_TRACE_CONCAT_IMPL( a, b ) a##b
+#define SIO_TRACE_CONCAT( a, b ) SIO_TRACE_CONCAT_IMPL( a, b )
+#define SIO_TRACE_VARIABLE SIO_TRACE_CONCAT( sio_trace_scope_, __LINE__ )
+// Trace the enclosing scope, e.g SIO_TRACE_SCOPE( "io", "read_record_data" )
+#define SIO_TRACE_SCOPE( category, name ) const sio::trace::scope SIO_TRACE_VARIABLE ( category, name )
+// Trace the enclosing scope with the record name (std::string)
+#define SIO_TRACE_RECORD_SCOPE( category, name, record ) const sio::trace::scope SIO_TRACE_VARIABLE ( category, name, &(record) )
+// Name the calling thread in the trace
+#define SIO_TRACE_THREAD_NAME( name ) sio::trace::set_thread_name( name )
+#else
+#define SIO_TRACE_SCOPE( category, name )
+#define SIO_TRACE_RECORD_SCOPE( category, name, record )
+#define SIO_TRACE_THREAD_NAME( name )
+#endif
@@ -0,0 +1,136 @@
+#pragma once
+
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/buffer.h>
+
+// -- std headers
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sio {
+
+  /**
+   *  @brief  uring_reader class.
+   *
+   *  Batched record reader for random access. The record reads of a batch
+   *  are all submitted at once through io_uring on Linux, so that many reads
+   *  are in flight at the same time instead of waiting on each read in turn.
+   *  The record positions come either from a file index (positions only, the
+   *  headers are then read in a first batch) or from record headers already
+   *  parsed (one batch).
+   *
+   *  io_uring support is optional (cmake option SIO_IO_URING). If it is not
+   *  compiled in or not supported by the running kernel, the reader falls
+   *  back to reading the records one by one with an ifstream.
+   */
+  class uring_reader {
+  public:
+    using pos_type = sio::ifstream::pos_type ;
+    using size_type = std::size_t ;
+
+  public:
+    /// No default constructor
+    uring_reader() = delete ;
+    /// No copy constructor
+    uring_reader( const uring_reader& ) = delete ;
+    /// No assignment by copy
+    uring_reader& operator=( const uring_reader& ) = delete ;
+
+    /**
+     *  @brief  Constructor. Open the file and setup the submission queue
+     *
+     *  @param  fname the file name
+     *  @param  queue_depth the maximum number of reads in flight
+     */
+    uring_reader( const std::string &fname, unsigned int queue_depth = 64 ) ;
+
+    /**
+     *  @brief  Destructor. Close the file and release the queue
+     */
+    ~uring_reader() ;
+
+    /**
+     *  @brief  Whether io_uring is compiled in and supported by the kernel
+     */
+    static bool available() ;
+
+    /**
+     *  @brief  Whether this reader uses io_uring (else the ifstream fallback)
+     */
+    bool uses_io_uring() const ;
+
+    /**
+     *  @brief  Read the full records (header + data) described by the record infos.
+     *          Only the fields _file_start, _header_length and _data_length are used.
+     *          The output buffer vector is resized to the number of records and
+     *          existing buffers are re-used.
+     *
+     *  @param  infos the record infos
+     *  @param  outbufs the buffers to receive the records (header + data)
+     */
+    void read_records( const std::vector<record_info> &infos, std::vector<buffer> &outbufs ) ;
+
+    /**
+     *  @brief  Read the full records (header + data) starting at the given positions.
+     *          The record headers are read out in a first batch, the record data
+     *          in a second batch.
+     *
+     *  @param  positions the positions of the record headers in the file
+     *  @param  infos the record infos to receive
+     *  @param  outbufs the buffers to receive the records (header + data)
+     */
+    void read_records( const std::vector<pos_type> &positions, std::vector<record_info> &infos, std::vector<buffer> &outbufs ) ;
+
+  private:
+    /**
+     *  @brief  A single read request of a batch
+     */
+    struct read_request {
+      ///< Where to write the bytes
+      sio::byte          *_dest {nullptr} ;
+      ///< The file offset to read from
+      size_type           _offset {0} ;
+      ///< The number of bytes to read
+      size_type           _length {0} ;
+      ///< The number of bytes already read
+      size_type           _done {0} ;
+      ///< The minimum number of bytes to read (smaller means end of file is accepted)
+      size_type           _min_length {0} ;
+    };
+
+    /**
+     *  @brief  Perform a batch of read requests
+     *
+     *  @param  requests the read requests
+     */
+    void read_batch( std::vector<read_request> &requests ) ;
+
+    /**
+     *  @brief  Perform a batch of read requests with the ifstream fallback
+     *
+     *  @param  requests the read requests
+     */
+    void read_batch_stream( std::vector<read_request> &requests ) ;
+
+    /**
+     *  @brief  Prepare the output buffers
+     *
+     *  @param  outbufs the output buffers
+     *  @param  count the number of buffers required
+     */
+    static void prepare_buffers( std::vector<buffer> &outbufs, size_type count ) ;
+
+  private:
+    struct ring ;
+    ///< The file name
+    const std::string             _fname ;
+    ///< The io_uring queue (null if not used)
+    std::unique_ptr<ring>         _ring ;
+    ///< The fallback input stream
+    sio::ifstream                 _stream {} ;
+  };
+
+}
@@ -1,6 +1,7 @@
 // -- sio headers
 #include <sio/definitions.h>
 #include <sio/api.h>
+#include <sio/dump.h>
 #include <sio/exception.h>
 // -- std headers
 #include <limits>
@@ -14,7 +15,7 @@
 
 
 
-constexpr const char *USAGE = R"(Usage: sio-dump [-d/--detailed] [-n NRECORDS] [-m SKIPRECORDS] siofile)";
+constexpr const char *USAGE = R"(Usage: sio-dump [-d/--detailed] [-s/--stats] [-j NTHREADS] [-n NRECORDS] [-m SKIPRECORDS] siofile)";
 
 constexpr const char *HELP = R"(Dump SIO record from file to console
 
@@ -24,6 +25,9 @@ Positional arguments:
 Optional arguments:
   -h, --help       Show the help message and exit
   -d, --detailed   Dump detailed (i.e. unpacked) records from the file
+  -s, --stats      Print statistics per record and block name instead of the records
+                   (counts, sizes, compression ratios, size histograms)
+  -j NTHREADS      Decode the records with NTHREADS threads (detailed dump and stats)
   -n NRECORDS      Only dump NRECORDS records from the file
   -m SKIPRECORDS   Skip the first SKIPRECORDS from dumping
 )";
@@ -87,7 +91,9 @@ int main( int argc, char **argv ) {
 
   const int count = option_val(args, "-n", std::numeric_limits<int>::max());
   const int skip = option_val(args, "-m", 0);
+  const int nthreads = option_val(args, "-j", 1);
   const bool detailed = has_option(args, "-d", "--detailed");
+  const bool stats = has_option(args, "-s", "--stats");
 
   if (has_option(args, "-h", "--help")) {
     std::cout << USAGE << "\n\n";
@@ -105,7 +111,11 @@ int main( int argc, char **argv ) {
   sio::ifstream file;
   file.open( fname , std::ios::in | std::ios::binary ) ;
   try {
-    sio::api::dump_records( file, skip, count, detailed) ;
+    if (stats) {
+      sio::dump::stats( file, skip, count, std::max(nthreads, 1) ).print( std::cout ) ;
+    } else {
+      sio::dump::records( file, skip, count, detailed, std::max(nthreads, 1) ) ;
+    }
   } catch( const sio::exception &e ) {
     switch( e.code() ) {
       case sio::error_code::not_open:
@@ -0,0 +1,85 @@
+// -- sio headers
+#include <sio/definitions.h>
+#include <sio/recovery.h>
+#include <sio/exception.h>
+// -- std headers
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iostream>
+
+
+
+constexpr const char *USAGE = R"(Usage: sio-recover [--deep] [-q/--quiet] input output)";
+
+constexpr const char *HELP = R"(Recover the intact records of a damaged SIO file
+
+Positional arguments:
+  input:           The damaged file
+  output:          The file to write the intact records to
+
+Optional arguments:
+  -h, --help       Show the help message and exit
+  --deep           Also check the blocks of compressed records (slower)
+  -q, --quiet      Do not list the skipped byte ranges
+)";
+
+/**
+ * @brief Check if either a short form or a long form of the option is in the
+ * list of arguments.
+ */
+bool has_option(std::vector<std::string>& args, const char* opt_s, const char* opt_l) {
+  const auto it = std::find_if(args.cbegin(), args.cend(),
+                               [opt_s, opt_l] (const std::string& arg) {
+                                 return arg == opt_s || arg == opt_l;
+                               });
+
+   if (it != args.cend()) {
+     args.erase(it);
+     return true;
+   }
+
+   return false;
+}
+
+/**
+ *  @brief  Utility in sio to recover the intact records of a damaged file
+ */
+int main( int argc, char **argv ) {
+  std::vector<std::string> args(argv + 1, argv + argc);
+
+  const bool deep = has_option(args, "--deep", "--deep");
+  const bool quiet = has_option(args, "-q", "--quiet");
+
+  if (has_option(args, "-h", "--help")) {
+    std::cout << USAGE << "\n\n";
+    std::cout << HELP << std::endl;
+    return 0;
+  }
+
+  if (args.size() < 2) {
+    std::cout << USAGE << std::endl;
+    return 1;
+  }
+
+  const auto& input = args[args.size() - 2];
+  const auto& output = args.back();
+
+  try {
+    const auto report = sio::recovery::recover( input, output, deep ) ;
+    if( not quiet ) {
+      for( const auto &range : report._skipped ) {
+        std::cout << "Skipped bytes [" << range.first << ", " << range.second << ") ("
+                  << (range.second - range.first) << " bytes)" << std::endl ;
+      }
+    }
+    std::cout << "Recovered " << report._records << " records (" << report._record_bytes << " bytes) from "
+              << input << " into " << output << ", skipped " << report._skipped.size() << " byte ranges ("
+              << report._skipped_bytes << " bytes)" << std::endl ;
+    return report._skipped.empty() ? 0 : 2 ;
+  } catch( const sio::exception &e ) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+  }
+
+  return 1 ;
+}
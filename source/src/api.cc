@@ -6,8 +6,15 @@
 #include <sio/memcpy.h>
 #include <sio/compression/zlib.h>
 #include <sio/block.h>
+#include <sio/block_iterator.h>
+#include <sio/filters.h>
 #include <sio/version.h>
 #include <sio/definitions.h>
+#include <sio/dump.h>
+#include <sio/perf_counters.h>
+#include <sio/trace.h>
+#include <sio/source.h>
+#include <sio/sink.h>
 // -- std headers
 #include <iostream>
 #include <iomanip>
@@ -19,11 +26,37 @@
 #include <string>
 #include <vector>
 #include <utility>
+#include <cstdint>
+#include <cstring>
+// -- simd headers
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 
 namespace sio {
 
+  namespace {
+
+    /// Leave the stream in a failed state on a read error, as a failed stream read does
+    void fail_stream( sio::ifstream &stream, const sio::exception &e ) {
+      if( e.code() == sio::error_code::eof ) {
+        stream.setstate( sio::ifstream::eofbit | sio::ifstream::failbit ) ;
+      }
+      else {
+        stream.setstate( sio::ifstream::failbit ) ;
+      }
+    }
+
+  }
+
+  //--------------------------------------------------------------------------
+
   void api::read_relocation( pointed_at_map& pointed_at, pointer_to_map& pointer_to ) {
+    SIO_PERF_TIMER( read_relocation ) ;
+    SIO_TRACE_SCOPE( "relocation", "read_relocation" ) ;
     // Pointer relocation on read.
     // Some of these variables are a little terse!  Expanded meanings:
     // ptol:  Iterator pointing to lower bound in the 'pointer to' multimap
@@ -47,6 +80,8 @@ namespace sio {
   //--------------------------------------------------------------------------
 
   void api::write_relocation( buffer::const_pointer rec_start, pointed_at_map& pointed_at, pointer_to_map& pointer_to ) {
+    SIO_PERF_TIMER( write_relocation ) ;
+    SIO_TRACE_SCOPE( "relocation", "write_relocation" ) ;
     // Pointer relocation on write.
     // Some of these variables are a little terse!  Expanded meanings:
     // ptol:  Iterator pointing to lower bound in the 'pointer to' multimap
@@ -74,49 +109,52 @@ namespace sio {
   //--------------------------------------------------------------------------
 
   void api::read_record_info( sio::ifstream &stream, record_info &rec_info, buffer &outbuf ) {
-    if( not stream.is_open() ) {
-      SIO_THROW( sio::error_code::not_open, "ifstream is not open!" ) ;
+    file_source source( stream ) ;
+    try {
+      api::read_record_info( source, rec_info, outbuf ) ;
     }
-    if( not stream.good() ) {
-      SIO_THROW( sio::error_code::bad_state, "ifstream is in a bad state!" ) ;
+    catch( sio::exception &e ) {
+      fail_stream( stream, e ) ;
+      throw ;
     }
-    rec_info._file_start = stream.tellg() ;
-    outbuf.resize( sio::max_record_info_len ) ;
-    SIO_DEBUG( "Reading first record bytes of input stream at position: " << stream.tellg() ) ;
-    stream.read( outbuf.data(), 8 ) ;
-    if( stream.eof() ) {
-      SIO_THROW( sio::error_code::eof, "Reached end of file !" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void api::read_record_info( const buffer_span &hdr_buf, record_info_view &rec_info ) {
+    if( not hdr_buf.valid() ) {
+      SIO_THROW( sio::error_code::bad_state, "Buffer is invalid." ) ;
     }
-    if( not stream.good() ) {
-      SIO_THROW( sio::error_code::bad_state, "ifstream is in a bad state after reading first record bytes!" ) ;
+    if( hdr_buf.size() < 8 ) {
+      SIO_THROW( sio::error_code::out_of_range, "Buffer too small to contain a record header" ) ;
     }
-    unsigned int marker(0) ;
-    read_device device( outbuf.span() ) ;
+    unsigned int marker(0), name_length(0) ;
+    buffer_span::index_type pos (0) ;
     // Interpret: 1) The length of the record header.
     //            2) The record marker.
-    device.data( rec_info._header_length ) ;
-    device.data( marker ) ;
+    pos += api::read( hdr_buf, &rec_info._header_length, pos, 1 ) ;
+    pos += api::read( hdr_buf, &marker, pos, 1 ) ;
     if( marker != sio::record_marker ) {
-      stream.setstate( sio::ifstream::failbit ) ;
       SIO_THROW( sio::error_code::no_marker, "Record marker not found!" ) ;
     }
+    if( rec_info._header_length > hdr_buf.size() ) {
+      SIO_THROW( sio::error_code::out_of_range, "Record header length exceeds buffer size" ) ;
+    }
     // Interpret: 3) The options word.
     //            4) The length of the record data (compressed).
     //            5) The length of the record name (uncompressed).
     //            6) The length of the record name.
     //            7) The record name.
-    stream.read( outbuf.ptr(8), rec_info._header_length-8 ) ;
-    device.seek( 8 ) ;
-    device.data( rec_info._options ) ;
-    device.data( rec_info._data_length ) ;
-    device.data( rec_info._uncompressed_length ) ;
-    unsigned int name_length(0) ;
-    device.data( name_length ) ;
-    if( name_length > sio::max_record_name_len ) {
+    const auto header = hdr_buf.subspan( 0, rec_info._header_length ) ;
+    pos += api::read( header, &rec_info._options, pos, 1 ) ;
+    pos += api::read( header, &rec_info._data_length, pos, 1 ) ;
+    pos += api::read( header, &rec_info._uncompressed_length, pos, 1 ) ;
+    pos += api::read( header, &name_length, pos, 1 ) ;
+    if( name_length > sio::max_record_name_len or pos + name_length > header.size() ) {
       SIO_THROW( sio::error_code::no_marker, "Invalid record name size (limited)" ) ;
     }
-    rec_info._name.assign( name_length, '\0' ) ;
-    device.data( &(rec_info._name[0]), name_length ) ;
+    rec_info._name._data = header.ptr( pos ) ;
+    rec_info._name._size = name_length ;
     const auto compressed = sio::api::is_compressed( rec_info._options ) ;
     // if the record is compressed skip the read pointer over
     // any padding bytes that may have been inserted to make
@@ -124,49 +162,24 @@ namespace sio {
     // Use std::size_t arithmetic to avoid 32 bit overflow for records >= 4 GiB
     std::size_t tot_len = static_cast<std::size_t>(rec_info._data_length)
                         + static_cast<std::size_t>(rec_info._header_length) ;
-    SIO_DEBUG( "Total len before: " << tot_len ) ;
     if( compressed ) {
       tot_len += ((4 - (rec_info._data_length & sio::bit_align)) & sio::bit_align) ;
     }
-    SIO_DEBUG( "Total len after padding: " << tot_len ) ;
     rec_info._file_end = rec_info._file_start ;
     rec_info._file_end += tot_len ;
-    // a bit of debugging ...
-    SIO_DEBUG( "=== Read record info ====" ) ;
-    SIO_DEBUG( rec_info ) ;
-    SIO_DEBUG( "read_record_info: Resizing buffer to " << rec_info._header_length ) ;
-    outbuf.resize( rec_info._header_length ) ;
   }
 
   //--------------------------------------------------------------------------
 
   void api::read_record_data( sio::ifstream &stream, const record_info &rec_info, buffer &outbuf, std::size_t buffer_shift ) {
-    if( not stream.is_open() ) {
-      SIO_THROW( sio::error_code::not_open, "ifstream is not open!" ) ;
-    }
-    if( not stream.good() ) {
-      SIO_THROW( sio::error_code::bad_state, "ifstream is in a bad state!" ) ;
-    }
-    // resize the buffer to the expected read size.
-    // this may not re-allocate the buffer internally
-    // if it was large enough
-    outbuf.resize( buffer_shift + rec_info._data_length ) ;
-    // go to record start
-    auto seek_pos = rec_info._file_start ;
-    seek_pos += rec_info._header_length ;
-    stream.seekg( seek_pos ) ;
-    if( not stream.good() ) {
-      SIO_THROW( sio::error_code::bad_state, "ifstream is in a bad state after a seek operation!" ) ;
-    }
-    stream.read( outbuf.ptr( buffer_shift ), rec_info._data_length ) ;
-    if( not stream.good() ) {
-      SIO_THROW( sio::error_code::io_failure, "ifstream is in a bad state after a read operation!" ) ;
+    file_source source( stream ) ;
+    try {
+      api::read_record_data( source, rec_info, outbuf, buffer_shift ) ;
     }
-    if( not stream.seekg( rec_info._file_end ).good() ) {
-      SIO_THROW( sio::error_code::bad_state, "ifstream is in a bad state after a seek operation!" ) ;
+    catch( sio::exception &e ) {
+      fail_stream( stream, e ) ;
+      throw ;
     }
-    SIO_DEBUG( "read_record_data: Resizing buffer to " << buffer_shift + rec_info._data_length ) ;
-    outbuf.resize( buffer_shift + rec_info._data_length ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -234,15 +247,8 @@ namespace sio {
       SIO_THROW( sio::error_code::bad_state, "Buffer is invalid." ) ;
     }
     std::vector<block_info> block_infos ;
-    buffer_span::index_type current_pos (0) ;
-    while( 1 ) {
-      // end of block buffer ?
-      if( current_pos >= buf.size() ) {
-        break ;
-      }
-      auto block_data = sio::api::extract_block( buf, current_pos ) ;
-      current_pos = block_data.first._record_end ;
-      block_infos.push_back( block_data.first ) ;
+    for( const auto &binfo : sio::block_range( buf ) ) {
+      block_infos.push_back( binfo.to_info() ) ;
     }
     return block_infos ;
   }
@@ -250,37 +256,42 @@ namespace sio {
   //--------------------------------------------------------------------------
 
   std::pair<block_info, buffer_span> api::extract_block( const buffer_span &rec_buf, buffer_span::index_type index ) {
+    block_info_view view ;
+    auto block_span = api::extract_block( rec_buf, index, view ) ;
+    return std::make_pair( view.to_info(), block_span ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  buffer_span api::extract_block( const buffer_span &rec_buf, buffer_span::index_type index, block_info_view &info ) {
     if( index >= rec_buf.size() ) {
       SIO_THROW( sio::error_code::invalid_argument, "Start of block pointing after end of record!" ) ;
     }
-    block_info info ;
     SIO_DEBUG( "Block buffer size is " << rec_buf.size() ) ;
     SIO_DEBUG( "Block index is " << index ) ;
-    read_device device( rec_buf.subspan( index ) ) ;
     info._record_start = index ;
-    unsigned int marker(0), block_len(0) ;
-    device.data( block_len ) ;
+    unsigned int marker(0), block_len(0), name_len(0) ;
+    buffer_span::index_type pos = index ;
+    pos += api::read( rec_buf, &block_len, pos, 1 ) ;
     SIO_DEBUG( "Block len is " << block_len ) ;
-    device.data( marker ) ;
+    pos += api::read( rec_buf, &marker, pos, 1 ) ;
     // check for a block marker
-    if( sio::block_marker != marker ) {
+    const bool flagged = ( sio::flagged_block_marker == marker ) ;
+    if( sio::block_marker != marker and not flagged ) {
       std::stringstream ss ;
       ss << "Block marker not found (block marker: " << sio::block_marker <<", record marker: " << sio::record_marker << ", got " << marker << ")" ;
       SIO_THROW( sio::error_code::no_marker, ss.str() ) ;
     }
+    pos += api::read( rec_buf, &info._version, pos, 1 ) ;
+    pos += api::read( rec_buf, &name_len, pos, 1 ) ;
     // Validate block_len against the remaining buffer to catch corrupt records
     // (for example, caused by a 32 bit overflow of the record data length at write time)
     if( static_cast<std::size_t>(block_len) > rec_buf.size() - index ) {
       std::stringstream ss ;
       ss << "Block '" ;
       // peek at the name for the error message (best-effort, may itself be corrupt)
-      unsigned int ver(0), nlen(0) ;
-      read_device peek( rec_buf.subspan( index ) ) ;
-      peek.data( block_len ) ; peek.data( marker ) ; peek.data( ver ) ; peek.data( nlen ) ;
-      if( nlen <= sio::max_record_name_len ) {
-        std::string bname( nlen, '\0' ) ;
-        peek.data( &bname[0], nlen ) ;
-        ss << bname ;
+      if( name_len <= sio::max_record_name_len and pos + name_len <= rec_buf.size() ) {
+        ss.write( rec_buf.ptr( pos ), name_len ) ;
       } else {
         ss << "<unknown>" ;
       }
@@ -289,50 +300,84 @@ namespace sio {
          << "The record is likely corrupt (possible 32 bit overflow of data length at write time)." ;
       SIO_THROW( sio::error_code::out_of_range, ss.str() ) ;
     }
-    device.data( info._version ) ;
-    unsigned int name_len(0) ;
-    device.data( name_len ) ;
-    info._name.assign( name_len, '\0' ) ;
-    device.data( &(info._name[0]), name_len ) ;
-    info._header_length = device.position() ;
-    info._data_length = block_len - info._header_length ;
-    device.seek( block_len ) ;
+    // the name is padded to 4 bytes in the block header
+    const auto name_padlen = (name_len + sio::padding) & sio::padding_mask ;
+    if( pos + name_padlen > index + block_len ) {
+      SIO_THROW( sio::error_code::out_of_range, "Block name exceeds the block length" ) ;
+    }
+    info._name._data = rec_buf.ptr( pos ) ;
+    info._name._size = name_len ;
     info._record_end = index + block_len ;
-    return std::make_pair( info, rec_buf.subspan( index, block_len ) ) ;
+    if( not flagged ) {
+      info._header_length = pos + name_padlen - index ;
+      info._data_length = block_len - info._header_length ;
+      info._uncompressed_length = info._data_length ;
+      info._flags = 0 ;
+      return rec_buf.subspan( index, block_len ) ;
+    }
+    // the flags and the data lengths follow the name
+    pos += name_padlen ;
+    if( pos + 3*sizeof( unsigned int ) > index + block_len ) {
+      SIO_THROW( sio::error_code::out_of_range, "Block flags exceed the block length" ) ;
+    }
+    pos += api::read( rec_buf, &info._flags, pos, 1 ) ;
+    pos += api::read( rec_buf, &info._uncompressed_length, pos, 1 ) ;
+    pos += api::read( rec_buf, &info._data_length, pos, 1 ) ;
+    info._header_length = pos - index ;
+    if( info._data_length > block_len - info._header_length ) {
+      SIO_THROW( sio::error_code::out_of_range, "Block data length exceeds the block length" ) ;
+    }
+    return rec_buf.subspan( index, block_len ) ;
   }
 
   //--------------------------------------------------------------------------
 
   void api::read_blocks( const buffer_span &rec_buf, const std::vector<std::shared_ptr<block>>& blocks ) {
+    SIO_PERF_TIMER( read_blocks ) ;
+    SIO_TRACE_SCOPE( "codec", "read_blocks" ) ;
     if( not rec_buf.valid() ) {
       SIO_THROW( sio::error_code::bad_state, "Buffer is invalid." ) ;
     }
-    buffer_span::index_type current_pos (0) ;
+    // the block flags this version can decode
+    const unsigned int known_block_flags = sio::block_compression_flag | sio::block_shuffle_flag | sio::block_delta_flag | sio::block_element_size_mask ;
     read_device device ;
-    while( 1 ) {
-      // end of block buffer ?
-      if( current_pos >= rec_buf.size() ) {
-        break ;
-      }
-      auto block_data = sio::api::extract_block( rec_buf, current_pos ) ;
-      current_pos = block_data.first._record_end ;
+    sio::zlib_compression compressor ;
+    sio::buffer uncomp_block { sio::buffer::container() } ;
+    sio::buffer filter_block { sio::buffer::container() } ;
+    const sio::block_range block_headers( rec_buf ) ;
+    for( auto iter = block_headers.begin() ; iter != block_headers.end() ; ++iter ) {
+      const auto &binfo = *iter ;
       // look for the block decoder
-      auto block_iter = std::find_if( blocks.begin(), blocks.end(), [&]( std::shared_ptr<block> blk ) {
-        return ( blk->name() == block_data.first._name ) ;
+      auto block_iter = std::find_if( blocks.begin(), blocks.end(), [&]( const std::shared_ptr<block> &blk ) {
+        return ( blk->name() == binfo._name ) ;
       }) ;
       // skip the block if no decoder
       if( blocks.end() == block_iter ) {
         continue ;
       }
       // prepare the read device
-      device.set_buffer( block_data.second ) ;
-      device.seek( block_data.first._header_length ) ;
+      if( 0 == binfo._flags ) {
+        device.set_buffer( iter.block_span() ) ;
+        device.seek( binfo._header_length ) ;
+      }
+      else if( ( binfo._flags & sio::block_compression_flag ) and 0 == ( binfo._flags & ~known_block_flags ) ) {
+        // individually compressed block: inflated only when decoded
+        uncomp_block.resize( binfo._uncompressed_length ) ;
+        compressor.uncompress( iter.block_span().subspan( binfo._header_length, binfo._data_length ), uncomp_block ) ;
+        sio::filters::invert( binfo._flags, uncomp_block, filter_block ) ;
+        device.set_buffer( uncomp_block.span() ) ;
+        device.seek( 0 ) ;
+      }
+      else {
+        SIO_THROW( sio::error_code::bad_state, "Unsupported flags in block header (" + binfo._name.str() + ")" ) ;
+      }
       try {
-        (*block_iter)->read( device, block_data.first._version ) ;
+        (*block_iter)->read( device, binfo._version ) ;
       }
       catch( sio::exception &e ) {
-        SIO_RETHROW( e, sio::error_code::io_failure, "Failed to decode block buffer (" + block_data.first._name + ")" ) ;
+        SIO_RETHROW( e, sio::error_code::io_failure, "Failed to decode block buffer (" + binfo._name.str() + ")" ) ;
       }
+      SIO_PERF_COUNT( blocks_read, 1 ) ;
     }
     device.pointer_relocation() ;
   }
@@ -340,113 +385,16 @@ namespace sio {
   //--------------------------------------------------------------------------
 
   void api::dump_records( sio::ifstream &stream, std::size_t skip, std::size_t count, bool detailed ) {
-    try {
-      // skip records first
-      if( skip > 0 ) {
-        sio::api::skip_n_records( stream, skip ) ;
-      }
-      sio::record_info rec_info ;
-      sio::buffer info_buffer( sio::max_record_info_len ) ;
-      sio::buffer rec_buffer( sio::mbyte ) ;
-      sio::buffer uncomp_rec_buffer( sio::mbyte ) ;
-      unsigned int record_counter (0) ;
-      const unsigned int tab_len = 117 ;
-      if( not detailed ) {
-        std::cout << std::string( tab_len, '-' ) << std::endl ;
-        std::cout <<
-          std::setw(30) << std::left << "Record name " << " | " <<
-          std::setw(15) << "Start" << " | " <<
-          std::setw(15) << "End" << " | " <<
-          std::setw(12) << "Options" << " | " <<
-          std::setw(10) << "Header len" << " | " <<
-          std::setw(15) << "Data len" <<
-          std::endl ;
-        std::cout << std::string( tab_len, '-' ) << std::endl ;
-      }
-      while(1) {
-        if( record_counter >= count ) {
-          break ;
-        }
-        SIO_DEBUG( "Start reading next record info from stream" ) ;
-        sio::api::read_record_info( stream, rec_info, info_buffer ) ;
-        if( detailed ) {
-          SIO_DEBUG( "Detailed: Start reading next record data from stream" ) ;
-          sio::api::read_record_data( stream, rec_info, rec_buffer ) ;
-        }
-        // seek after the record to read the next record info
-        stream.seekg( rec_info._file_end ) ;
-        ++ record_counter ;
-        if( detailed ) {
-          std::cout << std::string( tab_len, '-' ) << std::endl ;
-          std::cout <<
-            std::setw(30) << std::left << "Record name " << " | " <<
-            std::setw(15) << "Start" << " | " <<
-            std::setw(15) << "End" << " | " <<
-            std::setw(12) << "Options" << " | " <<
-            std::setw(10) << "Header len" << " | " <<
-            std::setw(15) << "Data len" <<
-            std::endl ;
-        }
-        std::stringstream size_str ;
-        size_str << rec_info._data_length << " (" << rec_info._uncompressed_length << ")" ;
-        std::cout <<
-          std::setw(30) << std::left << rec_info._name << " | " <<
-          std::setw(15) << rec_info._file_start << " | " <<
-          std::setw(15) << rec_info._file_end << " | " <<
-          std::setw(12) << rec_info._options << " | " <<
-          std::setw(10) << rec_info._header_length << " | " <<
-          std::setw(15) << size_str.str() <<
-          std::endl ;
-        if( detailed ) {
-          std::cout << std::string( tab_len, '-' ) << std::endl ;
-          std::cout <<
-            std::setw(30) << std::left << "Block name " << " | " <<
-            std::setw(15) << "Start" << " | " <<
-            std::setw(15) << "End" << " | " <<
-            std::setw(12) << "Version" << " | " <<
-            std::setw(10) << "Header len" << " | " <<
-            std::setw(15) << "Data len" <<
-            std::endl ;
-          std::cout << std::string( tab_len, '-' ) << std::endl ;
-          const bool compressed = sio::api::is_compressed( rec_info._options ) ;
-          if( compressed ) {
-            // FIXME use zlib by default ??
-            sio::zlib_compression compressor ;
-            uncomp_rec_buffer.resize( rec_info._uncompressed_length ) ;
-            compressor.uncompress( rec_buffer.span(), uncomp_rec_buffer ) ;
-          }
-          sio::buffer_span device_buffer = compressed ? uncomp_rec_buffer.span() : rec_buffer.span( 0, rec_info._data_length ) ;
-          SIO_DEBUG( "Start extracting block infos" ) ;
-          auto block_infos = sio::api::read_block_infos( device_buffer ) ;
-          SIO_DEBUG( "Number of blocks found: " << block_infos.size() ) ;
-          for( auto binfo : block_infos ) {
-            std::stringstream version_str ;
-            version_str << sio::version::major_version( binfo._version ) << "." << sio::version::minor_version( binfo._version ) ;
-            std::cout <<
-              std::setw(30) << std::left << binfo._name << " | " <<
-              std::setw(15) << binfo._record_start << " | " <<
-              std::setw(15) << binfo._record_end << " | " <<
-              std::setw(12) << version_str.str() << " | " <<
-              std::setw(10) << binfo._header_length << " | " <<
-              std::setw(15) << binfo._data_length <<
-              std::endl ;
-          }
-          std::cout << std::endl ;
-        }
-      }
-    }
-    catch( sio::exception &e ) {
-      // we are finished !
-      if( e.code() == sio::error_code::eof ) {
-        return ;
-      }
-      throw e ;
-    }
+    // single threaded version of the dump, see sio/dump.h
+    sio::dump::records( stream, skip, count, detailed, 1 ) ;
   }
 
+
   //--------------------------------------------------------------------------
 
   void api::write_blocks( write_device &device, const block_list &blocks ) {
+    SIO_PERF_TIMER( write_blocks ) ;
+    SIO_TRACE_SCOPE( "codec", "write_blocks" ) ;
     for( auto blk : blocks ) {
       auto blk_ptr = blk ;
       try {
@@ -476,6 +424,7 @@ namespace sio {
         device.seek( block_start ) ;
         device.data( blklen ) ;
         device.seek( blk_end ) ;
+        SIO_PERF_COUNT( blocks_written, 1 ) ;
       }
       catch( sio::exception &e ) {
         SIO_RETHROW( e, sio::error_code::io_failure, "Couldn't write block to buffer (" + blk_ptr->name() + ")" ) ;
@@ -548,75 +497,133 @@ namespace sio {
 
   //--------------------------------------------------------------------------
 
-  void api::write_record( sio::ofstream &stream, const buffer_span &rec_buf, record_info &rec_info ) {
-    if( not stream.is_open() ) {
-      SIO_THROW( sio::error_code::not_open, "ofstream is not open!" ) ;
+  void api::store_record( record_info &rec_info, buffer &rec_buf, buffer &out_buf ) {
+    if( not rec_buf.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Record buffer is invalid" ) ;
     }
-    if( not stream.good() ) {
-      SIO_THROW( sio::error_code::bad_state, "ofstream is in a bad state!" ) ;
+    if( not out_buf.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Output buffer is invalid" ) ;
     }
-    if( not rec_buf.valid() ) {
-      SIO_THROW( sio::error_code::invalid_argument, "The record buffer is not valid" ) ;
-    }
-    rec_info._file_start = stream.tellp() ;
-    // write data
-    if( not stream.write( rec_buf.data(), rec_buf.size() ).good() ) {
-      SIO_THROW( sio::error_code::io_failure, "Couldn't write record buffer to output stream" ) ;
-    }
-    // always add some padding bytes at the end
-    auto padlen = (4 - (rec_buf.size() & sio::bit_align)) & sio::bit_align;
-    if( padlen > 0 ) {
-      SIO_DEBUG( "Writing " << padlen << " bytes for padding ..." ) ;
-      if( not stream.write( sio::padding_bytes, padlen ).good() ) {
-        SIO_THROW( sio::error_code::io_failure, "Couldn't write record buffer padding to output stream" ) ;
-      }
+    try {
+      // the record data is left untouched by the compression
+      auto rec_span = rec_buf.span( rec_info._header_length, rec_info._uncompressed_length ) ;
+      out_buf.resize( rec_span.size() ) ;
+      std::copy( rec_span.begin(), rec_span.end(), out_buf.data() ) ;
+      sio::api::set_compression( rec_info._options, false ) ;
+      rec_info._data_length = rec_info._uncompressed_length ;
+      write_device device ( std::move(rec_buf) ) ;
+      // fill back the record buffer with updated information on header
+      device.data( rec_info._header_length ) ;
+      device.data( sio::record_marker ) ;
+      device.data( rec_info._options ) ;
+      device.data( rec_info._data_length ) ;
+      // get back the buffer
+      rec_buf = device.take_buffer() ;
     }
-    // flush the stream
-    if( not stream.flush().good() ) {
-      SIO_THROW( sio::error_code::io_failure, "Couldn't flush output stream" ) ;
+    catch( sio::exception &e ) {
+      SIO_RETHROW( e, sio::error_code::io_failure, "Couldn't store record buffer uncompressed" ) ;
     }
-    rec_info._file_end = stream.tellp() ;
-    SIO_DEBUG( "Written record with info :\n" << rec_info ) ;
   }
 
   //--------------------------------------------------------------------------
 
-  void api::write_record( sio::ofstream &stream, const buffer_span &hdr_span, const buffer_span &data_span, record_info &rec_info ) {
-    if( not stream.is_open() ) {
-      SIO_THROW( sio::error_code::not_open, "ofstream is not open!" ) ;
-    }
-    if( not stream.good() ) {
-      SIO_THROW( sio::error_code::bad_state, "ofstream is in a bad state!" ) ;
+  void api::compress_blocks( record_info &rec_info, buffer &rec_buf, buffer &comp_buf, zlib_compression &compressor, std::size_t threshold, const block_filters &filter_map ) {
+    if( not rec_buf.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Record buffer is invalid" ) ;
     }
-    if( not hdr_span.valid() ) {
-      SIO_THROW( sio::error_code::invalid_argument, "The record header buffer is not valid" ) ;
+    if( not comp_buf.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Compression buffer is invalid" ) ;
     }
-    if( not data_span.valid() ) {
-      SIO_THROW( sio::error_code::invalid_argument, "The record data buffer is not valid" ) ;
+    if( api::is_compressed( rec_info._options ) ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Record buffer is already compressed" ) ;
     }
-    rec_info._file_start = stream.tellp() ;
-    // write record header
-    if( not stream.write( hdr_span.data(), hdr_span.size() ).good() ) {
-      SIO_THROW( sio::error_code::io_failure, "Couldn't write record header buffer to output stream" ) ;
+    try {
+      write_device device( std::move(comp_buf) ) ;
+      buffer block_buf( sio::kbyte ) ;
+      buffer filter_buf( sio::kbyte ) ;
+      const sio::block_range blocks( rec_buf.span( rec_info._header_length, rec_info._data_length ) ) ;
+      for( auto iter = blocks.begin() ; iter != blocks.end() ; ++iter ) {
+        const auto &binfo = *iter ;
+        const auto block_span = iter.block_span() ;
+        const auto block_data = block_span.subspan( binfo._header_length, binfo._data_length ) ;
+        bool compress = ( 0 == binfo._flags ) and ( binfo._data_length >= threshold ) ;
+        unsigned int block_flags = sio::block_compression_flag ;
+        if( compress ) {
+          auto filter_iter = filter_map.find( binfo._name.str() ) ;
+          if( filter_map.end() != filter_iter ) {
+            block_flags |= sio::filters::flags( filter_iter->second ) ;
+            sio::filters::apply( block_flags, block_data, filter_buf ) ;
+          }
+          compressor.compress( ( block_flags == sio::block_compression_flag ) ? block_data : filter_buf.span(), block_buf ) ;
+          // the flags and lengths cost 3 words in the block header
+          compress = ( block_buf.size() + 3*sizeof( unsigned int ) < block_data.size() ) ;
+        }
+        if( not compress ) {
+          device.data( block_span.data(), block_span.size() ) ;
+          continue ;
+        }
+        // Output: 1) A placeholder for the block length.
+        //         2) The flagged block marker.
+        //         3) The block version.
+        //         4) The block name length and the block name.
+        //         5) The block flags.
+        //         6) The block data length (uncompressed and compressed).
+        //         7) The compressed block data.
+        const auto block_start = device.position() ;
+        device.data( sio::flagged_block_marker ) ;
+        device.data( sio::flagged_block_marker ) ;
+        device.data( binfo._version ) ;
+        const unsigned int name_len = binfo._name._size ;
+        device.data( name_len ) ;
+        device.data( binfo._name._data, name_len ) ;
+        device.data( block_flags ) ;
+        device.data( binfo._data_length ) ;
+        const unsigned int comp_len = block_buf.size() ;
+        device.data( comp_len ) ;
+        device.data( block_buf.data(), comp_len ) ;
+        const auto block_end = device.position() ;
+        const unsigned int block_len = block_end - block_start ;
+        device.seek( block_start ) ;
+        device.data( block_len ) ;
+        device.seek( block_end ) ;
+      }
+      const auto data_len = device.position() ;
+      comp_buf = device.take_buffer() ;
+      comp_buf.resize( data_len ) ;
+      rec_info._data_length = data_len ;
+      rec_info._uncompressed_length = data_len ;
+      // fill back the record buffer with updated information on header
+      write_device header_device( std::move(rec_buf) ) ;
+      header_device.data( rec_info._header_length ) ;
+      header_device.data( sio::record_marker ) ;
+      header_device.data( rec_info._options ) ;
+      header_device.data( rec_info._data_length ) ;
+      header_device.data( rec_info._uncompressed_length ) ;
+      rec_buf = header_device.take_buffer() ;
     }
-    // write record data
-    if( not stream.write( data_span.data(), data_span.size() ).good() ) {
-      SIO_THROW( sio::error_code::io_failure, "Couldn't write record data buffer to output stream" ) ;
+    catch( sio::exception &e ) {
+      SIO_RETHROW( e, sio::error_code::io_failure, "Couldn't compress record blocks" ) ;
     }
-    // always add some padding bytes at the end
-    auto padlen = (4 - (data_span.size() & sio::bit_align)) & sio::bit_align;
-    if( padlen > 0 ) {
-      SIO_DEBUG( "Writing " << padlen << " bytes for padding ..." ) ;
-      if( not stream.write( sio::padding_bytes, padlen ).good() ) {
-        SIO_THROW( sio::error_code::io_failure, "Couldn't write record buffer padding to output stream" ) ;
-      }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void api::write_record( sio::ofstream &stream, const buffer_span &rec_buf, record_info &rec_info ) {
+    file_sink sink( stream ) ;
+    if( not stream.good() ) {
+      SIO_THROW( sio::error_code::bad_state, "ofstream is in a bad state!" ) ;
     }
-    // flush the stream
-    if( not stream.flush().good() ) {
-      SIO_THROW( sio::error_code::io_failure, "Couldn't flush output stream" ) ;
+    api::write_record( sink, rec_buf, rec_info ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void api::write_record( sio::ofstream &stream, const buffer_span &hdr_span, const buffer_span &data_span, record_info &rec_info ) {
+    file_sink sink( stream ) ;
+    if( not stream.good() ) {
+      SIO_THROW( sio::error_code::bad_state, "ofstream is in a bad state!" ) ;
     }
-    rec_info._file_end = stream.tellp() ;
-    SIO_DEBUG( "Written record with info :\n" << rec_info ) ;
+    api::write_record( sink, hdr_span, data_span, rec_info ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -636,4 +643,86 @@ namespace sio {
     return out ;
   }
 
+  //--------------------------------------------------------------------------
+
+  std::size_t api::find_record_marker( const buffer_span &buf, std::size_t start ) {
+    if( not buf.valid() ) {
+      return 0 ;
+    }
+    // the record marker as written in the file (big endian)
+    const sio::byte pattern[4] = {
+      static_cast<sio::byte>( 0xab ), static_cast<sio::byte>( 0xad ),
+      static_cast<sio::byte>( 0xca ), static_cast<sio::byte>( 0xfe )
+    } ;
+    const auto data = buf.data() ;
+    const auto size = buf.size() ;
+    std::size_t pos = ( start + sio::bit_align ) & sio::padding_mask ;
+#if defined(__AVX2__) || defined(__SSE2__)
+    std::int32_t word ;
+    std::memcpy( &word, pattern, 4 ) ;
+#if defined(__AVX2__)
+    const __m256i needle = _mm256_set1_epi32( word ) ;
+    for( ; pos + 32 <= size ; pos += 32 ) {
+      const __m256i chunk = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( data + pos ) ) ;
+      if( 0 != _mm256_movemask_epi8( _mm256_cmpeq_epi32( chunk, needle ) ) ) {
+        break ;
+      }
+    }
+#else
+    const __m128i needle = _mm_set1_epi32( word ) ;
+    for( ; pos + 16 <= size ; pos += 16 ) {
+      const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + pos ) ) ;
+      if( 0 != _mm_movemask_epi8( _mm_cmpeq_epi32( chunk, needle ) ) ) {
+        break ;
+      }
+    }
+#endif
+#elif defined(__ARM_NEON)
+    std::uint32_t word ;
+    std::memcpy( &word, pattern, 4 ) ;
+    const uint32x4_t needle = vdupq_n_u32( word ) ;
+    for( ; pos + 16 <= size ; pos += 16 ) {
+      const uint32x4_t chunk = vreinterpretq_u32_u8( vld1q_u8( reinterpret_cast<const std::uint8_t*>( data + pos ) ) ) ;
+      const uint64x2_t eq = vreinterpretq_u64_u32( vceqq_u32( chunk, needle ) ) ;
+      if( 0 != ( vgetq_lane_u64( eq, 0 ) | vgetq_lane_u64( eq, 1 ) ) ) {
+        break ;
+      }
+    }
+#endif
+    // scalar search: remaining bytes or the vector containing the marker
+    for( ; pos + 4 <= size ; pos += 4 ) {
+      if( 0 == std::memcmp( data + pos, pattern, 4 ) ) {
+        return pos ;
+      }
+    }
+    return size ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool api::validate_record_info( const buffer_span &hdr_buf, record_info_view &rec_info ) {
+    try {
+      api::read_record_info( hdr_buf, rec_info ) ;
+    }
+    catch( const sio::exception & ) {
+      return false ;
+    }
+    // 5 words + the name, padded to 4 bytes
+    const std::size_t fixed_len = 6 * sizeof(unsigned int) ;
+    const std::size_t name_len = rec_info._name._size ;
+    const std::size_t padded_name_len = ( name_len + sio::bit_align ) & sio::padding_mask ;
+    if( rec_info._header_length != fixed_len + padded_name_len ) {
+      return false ;
+    }
+    if( not sio::valid_record_name( std::string( rec_info._name._data, name_len ) ) ) {
+      return false ;
+    }
+    if( not api::is_compressed( rec_info._options ) ) {
+      if( rec_info._data_length != rec_info._uncompressed_length or 0 != ( rec_info._data_length & sio::bit_align ) ) {
+        return false ;
+      }
+    }
+    return true ;
+  }
+
 }
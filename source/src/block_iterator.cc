@@ -0,0 +1,109 @@
+// -- sio headers
+#include <sio/block_iterator.h>
+#include <sio/api.h>
+#include <sio/exception.h>
+#include <sio/definitions.h>
+
+
+namespace sio {
+
+  block_iterator::block_iterator( const buffer_span &rec_buf ) :
+    _buffer( rec_buf ),
+    _end( not rec_buf.valid() or rec_buf.empty() ) {
+    if( not _end ) {
+      parse() ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  block_iterator::reference block_iterator::operator*() const {
+    return _info ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  block_iterator::pointer block_iterator::operator->() const {
+    return &_info ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  block_iterator &block_iterator::operator++() {
+    if( _end ) {
+      SIO_THROW( sio::error_code::out_of_range, "Can't increment block iterator past the end" ) ;
+    }
+    if( _info._record_end >= _buffer.size() ) {
+      _end = true ;
+      _block = buffer_span() ;
+      _info = block_info_view() ;
+    }
+    else {
+      parse() ;
+    }
+    return *this ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  block_iterator block_iterator::operator++(int) {
+    block_iterator copy( *this ) ;
+    ++(*this) ;
+    return copy ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool block_iterator::operator==( const block_iterator &rhs ) const {
+    if( _end or rhs._end ) {
+      return ( _end == rhs._end ) ;
+    }
+    return ( _buffer.data() == rhs._buffer.data() ) and ( _info._record_start == rhs._info._record_start ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool block_iterator::operator!=( const block_iterator &rhs ) const {
+    return not ( *this == rhs ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const buffer_span &block_iterator::block_span() const {
+    return _block ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  buffer_span block_iterator::data_span() const {
+    return _block.subspan( _info._header_length ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void block_iterator::parse() {
+    // the previous block end is the next block start (0 on first call)
+    _block = sio::api::extract_block( _buffer, _info._record_end, _info ) ;
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  block_range::block_range( const buffer_span &rec_buf ) :
+    _buffer( rec_buf ) {
+    /* nop */
+  }
+
+  //--------------------------------------------------------------------------
+
+  block_iterator block_range::begin() const {
+    return block_iterator( _buffer ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  block_iterator block_range::end() const {
+    return block_iterator() ;
+  }
+
+}
@@ -2,6 +2,7 @@
 #include <sio/buffer.h>
 #include <sio/exception.h>
 #include <sio/definitions.h>
+#include <sio/perf_counters.h>
 // -- std headers
 #include <sstream>
 #include <iomanip>
@@ -20,24 +21,35 @@ namespace sio {
   //--------------------------------------------------------------------------
 
   buffer_span::buffer_span( const container &bytes ) :
-    _first( bytes.begin() ),
-    _last( bytes.end() ) {
+    _first( bytes.data() ),
+    _last( bytes.data() + bytes.size() ) {
     /* nop */
   }
 
   //--------------------------------------------------------------------------
 
-  buffer_span::buffer_span( const_iterator first, const_iterator last ) :
-    _first(first),
-    _last(last) {
-    /* nop */
+  buffer_span::buffer_span( container::const_iterator first, container::const_iterator last ) {
+    // can't dereference an end iterator: an empty range is an empty span
+    if( first != last ) {
+      _first = &(*first) ;
+      _last = _first + std::distance( first, last ) ;
+    }
   }
 
   //--------------------------------------------------------------------------
 
-  buffer_span::buffer_span( const_iterator first, std::size_t count ) :
+  buffer_span::buffer_span( container::const_iterator first, std::size_t count ) {
+    if( count > 0 ) {
+      _first = &(*first) ;
+      _last = _first + count ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  buffer_span::buffer_span( const_pointer first, std::size_t count ) :
     _first(first),
-    _last(std::next(first, count)) {
+    _last(first + count) {
     /* nop */
   }
 
@@ -56,7 +68,7 @@ namespace sio {
   //--------------------------------------------------------------------------
 
   const buffer_span::element_type *buffer_span::data() const {
-    return _isnull ? nullptr : &(*_first) ;
+    return _isnull ? nullptr : _first ;
   }
 
   //--------------------------------------------------------------------------
@@ -126,7 +138,7 @@ namespace sio {
       ss << "start: " << start << ", size: " << size() ;
       SIO_THROW( error_code::out_of_range, ss.str() ) ;
     }
-    return buffer_span( std::next(_first, start) , _last ) ;
+    return buffer_span( _first + start, size() - start ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -137,7 +149,7 @@ namespace sio {
       ss << "start: " << start << ", count: " << count << ", size: " << size() ;
       SIO_THROW( error_code::out_of_range, ss.str() ) ;
     }
-    return buffer_span( std::next(_first, start) , std::next(_first, start+count) ) ;
+    return buffer_span( _first + start, count ) ;
   }
   
   //--------------------------------------------------------------------------
@@ -332,6 +344,9 @@ namespace sio {
   //--------------------------------------------------------------------------
 
   void buffer::resize( size_type newsize ) {
+    if( newsize > _bytes.capacity() ) {
+      SIO_PERF_COUNT( buffer_reallocations, 1 ) ;
+    }
     _bytes.resize( newsize ) ;
   }
 
@@ -375,7 +390,7 @@ namespace sio {
   //--------------------------------------------------------------------------
 
   buffer_span buffer::span() const {
-    return buffer_span( begin() , end() ) ;
+    return buffer_span( data() , size() ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -386,7 +401,7 @@ namespace sio {
       ss << "start: " << start << ", size: " << size() ;
       SIO_THROW( error_code::out_of_range, ss.str() ) ;
     }
-    return buffer_span( std::next(begin(), start) , end() ) ;
+    return buffer_span( data() + start , size() - start ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -397,7 +412,7 @@ namespace sio {
       ss << "start: " << start << ", count: " << count << ", size: " << size() ;
       SIO_THROW( error_code::out_of_range, ss.str() ) ;
     }
-    return buffer_span( std::next(begin(), start) , std::next(begin(), start+count) ) ;
+    return buffer_span( data() + start , count ) ;
   }
 
 }
@@ -0,0 +1,228 @@
+// -- sio headers
+#include <sio/buffered_reader.h>
+#include <sio/api.h>
+#include <sio/exception.h>
+#include <sio/definitions.h>
+
+// -- std headers
+#include <algorithm>
+#include <cstring>
+
+
+namespace sio {
+
+  buffered_reader::buffered_reader( sio::ifstream &stream, size_type window_size ) :
+    _stream(stream),
+    _window(window_size) {
+    if( not _stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "ifstream is not open!" ) ;
+    }
+    // non seekable streams (pipes) report an invalid position:
+    // start at 0 and never seek
+    const auto pos = _stream.tellg() ;
+    if( pos_type(-1) != pos ) {
+      _window_start = static_cast<size_type>( static_cast<std::streamoff>( pos ) ) ;
+      _next_pos = _window_start ;
+    }
+    else {
+      _stream.clear() ;
+      _forward_only = true ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void buffered_reader::read_record_info( record_info_view &rec_info ) {
+    const auto pos = _next_pos ;
+    _has_current = false ;
+    if( fill( pos, 8 ) < 8 ) {
+      SIO_THROW( sio::error_code::eof, "Reached end of file !" ) ;
+    }
+    // Interpret: 1) The length of the record header.
+    //            2) The record marker.
+    unsigned int header_length(0), marker(0) ;
+    const auto first_bytes = _window.span( pos - _window_start, 8 ) ;
+    sio::api::read( first_bytes, &header_length, 0, 1 ) ;
+    sio::api::read( first_bytes, &marker, 4, 1 ) ;
+    if( marker != sio::record_marker ) {
+      SIO_THROW( sio::error_code::no_marker, "Record marker not found!" ) ;
+    }
+    if( header_length < 8 or header_length > sio::max_record_info_len ) {
+      SIO_THROW( sio::error_code::no_marker, "Invalid record header length" ) ;
+    }
+    if( fill( pos, header_length ) < header_length ) {
+      SIO_THROW( sio::error_code::io_failure, "Reached end of file while reading the record header!" ) ;
+    }
+    _current = record_info_view() ;
+    _current._file_start = pos_type( static_cast<std::streamoff>( pos ) ) ;
+    sio::api::read_record_info( _window.span( pos - _window_start, header_length ), _current ) ;
+    // keep the name out of the window so that the view survives window refills
+    std::memcpy( _name, _current._name._data, _current._name._size ) ;
+    _current._name._data = _name ;
+    _next_pos = static_cast<size_type>( static_cast<std::streamoff>( _current._file_end ) ) ;
+    _has_current = true ;
+    rec_info = _current ;
+    SIO_DEBUG( "=== Read record info ====" ) ;
+    SIO_DEBUG( _current.to_info() ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void buffered_reader::read_record_info( record_info &rec_info ) {
+    record_info_view view ;
+    read_record_info( view ) ;
+    rec_info = view.to_info() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool buffered_reader::next_record_info( record_info_view &rec_info ) {
+    try {
+      read_record_info( rec_info ) ;
+    }
+    catch( sio::exception &e ) {
+      if( e.code() == sio::error_code::eof ) {
+        return false ;
+      }
+      throw ;
+    }
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  buffer_span buffered_reader::read_record_data() {
+    auto rec_span = read_record() ;
+    return rec_span.subspan( _current._header_length ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void buffered_reader::read_record_data( buffer &outbuf, size_type buffer_shift ) {
+    auto data_span = read_record_data() ;
+    outbuf.resize( buffer_shift + data_span.size() ) ;
+    std::copy( data_span.begin(), data_span.end(), outbuf.begin() + buffer_shift ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  buffer_span buffered_reader::read_record() {
+    if( not _has_current ) {
+      SIO_THROW( sio::error_code::bad_state, "No record header read out!" ) ;
+    }
+    const auto pos = static_cast<size_type>( static_cast<std::streamoff>( _current._file_start ) ) ;
+    const auto len = static_cast<size_type>( _current._header_length ) + _current._data_length ;
+    if( fill( pos, len ) < len ) {
+      SIO_THROW( sio::error_code::io_failure, "Reached end of file while reading the record data!" ) ;
+    }
+    return _window.span( pos - _window_start, len ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  buffered_reader::pos_type buffered_reader::position() const {
+    return pos_type( static_cast<std::streamoff>( _next_pos ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void buffered_reader::seek( pos_type pos ) {
+    if( pos_type(-1) == pos ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Invalid stream position" ) ;
+    }
+    _next_pos = static_cast<size_type>( static_cast<std::streamoff>( pos ) ) ;
+    _has_current = false ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool buffered_reader::forward_only() const {
+    return _forward_only ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void buffered_reader::set_forward_only( bool enable ) {
+    _forward_only = enable ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  buffered_reader::size_type buffered_reader::stream_reads() const {
+    return _stream_reads ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  buffered_reader::size_type buffered_reader::fill( size_type pos, size_type len ) {
+    const auto window_end = _window_start + _window_len ;
+    if( pos >= _window_start and pos + len <= window_end ) {
+      return len ;
+    }
+    if( _forward_only and pos < _window_start ) {
+      SIO_THROW( sio::error_code::bad_state, "Can't read backward in forward-only mode!" ) ;
+    }
+    if( _forward_only and pos > window_end ) {
+      // beyond the window: read and discard the bytes up to the new position
+      const auto skip = pos - window_end ;
+      _stream.ignore( static_cast<std::streamsize>( skip ) ) ;
+      const auto nskipped = static_cast<size_type>( _stream.gcount() ) ;
+      ++ _stream_reads ;
+      _window_start = window_end + nskipped ;
+      _window_len = 0 ;
+      if( _stream.eof() ) {
+        _eof = true ;
+        _stream.clear() ;
+      }
+      else if( not _stream.good() ) {
+        SIO_THROW( sio::error_code::io_failure, "ifstream is in a bad state after a read operation!" ) ;
+      }
+      if( nskipped < skip ) {
+        return 0 ;
+      }
+    }
+    else if( pos < _window_start or pos > window_end ) {
+      // out of the window: move the stream to the new position
+      _stream.clear() ;
+      _stream.seekg( pos_type( static_cast<std::streamoff>( pos ) ) ) ;
+      if( not _stream.good() ) {
+        SIO_THROW( sio::error_code::bad_state, "ifstream is in a bad state after a seek operation!" ) ;
+      }
+      _window_start = pos ;
+      _window_len = 0 ;
+      _eof = false ;
+    }
+    else {
+      // drop the consumed bytes and keep the remaining ones at the window front
+      const auto keep = window_end - pos ;
+      if( keep > 0 and pos != _window_start ) {
+        std::memmove( _window.data(), _window.ptr( pos - _window_start ), keep ) ;
+      }
+      _window_start = pos ;
+      _window_len = keep ;
+    }
+    if( len > _window.size() ) {
+      SIO_DEBUG( "Growing read window to " << len << " bytes" ) ;
+      _window.resize( len ) ;
+    }
+    // read ahead as much as possible with a single read in most cases.
+    // A read on a pipe blocks until all the requested bytes arrive, so only
+    // the missing bytes are read in forward-only mode
+    while( _window_len < len and not _eof ) {
+      const auto nrequest = _forward_only ? len - _window_len : _window.size() - _window_len ;
+      _stream.read( _window.ptr( _window_len ), nrequest ) ;
+      const auto nread = static_cast<size_type>( _stream.gcount() ) ;
+      ++ _stream_reads ;
+      _window_len += nread ;
+      if( _stream.eof() ) {
+        _eof = true ;
+        _stream.clear() ;
+      }
+      else if( not _stream.good() ) {
+        SIO_THROW( sio::error_code::io_failure, "ifstream is in a bad state after a read operation!" ) ;
+      }
+    }
+    return std::min( len, _window_len ) ;
+  }
+
+}
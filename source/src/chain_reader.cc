@@ -0,0 +1,209 @@
+// -- sio headers
+#include <sio/chain_reader.h>
+#include <sio/buffered_reader.h>
+#include <sio/exception.h>
+#include <sio/trace.h>
+
+// -- std headers
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+
+
+namespace sio {
+
+  chain_reader::chain_reader( const std::vector<std::string> &fnames, size_type lookahead ) :
+    _lookahead( lookahead ) {
+    for( const auto &fname : fnames ) {
+      std::unique_ptr<chain_file> file( new chain_file() ) ;
+      file->_fname = fname ;
+      _files.push_back( std::move( file ) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  chain_reader::~chain_reader() {
+    for( auto &file : _files ) {
+      if( file->_opened.valid() ) {
+        file->_opened.wait() ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  chain_reader::size_type chain_reader::files() const {
+    return _files.size() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  chain_reader::size_type chain_reader::file_records( size_type file ) {
+    return wait_open( file )._index.size() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool chain_reader::file_indexed( size_type file ) {
+    return wait_open( file )._indexed ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  chain_reader::size_type chain_reader::size() {
+    size_type total = 0 ;
+    for( size_type i=0 ; i<_files.size() ; i++ ) {
+      total += count_records( i ) ;
+    }
+    return total ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::pair<chain_reader::size_type, chain_reader::size_type> chain_reader::locate( size_type record ) {
+    size_type first = 0 ;
+    for( size_type i=0 ; i<_files.size() ; i++ ) {
+      const auto count = count_records( i ) ;
+      if( record < first + count ) {
+        return std::make_pair( i, record - first ) ;
+      }
+      first += count ;
+    }
+    SIO_THROW( sio::error_code::out_of_range, "Record " + std::to_string( record ) + " is out of range (" + std::to_string( first ) + " records in chain)" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void chain_reader::go_to_record( size_type record ) {
+    const auto loc = locate( record ) ;
+    _file = loc.first ;
+    _local = loc.second ;
+    _global = record ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  chain_reader::size_type chain_reader::current_record() const {
+    return _global ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool chain_reader::read_next_record( record_info &rec_info, buffer &outbuf ) {
+    while( _file < _files.size() ) {
+      auto &file = open( _file ) ;
+      if( _local < file._index.size() ) {
+        const auto &ent = file._index.at( _local ) ;
+        file._reader->read_record( static_cast<std::streamoff>( ent._position ), rec_info, outbuf ) ;
+        ++ _local ;
+        ++ _global ;
+        return true ;
+      }
+      // done with this file: release the file descriptor, keep the index
+      file._reader.reset() ;
+      ++ _file ;
+      _local = 0 ;
+    }
+    return false ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void chain_reader::read_record( size_type record, record_info &rec_info, buffer &outbuf ) {
+    go_to_record( record ) ;
+    read_next_record( rec_info, outbuf ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void chain_reader::open_file( chain_file &file ) {
+    SIO_TRACE_SCOPE( "io", "open_file" ) ;
+    file._reader.reset( new pread_reader( file._fname ) ) ;
+    const auto file_size = file._reader->file_size() ;
+    // try the index sidecar file first
+    const auto idx_name = record_index::sidecar_name( file._fname ) ;
+    if( std::ifstream( idx_name ).good() ) {
+      record_index index ;
+      index.read( idx_name ) ;
+      std::uint64_t end = 0 ;
+      for( const auto &ent : index ) {
+        end = std::max( end, ent._position + ent._length ) ;
+      }
+      // a multi-file index (manifest) or a stale index is not usable
+      if( index.files().empty() and end == file_size ) {
+        file._index = std::move( index ) ;
+        file._indexed = true ;
+        return ;
+      }
+    }
+    // no index: scan the record headers
+    sio::ifstream stream ;
+    stream.open( file._fname, std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open input stream '" + file._fname + "'" ) ;
+    }
+    sio::buffered_reader reader( stream ) ;
+    sio::record_info_view view ;
+    std::uint64_t sequence = 0 ;
+    while( reader.next_record_info( view ) ) {
+      file._index.add( view.to_info(), sequence++ ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void chain_reader::open_async( size_type index ) {
+    auto &file = *_files[index] ;
+    if( not file._opened.valid() ) {
+      file._opened = std::async( std::launch::async, &chain_reader::open_file, std::ref( file ) ).share() ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  chain_reader::size_type chain_reader::count_records( size_type index ) {
+    auto &file = wait_open( index ) ;
+    const auto count = file._index.size() ;
+    // only the current file needs to stay open
+    if( index != _file ) {
+      file._reader.reset() ;
+    }
+    return count ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  chain_reader::chain_file &chain_reader::wait_open( size_type index ) {
+    if( index >= _files.size() ) {
+      SIO_THROW( sio::error_code::out_of_range, "File " + std::to_string( index ) + " is out of range" ) ;
+    }
+    const auto last = std::min( _files.size(), index + 1 + _lookahead ) ;
+    for( size_type i=index ; i<last ; i++ ) {
+      open_async( i ) ;
+    }
+    auto &file = *_files[index] ;
+    if( file._opened.wait_for( std::chrono::seconds(0) ) != std::future_status::ready ) {
+      // the background open is late
+      SIO_TRACE_SCOPE( "stall", "wait_open" ) ;
+      file._opened.wait() ;
+    }
+    // re-throws the exceptions from the background open
+    file._opened.get() ;
+    return file ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  chain_reader::chain_file &chain_reader::open( size_type index ) {
+    auto &file = wait_open( index ) ;
+    if( nullptr == file._reader ) {
+      // released after a previous read through
+      file._reader.reset( new pread_reader( file._fname ) ) ;
+    }
+    return file ;
+  }
+
+}
@@ -0,0 +1,159 @@
+#include <sio/compression/adaptive.h>
+// -- sio headers
+#include <sio/api.h>
+#include <sio/buffer.h>
+#include <sio/exception.h>
+#include <sio/compression/zlib.h>
+// -- std headers
+#include <algorithm>
+#include <chrono>
+
+
+namespace sio {
+
+  namespace {
+
+    /// The weight of a new observation in the averages
+    const double decay_weight = 0.2 ;
+
+    void average( double &value, double observed, bool first ) {
+      value = first ? observed : value + decay_weight * ( observed - value ) ;
+    }
+
+  }
+
+  //--------------------------------------------------------------------------
+
+  adaptive_compression::adaptive_compression( double max_ratio, const std::vector<int> &levels ) :
+    _max_ratio( max_ratio ),
+    _candidates( levels ) {
+    if( _candidates.empty() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "No candidate compression level" ) ;
+    }
+    if( _max_ratio <= 0. ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The maximum compression ratio must be positive" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void adaptive_compression::set_tolerance( double tolerance ) {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    _tolerance = std::max( tolerance, 0. ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void adaptive_compression::set_probing( size_type probe_records, size_type reprobe_interval ) {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    _probe_records = probe_records ;
+    _reprobe_interval = reprobe_interval ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool adaptive_compression::compress_record( record_info &rec_info, buffer &rec_buf, buffer &comp_buf ) {
+    const auto nlevels = _candidates.size() ;
+    size_type index = 0 ;
+    bool compress = true ;
+    {
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+      auto &state = _states[rec_info._name] ;
+      state._levels.resize( nlevels ) ;
+      const auto record = state._records ++ ;
+      if( record < nlevels * _probe_records ) {
+        // startup: try each level in turn
+        index = record % nlevels ;
+      }
+      else if( _reprobe_interval > 0 and 0 == record % _reprobe_interval ) {
+        // refresh the observations of the levels
+        index = state._next_probe ;
+        state._next_probe = ( state._next_probe + 1 ) % nlevels ;
+      }
+      else {
+        index = state._selected ;
+        const auto &selected = state._levels[index] ;
+        // the records of this name don't compress: don't even try
+        compress = ( 0 == selected._records or selected._ratio <= _max_ratio ) ;
+      }
+      if( not compress ) {
+        ++ state._raw ;
+      }
+    }
+    if( not compress ) {
+      sio::api::store_record( rec_info, rec_buf, comp_buf ) ;
+      return false ;
+    }
+    sio::zlib_compression compressor ;
+    compressor.set_level( _candidates[index] ) ;
+    const auto start = std::chrono::steady_clock::now() ;
+    sio::api::compress_record( rec_info, rec_buf, comp_buf, compressor ) ;
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start ;
+    const double uncompressed = std::max( rec_info._uncompressed_length, 1u ) ;
+    const double ratio = comp_buf.size() / uncompressed ;
+    const double throughput = uncompressed / sio::mbyte / std::max( elapsed.count(), 1e-9 ) ;
+    const bool compressed = ( ratio <= _max_ratio ) ;
+    if( not compressed ) {
+      sio::api::store_record( rec_info, rec_buf, comp_buf ) ;
+    }
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    auto &state = _states[rec_info._name] ;
+    auto &level = state._levels[index] ;
+    average( level._ratio, ratio, 0 == level._records ) ;
+    average( level._throughput, throughput, 0 == level._records ) ;
+    ++ level._records ;
+    if( compressed ) {
+      ++ state._compressed ;
+    }
+    else {
+      ++ state._raw ;
+    }
+    select_level( state ) ;
+    return compressed ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::map<std::string, adaptive_compression::statistics> adaptive_compression::stats() const {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    std::map<std::string, statistics> result ;
+    for( const auto &entry : _states ) {
+      const auto &state = entry.second ;
+      statistics st ;
+      st._level = _candidates[state._selected] ;
+      st._ratio = state._levels[state._selected]._ratio ;
+      st._throughput = state._levels[state._selected]._throughput ;
+      st._compressed = state._compressed ;
+      st._raw = state._raw ;
+      result.emplace( entry.first, st ) ;
+    }
+    return result ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void adaptive_compression::select_level( name_state &state ) const {
+    // the best ratio observed so far ...
+    double best_ratio = 0. ;
+    bool observed = false ;
+    for( const auto &level : state._levels ) {
+      if( level._records > 0 and ( not observed or level._ratio < best_ratio ) ) {
+        best_ratio = level._ratio ;
+        observed = true ;
+      }
+    }
+    if( not observed ) {
+      return ;
+    }
+    // ... and the fastest level reaching it
+    double best_throughput = -1. ;
+    for( size_type i=0 ; i<state._levels.size() ; i++ ) {
+      const auto &level = state._levels[i] ;
+      if( level._records > 0 and level._ratio <= best_ratio * ( 1. + _tolerance ) and level._throughput > best_throughput ) {
+        best_throughput = level._throughput ;
+        state._selected = i ;
+      }
+    }
+  }
+
+}
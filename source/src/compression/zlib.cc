@@ -3,6 +3,8 @@
 #include <sio/buffer.h>
 #include <sio/exception.h>
 #include <sio/definitions.h>
+#include <sio/perf_counters.h>
+#include <sio/trace.h>
 // -- zlib headers
 #include <zlib.h>
 #include <zconf.h>
@@ -33,6 +35,8 @@ namespace sio {
   //--------------------------------------------------------------------------
 
   void zlib_compression::uncompress( const buffer_span &inbuf, buffer &outbuf ) {
+    SIO_PERF_TIMER( uncompress ) ;
+    SIO_TRACE_SCOPE( "compression", "uncompress" ) ;
     if( not inbuf.valid() ) {
       SIO_THROW( sio::error_code::invalid_argument, "Buffer is not valid" ) ;
     }
@@ -50,6 +54,8 @@ namespace sio {
   //--------------------------------------------------------------------------
 
   void zlib_compression::compress( const buffer_span &inbuf, buffer &outbuf ) {
+    SIO_PERF_TIMER( compress ) ;
+    SIO_TRACE_SCOPE( "compression", "compress" ) ;
     if( not inbuf.valid() ) {
       SIO_THROW( sio::error_code::invalid_argument, "Buffer is not valid" ) ;
     }
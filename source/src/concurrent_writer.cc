@@ -0,0 +1,170 @@
+// -- sio headers
+#include <sio/concurrent_writer.h>
+#include <sio/exception.h>
+#include <sio/perf_counters.h>
+#include <sio/trace.h>
+
+// -- std headers
+#include <cerrno>
+#include <cstring>
+
+// -- posix headers
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+
+namespace sio {
+
+  concurrent_writer::concurrent_writer( const std::string &fname, bool write_index ) :
+    _fname( fname ),
+    _write_index( write_index ) {
+    _fd = ::open( fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 ) ;
+    if( _fd.load() < 0 ) {
+      SIO_THROW( sio::error_code::open_fail, "Couldn't open file '" + fname + "': " + std::strerror( errno ) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  concurrent_writer::~concurrent_writer() {
+    if( _fd.load() >= 0 ) {
+      try {
+        close() ;
+      }
+      catch( ... ) {
+        /* no throw in destructor */
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void concurrent_writer::write_record( const buffer_span &rec_buf, record_info &rec_info, std::uint64_t sequence ) {
+    if( not rec_buf.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The record buffer is not valid" ) ;
+    }
+    const auto padlen = (4 - (rec_buf.size() & sio::bit_align)) & sio::bit_align ;
+    write_pieces( &rec_buf, 1, padlen, rec_info, sequence ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void concurrent_writer::write_record( const buffer_span &hdr_span, const buffer_span &data_span, record_info &rec_info, std::uint64_t sequence ) {
+    if( not hdr_span.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The record header buffer is not valid" ) ;
+    }
+    if( not data_span.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The record data buffer is not valid" ) ;
+    }
+    const buffer_span pieces[2] = { hdr_span, data_span } ;
+    const auto padlen = (4 - (data_span.size() & sio::bit_align)) & sio::bit_align ;
+    write_pieces( pieces, 2, padlen, rec_info, sequence ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  concurrent_writer::size_type concurrent_writer::size() const {
+    return static_cast<size_type>( _offset.load() ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  concurrent_writer::size_type concurrent_writer::records() const {
+    std::lock_guard<std::mutex> lock( _index_mutex ) ;
+    return _index.size() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void concurrent_writer::close() {
+    const int fd = _fd.exchange( -1 ) ;
+    if( fd < 0 ) {
+      return ;
+    }
+    std::lock_guard<std::mutex> lock( _index_mutex ) ;
+    if( 0 != ::close( fd ) ) {
+      SIO_THROW( sio::error_code::io_failure, "Couldn't close file '" + _fname + "': " + std::strerror( errno ) ) ;
+    }
+    _index.sort() ;
+    if( _write_index ) {
+      _index.write( record_index::sidecar_name( _fname ) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  const record_index &concurrent_writer::index() const {
+    return _index ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::string &concurrent_writer::file_name() const {
+    return _fname ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void concurrent_writer::write_pieces( const buffer_span *pieces, size_type npieces, size_type padlen, record_info &rec_info, std::uint64_t sequence ) {
+    SIO_TRACE_RECORD_SCOPE( "io", "write_record", rec_info._name ) ;
+    const int fd = _fd.load() ;
+    if( fd < 0 ) {
+      SIO_THROW( sio::error_code::not_open, "The file '" + _fname + "' is closed" ) ;
+    }
+    struct iovec iov[3] ;
+    int niov = 0 ;
+    size_type total = padlen ;
+    for( size_type i=0 ; i<npieces ; i++ ) {
+      if( pieces[i].empty() ) {
+        continue ;
+      }
+      iov[niov].iov_base = const_cast<sio::byte*>( pieces[i].data() ) ;
+      iov[niov].iov_len = pieces[i].size() ;
+      total += pieces[i].size() ;
+      ++niov ;
+    }
+    if( padlen > 0 ) {
+      iov[niov].iov_base = const_cast<sio::byte*>( sio::padding_bytes ) ;
+      iov[niov].iov_len = padlen ;
+      ++niov ;
+    }
+    // reserve the byte range. No other thread will ever write in it
+    const auto start = _offset.fetch_add( total ) ;
+    rec_info._file_start = static_cast<std::streamoff>( start ) ;
+    rec_info._file_end = static_cast<std::streamoff>( start + total ) ;
+    auto offset = static_cast<off_t>( start ) ;
+    struct iovec *current = iov ;
+    while( niov > 0 ) {
+      const auto nwritten = ::pwritev( fd, current, niov, offset ) ;
+      if( nwritten < 0 ) {
+        if( errno == EINTR ) {
+          continue ;
+        }
+        SIO_THROW( sio::error_code::io_failure, "Couldn't write record in file '" + _fname + "': " + std::strerror( errno ) ) ;
+      }
+      // the pieces are never empty: no progress would loop forever
+      if( 0 == nwritten ) {
+        SIO_THROW( sio::error_code::io_failure, "Couldn't write record in file '" + _fname + "': no byte written" ) ;
+      }
+      // partial write: skip the written bytes and write the rest
+      offset += nwritten ;
+      auto remaining = static_cast<size_type>( nwritten ) ;
+      while( niov > 0 and remaining >= current->iov_len ) {
+        remaining -= current->iov_len ;
+        ++current ;
+        --niov ;
+      }
+      if( niov > 0 ) {
+        current->iov_base = static_cast<sio::byte*>( current->iov_base ) + remaining ;
+        current->iov_len -= remaining ;
+      }
+    }
+    SIO_PERF_COUNT( bytes_written, total ) ;
+    SIO_PERF_COUNT( records_written, 1 ) ;
+    SIO_DEBUG( "Written record with info :\n" << rec_info ) ;
+    std::lock_guard<std::mutex> lock( _index_mutex ) ;
+    _index.add( rec_info, sequence ) ;
+  }
+
+}
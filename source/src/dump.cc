@@ -0,0 +1,501 @@
+// -- sio headers
+#include <sio/dump.h>
+#include <sio/api.h>
+#include <sio/block_iterator.h>
+#include <sio/compression/zlib.h>
+#include <sio/exception.h>
+#include <sio/version.h>
+
+// -- std headers
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+
+namespace sio {
+
+  namespace {
+
+    /// The width of the dump tables
+    constexpr unsigned int tab_len = 117 ;
+    /// The maximum number of records per batch
+    constexpr std::size_t batch_records = 256 ;
+    /// The maximum number of bytes per batch
+    constexpr std::size_t batch_bytes = 64*sio::mbyte ;
+
+    /**
+     *  @brief  A minimal thread pool running a function over a range of
+     *          indices. The calling thread takes part in the work as worker 0
+     */
+    class worker_pool {
+    public:
+      using task = std::function<void( std::size_t index, std::size_t worker )> ;
+
+      worker_pool( unsigned int nthreads ) :
+        _nworkers( std::max( nthreads, 1u ) ) {
+        for( std::size_t w=1 ; w<_nworkers ; w++ ) {
+          _threads.emplace_back( &worker_pool::loop, this, w ) ;
+        }
+      }
+
+      worker_pool( const worker_pool& ) = delete ;
+      worker_pool& operator=( const worker_pool& ) = delete ;
+
+      ~worker_pool() {
+        {
+          std::lock_guard<std::mutex> lock( _mutex ) ;
+          _stop = true ;
+        }
+        _start_cond.notify_all() ;
+        for( auto &thread : _threads ) {
+          thread.join() ;
+        }
+      }
+
+      std::size_t size() const {
+        return _nworkers ;
+      }
+
+      /// Run func(i, worker) for i in [0, n) and wait for completion
+      void run( std::size_t n, const task &func ) {
+        {
+          std::lock_guard<std::mutex> lock( _mutex ) ;
+          _task = &func ;
+          _n = n ;
+          _next = 0 ;
+          _finished = 0 ;
+          _error = nullptr ;
+          ++ _generation ;
+        }
+        _start_cond.notify_all() ;
+        work( 0 ) ;
+        std::unique_lock<std::mutex> lock( _mutex ) ;
+        _done_cond.wait( lock, [this]{ return ( _finished + 1 == _nworkers ) ; } ) ;
+        _task = nullptr ;
+        if( _error ) {
+          std::rethrow_exception( _error ) ;
+        }
+      }
+
+    private:
+      void loop( std::size_t worker ) {
+        std::size_t generation = 0 ;
+        while( true ) {
+          {
+            std::unique_lock<std::mutex> lock( _mutex ) ;
+            _start_cond.wait( lock, [&]{ return ( _stop or _generation != generation ) ; } ) ;
+            if( _stop ) {
+              return ;
+            }
+            generation = _generation ;
+          }
+          work( worker ) ;
+          {
+            std::lock_guard<std::mutex> lock( _mutex ) ;
+            ++ _finished ;
+          }
+          _done_cond.notify_one() ;
+        }
+      }
+
+      void work( std::size_t worker ) {
+        while( true ) {
+          const auto index = _next.fetch_add( 1 ) ;
+          if( index >= _n ) {
+            return ;
+          }
+          try {
+            (*_task)( index, worker ) ;
+          }
+          catch( ... ) {
+            std::lock_guard<std::mutex> lock( _mutex ) ;
+            if( not _error ) {
+              _error = std::current_exception() ;
+            }
+          }
+        }
+      }
+
+    private:
+      const std::size_t             _nworkers ;
+      std::vector<std::thread>      _threads {} ;
+      const task                   *_task {nullptr} ;
+      std::size_t                   _n {0} ;
+      std::atomic<std::size_t>      _next {0} ;
+      std::size_t                   _finished {0} ;
+      std::size_t                   _generation {0} ;
+      std::exception_ptr            _error {} ;
+      bool                          _stop {false} ;
+      std::mutex                    _mutex {} ;
+      std::condition_variable       _start_cond {} ;
+      std::condition_variable       _done_cond {} ;
+    };
+
+    /**
+     *  @brief  A record read by the main thread and decoded by a worker
+     */
+    struct record_slot {
+      ///< The record info
+      record_info            _info {} ;
+      ///< The record bytes (header + data)
+      buffer                 _buffer {sio::kbyte} ;
+      ///< The formatted record dump
+      std::string            _text {} ;
+    };
+
+    /**
+     *  @brief  The per-thread decoding state
+     */
+    struct worker_state {
+      ///< The decompression object, reused for all records
+      sio::zlib_compression  _compressor {} ;
+      ///< The uncompressed record buffer
+      buffer                 _uncomp_buffer {sio::mbyte} ;
+      ///< The statistics collected by this thread
+      record_stats           _stats {} ;
+    };
+
+    /**
+     *  @brief  Get the uncompressed data of a record
+     */
+    buffer_span record_data( record_slot &slot, worker_state &state ) {
+      const auto &info = slot._info ;
+      const auto data = slot._buffer.span( info._header_length, info._data_length ) ;
+      if( not sio::api::is_compressed( info._options ) ) {
+        return data ;
+      }
+      state._uncomp_buffer.resize( info._uncompressed_length ) ;
+      state._compressor.uncompress( data, state._uncomp_buffer ) ;
+      return state._uncomp_buffer.span() ;
+    }
+
+    /**
+     *  @brief  Print the header line of the record or block table
+     */
+    void print_table_header( std::ostream &out, const char *name, const char *version ) {
+      out << std::string( tab_len, '-' ) << std::endl ;
+      out <<
+        std::setw(30) << std::left << name << " | " <<
+        std::setw(15) << "Start" << " | " <<
+        std::setw(15) << "End" << " | " <<
+        std::setw(12) << version << " | " <<
+        std::setw(10) << "Header len" << " | " <<
+        std::setw(15) << "Data len" <<
+        std::endl ;
+    }
+
+    /**
+     *  @brief  Print the table line of a record
+     */
+    void print_record_line( std::ostream &out, const record_info &rec_info ) {
+      std::stringstream size_str ;
+      size_str << rec_info._data_length << " (" << rec_info._uncompressed_length << ")" ;
+      out <<
+        std::setw(30) << std::left << rec_info._name << " | " <<
+        std::setw(15) << rec_info._file_start << " | " <<
+        std::setw(15) << rec_info._file_end << " | " <<
+        std::setw(12) << rec_info._options << " | " <<
+        std::setw(10) << rec_info._header_length << " | " <<
+        std::setw(15) << size_str.str() <<
+        std::endl ;
+    }
+
+    /**
+     *  @brief  Format the dump of a record
+     */
+    void format_record( record_slot &slot, worker_state &state, bool detailed ) {
+      const auto &rec_info = slot._info ;
+      std::ostringstream out ;
+      if( detailed ) {
+        print_table_header( out, "Record name ", "Options" ) ;
+      }
+      print_record_line( out, rec_info ) ;
+      if( not detailed ) {
+        slot._text = out.str() ;
+        return ;
+      }
+      print_table_header( out, "Block name ", "Version" ) ;
+      out << std::string( tab_len, '-' ) << std::endl ;
+      for( const auto &binfo : sio::block_range( record_data( slot, state ) ) ) {
+        std::stringstream version_str ;
+        version_str << sio::version::major_version( binfo._version ) << "." << sio::version::minor_version( binfo._version ) ;
+        std::stringstream block_size_str ;
+        block_size_str << binfo._data_length ;
+        if( binfo._flags & sio::block_compression_flag ) {
+          block_size_str << " (" << binfo._uncompressed_length << ")" ;
+        }
+        out <<
+          std::setw(30) << std::left << binfo._name.str() << " | " <<
+          std::setw(15) << binfo._record_start << " | " <<
+          std::setw(15) << binfo._record_end << " | " <<
+          std::setw(12) << version_str.str() << " | " <<
+          std::setw(10) << binfo._header_length << " | " <<
+          std::setw(15) << block_size_str.str() <<
+          std::endl ;
+      }
+      out << std::endl ;
+      slot._text = out.str() ;
+    }
+
+    /**
+     *  @brief  Read the records in batches and process each batch in parallel.
+     *          The output function is called on each batch in record order
+     */
+    void process_records( sio::ifstream &stream, std::size_t skip, std::size_t count, unsigned int nthreads,
+      const std::function<void( record_slot&, worker_state& )> &process,
+      const std::function<void( record_slot& )> &output,
+      std::vector<std::unique_ptr<worker_state>> &states ) {
+      worker_pool pool( nthreads ) ;
+      states.clear() ;
+      for( std::size_t w=0 ; w<pool.size() ; w++ ) {
+        states.emplace_back( new worker_state() ) ;
+      }
+      std::vector<record_slot> slots( batch_records ) ;
+      try {
+        if( skip > 0 ) {
+          sio::api::skip_n_records( stream, skip ) ;
+        }
+      }
+      catch( sio::exception &e ) {
+        if( e.code() == sio::error_code::eof ) {
+          return ;
+        }
+        throw ;
+      }
+      std::size_t nread = 0 ;
+      bool eof = false ;
+      const worker_pool::task task = [&]( std::size_t index, std::size_t worker ) {
+        process( slots[index], *states[worker] ) ;
+      } ;
+      while( not eof and nread < count ) {
+        // read out a batch of records
+        std::size_t nslots = 0 ;
+        std::size_t nbytes = 0 ;
+        while( nslots < slots.size() and nbytes < batch_bytes and nread < count ) {
+          try {
+            sio::api::read_record( stream, slots[nslots]._info, slots[nslots]._buffer ) ;
+          }
+          catch( sio::exception &e ) {
+            if( e.code() != sio::error_code::eof ) {
+              throw ;
+            }
+            eof = true ;
+            break ;
+          }
+          nbytes += slots[nslots]._buffer.size() ;
+          ++ nslots ;
+          ++ nread ;
+        }
+        pool.run( nslots, task ) ;
+        for( std::size_t i=0 ; i<nslots ; i++ ) {
+          output( slots[i] ) ;
+        }
+      }
+    }
+
+  }
+
+  //--------------------------------------------------------------------------
+
+  void size_stats::add( std::uint64_t size, std::uint64_t uncompressed_size ) {
+    _min = ( 0 == _count ) ? size : std::min( _min, size ) ;
+    _max = ( 0 == _count ) ? size : std::max( _max, size ) ;
+    ++ _count ;
+    _bytes += size ;
+    _uncompressed_bytes += uncompressed_size ;
+    std::size_t bin = 0 ;
+    while( bin+1 < nbins and ( size >> bin ) > 0 ) {
+      ++ bin ;
+    }
+    ++ _histogram[bin] ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void size_stats::merge( const size_stats &other ) {
+    if( 0 == other._count ) {
+      return ;
+    }
+    _min = ( 0 == _count ) ? other._min : std::min( _min, other._min ) ;
+    _max = ( 0 == _count ) ? other._max : std::max( _max, other._max ) ;
+    _count += other._count ;
+    _bytes += other._bytes ;
+    _uncompressed_bytes += other._uncompressed_bytes ;
+    for( std::size_t i=0 ; i<nbins ; i++ ) {
+      _histogram[i] += other._histogram[i] ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  double size_stats::ratio() const {
+    return ( 0 == _bytes ) ? 1. : static_cast<double>( _uncompressed_bytes ) / static_cast<double>( _bytes ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void record_stats::add_record( const record_info &rec_info, const buffer_span &data ) {
+    _records[rec_info._name].add( rec_info._data_length, rec_info._uncompressed_length ) ;
+    for( const auto &binfo : sio::block_range( data ) ) {
+      const auto len = binfo._record_end - binfo._record_start ;
+      auto uncompressed_len = len ;
+      if( binfo._flags & sio::block_compression_flag ) {
+        // the block is compressed on its own: count its inflated data size
+        uncompressed_len = len - binfo._data_length + binfo._uncompressed_length ;
+      }
+      _blocks[rec_info._name + "/" + binfo._name.str()].add( len, uncompressed_len ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void record_stats::merge( const record_stats &other ) {
+    for( const auto &entry : other._records ) {
+      _records[entry.first].merge( entry.second ) ;
+    }
+    for( const auto &entry : other._blocks ) {
+      _blocks[entry.first].merge( entry.second ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  const record_stats::stats_map &record_stats::records() const {
+    return _records ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const record_stats::stats_map &record_stats::blocks() const {
+    return _blocks ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void record_stats::print( std::ostream &out ) const {
+    auto print_table = [&]( const char *title, const stats_map &stats ) {
+      out << std::string( tab_len, '-' ) << std::endl ;
+      out <<
+        std::setw(40) << std::left << title << " | " <<
+        std::setw(9) << "Count" << " | " <<
+        std::setw(12) << "Bytes" << " | " <<
+        std::setw(12) << "Uncompressed" << " | " <<
+        std::setw(6) << "Ratio" << " | " <<
+        std::setw(7) << "Min" << " | " <<
+        std::setw(7) << "Mean" << " | " <<
+        std::setw(7) << "Max" <<
+        std::endl ;
+      out << std::string( tab_len, '-' ) << std::endl ;
+      for( const auto &entry : stats ) {
+        const auto &st = entry.second ;
+        std::stringstream ratio_str ;
+        ratio_str << std::fixed << std::setprecision(2) << st.ratio() ;
+        out <<
+          std::setw(40) << std::left << entry.first << " | " <<
+          std::setw(9) << st._count << " | " <<
+          std::setw(12) << st._bytes << " | " <<
+          std::setw(12) << st._uncompressed_bytes << " | " <<
+          std::setw(6) << ratio_str.str() << " | " <<
+          std::setw(7) << st._min << " | " <<
+          std::setw(7) << ( st._count > 0 ? st._bytes / st._count : 0 ) << " | " <<
+          std::setw(7) << st._max <<
+          std::endl ;
+      }
+    } ;
+    auto print_histograms = [&]( const stats_map &stats ) {
+      for( const auto &entry : stats ) {
+        out << entry.first << " :" ;
+        for( std::size_t i=0 ; i<size_stats::nbins ; i++ ) {
+          if( entry.second._histogram[i] > 0 ) {
+            const std::uint64_t low = ( i == 0 ) ? 0 : ( std::uint64_t(1) << (i-1) ) ;
+            out << " [" << low << "," << ( std::uint64_t(1) << i ) << "):" << entry.second._histogram[i] ;
+          }
+        }
+        out << std::endl ;
+      }
+    } ;
+    print_table( "Record name", _records ) ;
+    out << std::endl ;
+    print_table( "Block name (record/block)", _blocks ) ;
+    out << std::endl ;
+    out << std::string( tab_len, '-' ) << std::endl ;
+    out << "Size histograms (bytes in file)" << std::endl ;
+    out << std::string( tab_len, '-' ) << std::endl ;
+    print_histograms( _records ) ;
+    print_histograms( _blocks ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void dump::records( sio::ifstream &stream, std::size_t skip, std::size_t count, bool detailed, unsigned int nthreads, std::ostream &out ) {
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "ifstream is not open!" ) ;
+    }
+    if( not detailed ) {
+      print_table_header( out, "Record name ", "Options" ) ;
+      out << std::string( tab_len, '-' ) << std::endl ;
+      // nothing to decode: read the record headers only
+      try {
+        if( skip > 0 ) {
+          sio::api::skip_n_records( stream, skip ) ;
+        }
+        sio::record_info rec_info ;
+        sio::buffer info_buffer( sio::max_record_info_len ) ;
+        for( std::size_t i=0 ; i<count ; i++ ) {
+          sio::api::read_record_info( stream, rec_info, info_buffer ) ;
+          stream.seekg( rec_info._file_end ) ;
+          print_record_line( out, rec_info ) ;
+        }
+      }
+      catch( sio::exception &e ) {
+        if( e.code() != sio::error_code::eof ) {
+          throw ;
+        }
+      }
+      out << std::flush ;
+      return ;
+    }
+    std::vector<std::unique_ptr<worker_state>> states ;
+    process_records( stream, skip, count, nthreads,
+      []( record_slot &slot, worker_state &state ) {
+        format_record( slot, state, true ) ;
+      },
+      [&]( record_slot &slot ) {
+        out << slot._text ;
+      },
+      states ) ;
+    out << std::flush ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  record_stats dump::stats( sio::ifstream &stream, std::size_t skip, std::size_t count, unsigned int nthreads ) {
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "ifstream is not open!" ) ;
+    }
+    std::vector<std::unique_ptr<worker_state>> states ;
+    process_records( stream, skip, count, nthreads,
+      []( record_slot &slot, worker_state &state ) {
+        state._stats.add_record( slot._info, record_data( slot, state ) ) ;
+      },
+      []( record_slot& ) {
+        /* nop */
+      },
+      states ) ;
+    record_stats stats ;
+    for( const auto &state : states ) {
+      stats.merge( state->_stats ) ;
+    }
+    return stats ;
+  }
+
+}
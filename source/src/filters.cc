@@ -0,0 +1,253 @@
+// -- sio headers
+#include <sio/filters.h>
+#include <sio/buffer.h>
+#include <sio/exception.h>
+#include <sio/trace.h>
+
+// -- std headers
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace sio {
+
+  namespace {
+
+    bool valid_delta_size( std::size_t element_size ) {
+      return ( 1 == element_size or 2 == element_size or 4 == element_size or 8 == element_size ) ;
+    }
+
+    std::uint64_t load_element( const sio::byte *data, std::size_t element_size ) {
+      std::uint64_t value = 0 ;
+      for( std::size_t b=0 ; b<element_size ; b++ ) {
+        value = ( value << 8 ) | static_cast<std::uint8_t>( data[b] ) ;
+      }
+      return value ;
+    }
+
+    std::uint64_t mantissa_mask( std::size_t element_size, unsigned int mantissa_bits ) {
+      const unsigned int digits = ( 4 == element_size ) ? 23 : 52 ;
+      if( mantissa_bits >= digits ) {
+        return ~std::uint64_t(0) ;
+      }
+      return ~( ( std::uint64_t(1) << ( digits - mantissa_bits ) ) - 1 ) ;
+    }
+
+    void store_element( std::uint64_t value, sio::byte *data, std::size_t element_size ) {
+      for( std::size_t b=element_size ; b>0 ; b-- ) {
+        data[b-1] = static_cast<sio::byte>( value & 0xff ) ;
+        value >>= 8 ;
+      }
+    }
+
+  }
+
+  //--------------------------------------------------------------------------
+
+  unsigned int filters::flags( const block_filter &filter ) {
+    if( filter._element_size < 1 or filter._element_size > ( block_element_size_mask >> block_element_size_shift ) ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Invalid filter element size " + std::to_string( filter._element_size ) ) ;
+    }
+    if( filter._delta and not valid_delta_size( filter._element_size ) ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The delta filter requires an element size of 1, 2, 4 or 8 bytes" ) ;
+    }
+    unsigned int result = ( filter._element_size << block_element_size_shift ) ;
+    if( filter._shuffle ) {
+      result |= block_shuffle_flag ;
+    }
+    if( filter._delta ) {
+      result |= block_delta_flag ;
+    }
+    return result ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t filters::element_size( unsigned int flags ) {
+    return ( flags & block_element_size_mask ) >> block_element_size_shift ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void filters::apply( unsigned int flags, const buffer_span &data, buffer &outbuf ) {
+    SIO_TRACE_SCOPE( "compression", "filter" ) ;
+    const auto elt_size = element_size( flags ) ;
+    outbuf.resize( data.size() ) ;
+    if( 0 == ( flags & block_shuffle_flag ) ) {
+      std::copy( data.begin(), data.end(), outbuf.data() ) ;
+      if( flags & block_delta_flag ) {
+        delta_encode( outbuf.data(), outbuf.size(), elt_size ) ;
+      }
+      return ;
+    }
+    if( flags & block_delta_flag ) {
+      buffer delta_buf( sio::buffer::container( data.begin(), data.end() ) ) ;
+      delta_encode( delta_buf.data(), delta_buf.size(), elt_size ) ;
+      shuffle( delta_buf.data(), outbuf.data(), delta_buf.size(), elt_size ) ;
+    }
+    else {
+      shuffle( data.data(), outbuf.data(), data.size(), elt_size ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void filters::invert( unsigned int flags, buffer &data, buffer &workbuf ) {
+    SIO_TRACE_SCOPE( "compression", "unfilter" ) ;
+    const auto elt_size = element_size( flags ) ;
+    if( flags & block_shuffle_flag ) {
+      if( 0 == elt_size ) {
+        SIO_THROW( sio::error_code::bad_state, "Invalid filter element size in block flags" ) ;
+      }
+      workbuf.resize( data.size() ) ;
+      unshuffle( data.data(), workbuf.data(), data.size(), elt_size ) ;
+      std::swap( data, workbuf ) ;
+    }
+    if( flags & block_delta_flag ) {
+      if( not valid_delta_size( elt_size ) ) {
+        SIO_THROW( sio::error_code::bad_state, "Invalid delta element size in block flags" ) ;
+      }
+      delta_decode( data.data(), data.size(), elt_size ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void filters::shuffle( const sio::byte *const from, sio::byte *dest, std::size_t size, std::size_t element_size ) {
+    const auto nelements = size / element_size ;
+    std::size_t first = 0 ;
+#if defined(__SSE2__)
+    if( 4 == element_size ) {
+      // transpose 16 elements at once: 4 x 16 bytes in, 4 x 16 bytes out
+      for( ; first + 16 <= nelements ; first += 16 ) {
+        const auto in = from + first*4 ;
+        const __m128i r0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( in ) ) ;
+        const __m128i r1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( in + 16 ) ) ;
+        const __m128i r2 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( in + 32 ) ) ;
+        const __m128i r3 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( in + 48 ) ) ;
+        const __m128i t0 = _mm_unpacklo_epi8( r0, r1 ) ;
+        const __m128i t1 = _mm_unpackhi_epi8( r0, r1 ) ;
+        const __m128i t2 = _mm_unpacklo_epi8( r2, r3 ) ;
+        const __m128i t3 = _mm_unpackhi_epi8( r2, r3 ) ;
+        const __m128i u0 = _mm_unpacklo_epi8( t0, t1 ) ;
+        const __m128i u1 = _mm_unpackhi_epi8( t0, t1 ) ;
+        const __m128i u2 = _mm_unpacklo_epi8( t2, t3 ) ;
+        const __m128i u3 = _mm_unpackhi_epi8( t2, t3 ) ;
+        const __m128i v0 = _mm_unpacklo_epi8( u0, u1 ) ;
+        const __m128i v1 = _mm_unpackhi_epi8( u0, u1 ) ;
+        const __m128i v2 = _mm_unpacklo_epi8( u2, u3 ) ;
+        const __m128i v3 = _mm_unpackhi_epi8( u2, u3 ) ;
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dest + first ), _mm_unpacklo_epi64( v0, v2 ) ) ;
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dest + nelements + first ), _mm_unpackhi_epi64( v0, v2 ) ) ;
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dest + 2*nelements + first ), _mm_unpacklo_epi64( v1, v3 ) ) ;
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dest + 3*nelements + first ), _mm_unpackhi_epi64( v1, v3 ) ) ;
+      }
+    }
+#endif
+    for( std::size_t b=0 ; b<element_size ; b++ ) {
+      for( auto e=first ; e<nelements ; e++ ) {
+        dest[b*nelements + e] = from[e*element_size + b] ;
+      }
+    }
+    // the trailing bytes are left as is
+    std::copy( from + nelements*element_size, from + size, dest + nelements*element_size ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void filters::unshuffle( const sio::byte *const from, sio::byte *dest, std::size_t size, std::size_t element_size ) {
+    const auto nelements = size / element_size ;
+    std::size_t first = 0 ;
+#if defined(__SSE2__)
+    if( 4 == element_size ) {
+      for( ; first + 16 <= nelements ; first += 16 ) {
+        const __m128i o0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( from + first ) ) ;
+        const __m128i o1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( from + nelements + first ) ) ;
+        const __m128i o2 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( from + 2*nelements + first ) ) ;
+        const __m128i o3 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( from + 3*nelements + first ) ) ;
+        const __m128i x0 = _mm_unpacklo_epi8( o0, o1 ) ;
+        const __m128i x1 = _mm_unpackhi_epi8( o0, o1 ) ;
+        const __m128i y0 = _mm_unpacklo_epi8( o2, o3 ) ;
+        const __m128i y1 = _mm_unpackhi_epi8( o2, o3 ) ;
+        const auto out = dest + first*4 ;
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( out ), _mm_unpacklo_epi16( x0, y0 ) ) ;
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( out + 16 ), _mm_unpackhi_epi16( x0, y0 ) ) ;
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( out + 32 ), _mm_unpacklo_epi16( x1, y1 ) ) ;
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( out + 48 ), _mm_unpackhi_epi16( x1, y1 ) ) ;
+      }
+    }
+#endif
+    for( std::size_t b=0 ; b<element_size ; b++ ) {
+      for( auto e=first ; e<nelements ; e++ ) {
+        dest[e*element_size + b] = from[b*nelements + e] ;
+      }
+    }
+    std::copy( from + nelements*element_size, from + size, dest + nelements*element_size ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void filters::delta_encode( sio::byte *data, std::size_t size, std::size_t element_size ) {
+    if( not valid_delta_size( element_size ) ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The delta filter requires an element size of 1, 2, 4 or 8 bytes" ) ;
+    }
+    const auto nelements = size / element_size ;
+    std::uint64_t previous = 0 ;
+    for( std::size_t e=0 ; e<nelements ; e++ ) {
+      const auto ptr = data + e*element_size ;
+      const auto value = load_element( ptr, element_size ) ;
+      // the bytes above the element size are dropped on store
+      store_element( value - previous, ptr, element_size ) ;
+      previous = value ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void filters::delta_decode( sio::byte *data, std::size_t size, std::size_t element_size ) {
+    if( not valid_delta_size( element_size ) ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The delta filter requires an element size of 1, 2, 4 or 8 bytes" ) ;
+    }
+    const auto nelements = size / element_size ;
+    std::uint64_t previous = 0 ;
+    for( std::size_t e=0 ; e<nelements ; e++ ) {
+      const auto ptr = data + e*element_size ;
+      previous += load_element( ptr, element_size ) ;
+      store_element( previous, ptr, element_size ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void filters::truncate_mantissa( sio::byte *data, std::size_t count, std::size_t element_size, unsigned int mantissa_bits ) {
+    if( 4 != element_size and 8 != element_size ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The mantissa truncation requires an element size of 4 or 8 bytes" ) ;
+    }
+    const auto mask = mantissa_mask( element_size, mantissa_bits ) ;
+    if( ~std::uint64_t(0) == mask ) {
+      return ;
+    }
+    // the data is big endian: store the mask the same way, then the
+    // truncation is a plain bitwise and on the bytes
+    sio::byte mask_bytes[16] ;
+    for( std::size_t i=0 ; i<16 ; i += element_size ) {
+      store_element( mask, mask_bytes + i, element_size ) ;
+    }
+    const auto size = count * element_size ;
+    std::size_t pos = 0 ;
+#if defined(__SSE2__)
+    const __m128i vmask = _mm_loadu_si128( reinterpret_cast<const __m128i*>( mask_bytes ) ) ;
+    for( ; pos + 16 <= size ; pos += 16 ) {
+      const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + pos ) ) ;
+      _mm_storeu_si128( reinterpret_cast<__m128i*>( data + pos ), _mm_and_si128( chunk, vmask ) ) ;
+    }
+#endif
+    for( ; pos < size ; pos++ ) {
+      data[pos] &= mask_bytes[pos % 16] ;
+    }
+  }
+
+}
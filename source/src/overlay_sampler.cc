@@ -0,0 +1,259 @@
+// -- sio headers
+#include <sio/overlay_sampler.h>
+#include <sio/api.h>
+#include <sio/exception.h>
+#include <sio/trace.h>
+
+// -- std headers
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <utility>
+
+
+namespace sio {
+
+  namespace {
+
+    /// Records closer than this are read out with a single read call
+    const std::size_t coalesce_gap = 64*sio::kbyte ;
+    /// The maximum length of a coalesced read
+    const std::size_t max_read_length = 16*sio::mbyte ;
+
+  }
+
+  //--------------------------------------------------------------------------
+
+  overlay_sampler::overlay_sampler( const std::string &fname, const record_index &index, plan_type plan, size_type nthreads, size_type batch_events ) :
+    _index( index ),
+    _plan( std::move( plan ) ),
+    _batch_events( std::max( batch_events, size_type(1) ) ) {
+    for( const auto &event : _plan ) {
+      for( const auto entry : event ) {
+        if( entry >= _index.size() ) {
+          SIO_THROW( sio::error_code::out_of_range, "Sampling plan entry " + std::to_string( entry ) + " is out of the index range" ) ;
+        }
+        if( _index.at( entry )._file >= std::max( _index.files().size(), std::size_t(1) ) ) {
+          SIO_THROW( sio::error_code::out_of_range, "Index entry " + std::to_string( entry ) + " refers to an unknown file" ) ;
+        }
+      }
+    }
+    if( _index.files().empty() ) {
+      _readers.emplace_back( new pread_reader( fname ) ) ;
+    }
+    else {
+      // the file paths are resolved by record_index::read()
+      for( const auto &file : _index.files() ) {
+        _readers.emplace_back( new pread_reader( file ) ) ;
+      }
+    }
+    const auto nbatches = ( _plan.size() + _batch_events - 1 ) / _batch_events ;
+    const auto nworkers = std::min( std::max( nthreads, size_type(1) ), std::max( nbatches, size_type(1) ) ) ;
+    for( size_type i=0 ; i<nworkers ; i++ ) {
+      _workers.emplace_back( new worker() ) ;
+    }
+    for( size_type i=0 ; i<nworkers ; i++ ) {
+      _workers[i]->_thread = std::thread( &overlay_sampler::run, this, i ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  overlay_sampler::~overlay_sampler() {
+    stop() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool overlay_sampler::next_event( std::vector<record_ptr> &records ) {
+    if( _next_event >= _plan.size() ) {
+      return false ;
+    }
+    const auto number = _next_event / _batch_events ;
+    if( nullptr == _current or _current->_number != number ) {
+      auto &wk = *_workers[number % _workers.size()] ;
+      std::unique_lock<std::mutex> lock( wk._mutex ) ;
+      auto ready = [&]{
+        return ( nullptr != wk._ready or wk._error or wk._done ) ;
+      } ;
+      if( not ready() ) {
+        // the prefetch is late: the consumer is faster than the I/O
+        SIO_TRACE_SCOPE( "stall", "overlay_batch_wait" ) ;
+        wk._ready_cond.wait( lock, ready ) ;
+      }
+      if( nullptr == wk._ready ) {
+        if( wk._error ) {
+          std::rethrow_exception( wk._error ) ;
+        }
+        SIO_THROW( sio::error_code::bad_state, "The prefetch thread stopped before batch " + std::to_string( number ) ) ;
+      }
+      _current = std::move( wk._ready ) ;
+      lock.unlock() ;
+      wk._taken_cond.notify_one() ;
+    }
+    records = std::move( _current->_events[_next_event - number*_batch_events] ) ;
+    ++ _next_event ;
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  overlay_sampler::size_type overlay_sampler::events() const {
+    return _plan.size() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  overlay_sampler::statistics overlay_sampler::stats() const {
+    statistics st ;
+    st._records = _records.load() ;
+    st._reads = _reads.load() ;
+    st._bytes_read = _bytes_read.load() ;
+    return st ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  overlay_sampler::plan_type overlay_sampler::make_plan( size_type nentries, size_type nevents, size_type nbackground, std::uint64_t seed ) {
+    if( 0 == nentries and nbackground > 0 ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Can't sample background records from an empty index" ) ;
+    }
+    std::mt19937_64 generator( seed ) ;
+    std::uniform_int_distribution<size_type> distribution( 0, ( nentries > 0 ) ? nentries-1 : 0 ) ;
+    plan_type plan( nevents ) ;
+    for( auto &event : plan ) {
+      event.reserve( nbackground ) ;
+      for( size_type i=0 ; i<nbackground ; i++ ) {
+        event.push_back( distribution( generator ) ) ;
+      }
+    }
+    return plan ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void overlay_sampler::run( size_type index ) {
+    SIO_TRACE_THREAD_NAME( "sio overlay " + std::to_string( index ) ) ;
+    auto &wk = *_workers[index] ;
+    const auto nbatches = ( _plan.size() + _batch_events - 1 ) / _batch_events ;
+    for( auto number = index ; number < nbatches and not _stop ; number += _workers.size() ) {
+      std::unique_ptr<batch> bt ;
+      try {
+        bt = load_batch( number ) ;
+      }
+      catch( ... ) {
+        std::lock_guard<std::mutex> lock( wk._mutex ) ;
+        wk._error = std::current_exception() ;
+        break ;
+      }
+      std::unique_lock<std::mutex> lock( wk._mutex ) ;
+      wk._taken_cond.wait( lock, [&]{
+        return ( nullptr == wk._ready or _stop ) ;
+      }) ;
+      if( _stop ) {
+        break ;
+      }
+      wk._ready = std::move( bt ) ;
+      lock.unlock() ;
+      wk._ready_cond.notify_one() ;
+    }
+    std::unique_lock<std::mutex> lock( wk._mutex ) ;
+    wk._done = true ;
+    lock.unlock() ;
+    wk._ready_cond.notify_one() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::unique_ptr<overlay_sampler::batch> overlay_sampler::load_batch( size_type number ) {
+    SIO_TRACE_SCOPE( "io", "overlay_batch" ) ;
+    const auto first = number * _batch_events ;
+    const auto last = std::min( first + _batch_events, _plan.size() ) ;
+    // the distinct records of the batch, in file offset order
+    std::vector<size_type> entries ;
+    for( auto e=first ; e<last ; e++ ) {
+      entries.insert( entries.end(), _plan[e].begin(), _plan[e].end() ) ;
+    }
+    std::sort( entries.begin(), entries.end(), [this]( size_type lhs, size_type rhs ) {
+      const auto &l = _index.at( lhs ) ;
+      const auto &r = _index.at( rhs ) ;
+      return ( l._file != r._file ) ? ( l._file < r._file ) : ( l._position < r._position ) ;
+    }) ;
+    entries.erase( std::unique( entries.begin(), entries.end() ), entries.end() ) ;
+    // read out groups of neighbour records with a single read call
+    std::unordered_map<size_type, record_ptr> loaded ;
+    sio::buffer read_buffer( sio::kbyte ) ;
+    auto group_first = entries.begin() ;
+    while( group_first != entries.end() ) {
+      const auto &first_entry = _index.at( *group_first ) ;
+      const auto group_start = first_entry._position ;
+      auto group_end = group_start + first_entry._length ;
+      auto group_last = group_first + 1 ;
+      while( group_last != entries.end() ) {
+        const auto &ent = _index.at( *group_last ) ;
+        const auto end = std::max( group_end, ent._position + ent._length ) ;
+        if( ent._file != first_entry._file or ent._position > group_end + coalesce_gap or end - group_start > max_read_length ) {
+          break ;
+        }
+        group_end = end ;
+        ++ group_last ;
+      }
+      const auto length = static_cast<size_type>( group_end - group_start ) ;
+      read_buffer.resize( length ) ;
+      {
+        SIO_TRACE_SCOPE( "io", "overlay_read" ) ;
+        if( _readers[first_entry._file]->read_bytes( read_buffer.data(), group_start, length ) < length ) {
+          SIO_THROW( sio::error_code::io_failure, "Reached end of file while reading the background records!" ) ;
+        }
+      }
+      ++ _reads ;
+      _bytes_read += length ;
+      // uncompress the records of the group
+      for( auto iter = group_first ; iter != group_last ; ++iter ) {
+        const auto &ent = _index.at( *iter ) ;
+        const auto offset = static_cast<size_type>( ent._position - group_start ) ;
+        record_info_view view ;
+        view._file_start = static_cast<std::streamoff>( ent._position ) ;
+        sio::api::read_record_info( read_buffer.span( offset, static_cast<size_type>( ent._length ) ), view ) ;
+        if( static_cast<std::uint64_t>( view._header_length ) + view._data_length > ent._length ) {
+          SIO_THROW( sio::error_code::bad_state, "Record at position " + std::to_string( ent._position ) + " doesn't match the index entry" ) ;
+        }
+        auto rec = std::make_shared<record_cache::record>() ;
+        record_cache::unpack_record( view.to_info(), read_buffer.span( offset + view._header_length, view._data_length ), *rec ) ;
+        loaded.emplace( *iter, std::move( rec ) ) ;
+        ++ _records ;
+      }
+      group_first = group_last ;
+    }
+    // hand out the records in the plan order
+    std::unique_ptr<batch> bt( new batch() ) ;
+    bt->_number = number ;
+    bt->_events.resize( last - first ) ;
+    for( auto e=first ; e<last ; e++ ) {
+      auto &records = bt->_events[e - first] ;
+      records.reserve( _plan[e].size() ) ;
+      for( const auto entry : _plan[e] ) {
+        records.push_back( loaded[entry] ) ;
+      }
+    }
+    return bt ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void overlay_sampler::stop() {
+    _stop = true ;
+    for( auto &wk : _workers ) {
+      {
+        std::lock_guard<std::mutex> lock( wk->_mutex ) ;
+      }
+      wk->_taken_cond.notify_all() ;
+    }
+    for( auto &wk : _workers ) {
+      if( wk->_thread.joinable() ) {
+        wk->_thread.join() ;
+      }
+    }
+  }
+
+}
@@ -0,0 +1,287 @@
+// -- sio headers
+#include <sio/perf_counters.h>
+
+// -- std headers
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+
+
+namespace sio {
+
+  namespace {
+
+    /**
+     *  @brief  The counters of a thread. The padding keeps the
+     *          slots of different threads on different cache lines
+     */
+    struct thread_slot {
+      ///< Padding against false sharing
+      char                                                     _front_padding[64] {} ;
+      ///< The counter values
+      std::array<std::atomic<std::uint64_t>, perf::ncounters>  _counters {} ;
+      ///< The number of timed calls
+      std::array<std::atomic<std::uint64_t>, perf::ntimers>    _calls {} ;
+      ///< The timed durations (nanoseconds)
+      std::array<std::atomic<std::uint64_t>, perf::ntimers>    _nanoseconds {} ;
+      ///< Whether a running thread owns the slot
+      std::atomic<bool>                                        _in_use {false} ;
+      ///< The next slot in the list (set before publication)
+      thread_slot                                             *_next {nullptr} ;
+      ///< Padding against false sharing
+      char                                                     _back_padding[64] {} ;
+    };
+
+    /// The head of the list of slots. The slots are never freed
+    std::atomic<thread_slot*> slots_head {nullptr} ;
+    /// The number of slots
+    std::atomic<std::size_t> slots_count {0} ;
+
+    /**
+     *  @brief  Get a free slot or allocate a new one
+     */
+    thread_slot *acquire_slot() {
+      for( auto slot = slots_head.load( std::memory_order_acquire ) ; nullptr != slot ; slot = slot->_next ) {
+        bool expected = false ;
+        if( not slot->_in_use.load( std::memory_order_relaxed ) and
+            slot->_in_use.compare_exchange_strong( expected, true, std::memory_order_acquire ) ) {
+          return slot ;
+        }
+      }
+      auto slot = new thread_slot() ;
+      slot->_in_use.store( true, std::memory_order_relaxed ) ;
+      slot->_next = slots_head.load( std::memory_order_relaxed ) ;
+      while( not slots_head.compare_exchange_weak( slot->_next, slot, std::memory_order_release, std::memory_order_relaxed ) ) {
+        /* retry with the new head */
+      }
+      ++ slots_count ;
+      return slot ;
+    }
+
+    /**
+     *  @brief  Owns the slot of a thread, released at thread exit
+     */
+    struct slot_holder {
+      slot_holder() = default ;
+      slot_holder( const slot_holder& ) = delete ;
+      slot_holder& operator=( const slot_holder& ) = delete ;
+      ~slot_holder() {
+        if( nullptr != _slot ) {
+          _slot->_in_use.store( false, std::memory_order_release ) ;
+        }
+      }
+      ///< The slot of the thread
+      thread_slot         *_slot {nullptr} ;
+    };
+
+    thread_slot &local_slot() {
+      static thread_local slot_holder holder ;
+      if( nullptr == holder._slot ) {
+        holder._slot = acquire_slot() ;
+      }
+      return *holder._slot ;
+    }
+
+    /**
+     *  @brief  Print the counters at exit, on request
+     */
+    class exit_dump {
+    public:
+      exit_dump() = default ;
+      exit_dump( const exit_dump& ) = delete ;
+      exit_dump& operator=( const exit_dump& ) = delete ;
+
+      ~exit_dump() {
+        std::lock_guard<std::mutex> lock( _mutex ) ;
+        if( not _requested ) {
+          return ;
+        }
+        const auto snap = perf::collect() ;
+        if( _fname.empty() ) {
+          snap.print( std::cerr ) ;
+          return ;
+        }
+        std::ofstream out( _fname ) ;
+        snap.print( out ) ;
+      }
+
+      void request( const std::string &fname ) {
+        std::lock_guard<std::mutex> lock( _mutex ) ;
+        _requested = true ;
+        _fname = fname ;
+      }
+
+    private:
+      ///< Whether the dump is requested
+      bool                 _requested {false} ;
+      ///< The output file name (empty: standard error)
+      std::string          _fname {} ;
+      ///< The request mutex
+      std::mutex           _mutex {} ;
+    };
+
+    exit_dump &exit_dumper() {
+      static exit_dump dumper ;
+      return dumper ;
+    }
+
+    /// Request the exit dump from the SIO_PERF_DUMP environment variable
+    bool dump_from_environment() {
+      const char *env = std::getenv( "SIO_PERF_DUMP" ) ;
+      if( nullptr == env or std::string( env ).empty() or std::string( env ) == "0" ) {
+        return false ;
+      }
+      const std::string value( env ) ;
+      exit_dumper().request( ( value == "1" ) ? "" : value ) ;
+      return true ;
+    }
+
+    const bool dump_requested_from_environment = dump_from_environment() ;
+
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::uint64_t perf::snapshot::value( counter cnt ) const {
+    return _counters[static_cast<std::size_t>( cnt )] ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::uint64_t perf::snapshot::calls( timer tmr ) const {
+    return _calls[static_cast<std::size_t>( tmr )] ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  double perf::snapshot::seconds( timer tmr ) const {
+    return _nanoseconds[static_cast<std::size_t>( tmr )] * 1e-9 ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void perf::snapshot::print( std::ostream &out ) const {
+    const unsigned int tab_len = 80 ;
+    out << std::string( tab_len, '-' ) << std::endl ;
+    out << "SIO performance counters (" << _threads << " thread slots"
+        << ( perf::enabled() ? "" : ", counters not compiled in" ) << ")" << std::endl ;
+    out << std::string( tab_len, '-' ) << std::endl ;
+    out << std::setw(30) << std::left << "Counter" << " | " << "Value" << std::endl ;
+    out << std::string( tab_len, '-' ) << std::endl ;
+    for( std::size_t i=0 ; i<ncounters ; i++ ) {
+      out << std::setw(30) << std::left << perf::name( static_cast<counter>( i ) ) << " | " << _counters[i] << std::endl ;
+    }
+    out << std::string( tab_len, '-' ) << std::endl ;
+    out <<
+      std::setw(30) << std::left << "Timer" << " | " <<
+      std::setw(12) << "Calls" << " | " <<
+      std::setw(12) << "Total (s)" << " | " <<
+      "Mean (us)" << std::endl ;
+    out << std::string( tab_len, '-' ) << std::endl ;
+    for( std::size_t i=0 ; i<ntimers ; i++ ) {
+      const auto tmr = static_cast<timer>( i ) ;
+      out <<
+        std::setw(30) << std::left << perf::name( tmr ) << " | " <<
+        std::setw(12) << _calls[i] << " | " <<
+        std::setw(12) << std::fixed << std::setprecision(6) << seconds( tmr ) << " | " <<
+        std::setprecision(3) << ( _calls[i] > 0 ? 1e-3 * _nanoseconds[i] / _calls[i] : 0. ) <<
+        std::defaultfloat << std::endl ;
+    }
+    out << std::string( tab_len, '-' ) << std::endl ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool perf::enabled() {
+#ifdef SIO_PERF_COUNTERS
+    return true ;
+#else
+    return false ;
+#endif
+  }
+
+  //--------------------------------------------------------------------------
+
+  void perf::add( counter cnt, std::uint64_t value ) {
+    local_slot()._counters[static_cast<std::size_t>( cnt )].fetch_add( value, std::memory_order_relaxed ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void perf::add_time( timer tmr, std::uint64_t nanoseconds ) {
+    auto &slot = local_slot() ;
+    const auto index = static_cast<std::size_t>( tmr ) ;
+    slot._calls[index].fetch_add( 1, std::memory_order_relaxed ) ;
+    slot._nanoseconds[index].fetch_add( nanoseconds, std::memory_order_relaxed ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  perf::snapshot perf::collect() {
+    snapshot snap ;
+    for( auto slot = slots_head.load( std::memory_order_acquire ) ; nullptr != slot ; slot = slot->_next ) {
+      for( std::size_t i=0 ; i<ncounters ; i++ ) {
+        snap._counters[i] += slot->_counters[i].load( std::memory_order_relaxed ) ;
+      }
+      for( std::size_t i=0 ; i<ntimers ; i++ ) {
+        snap._calls[i] += slot->_calls[i].load( std::memory_order_relaxed ) ;
+        snap._nanoseconds[i] += slot->_nanoseconds[i].load( std::memory_order_relaxed ) ;
+      }
+    }
+    snap._threads = slots_count.load() ;
+    return snap ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void perf::reset() {
+    for( auto slot = slots_head.load( std::memory_order_acquire ) ; nullptr != slot ; slot = slot->_next ) {
+      for( auto &value : slot->_counters ) {
+        value.store( 0, std::memory_order_relaxed ) ;
+      }
+      for( std::size_t i=0 ; i<ntimers ; i++ ) {
+        slot->_calls[i].store( 0, std::memory_order_relaxed ) ;
+        slot->_nanoseconds[i].store( 0, std::memory_order_relaxed ) ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void perf::dump_at_exit( const std::string &fname ) {
+    exit_dumper().request( fname ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const char *perf::name( counter cnt ) {
+    switch( cnt ) {
+      case counter::bytes_read: return "bytes_read" ;
+      case counter::bytes_written: return "bytes_written" ;
+      case counter::records_read: return "records_read" ;
+      case counter::records_written: return "records_written" ;
+      case counter::blocks_read: return "blocks_read" ;
+      case counter::blocks_written: return "blocks_written" ;
+      case counter::buffer_reallocations: return "buffer_reallocations" ;
+      default: return "unknown" ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  const char *perf::name( timer tmr ) {
+    switch( tmr ) {
+      case timer::read_record_data: return "read_record_data" ;
+      case timer::compress: return "compress" ;
+      case timer::uncompress: return "uncompress" ;
+      case timer::read_blocks: return "read_blocks" ;
+      case timer::write_blocks: return "write_blocks" ;
+      case timer::read_relocation: return "read_relocation" ;
+      case timer::write_relocation: return "write_relocation" ;
+      default: return "unknown" ;
+    }
+  }
+
+}
@@ -0,0 +1,131 @@
+// -- sio headers
+#include <sio/pread_reader.h>
+#include <sio/api.h>
+#include <sio/exception.h>
+#include <sio/definitions.h>
+#include <sio/perf_counters.h>
+#include <sio/trace.h>
+
+// -- std headers
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+// -- posix headers
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace sio {
+
+  pread_reader::pread_reader( const std::string &fname ) :
+    _fname( fname ) {
+    _fd = ::open( fname.c_str(), O_RDONLY | O_CLOEXEC ) ;
+    if( _fd < 0 ) {
+      SIO_THROW( sio::error_code::open_fail, "Couldn't open file '" + fname + "': " + std::strerror( errno ) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  pread_reader::~pread_reader() {
+    if( _fd >= 0 ) {
+      ::close( _fd ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  pread_reader::size_type pread_reader::file_size() const {
+    struct stat st ;
+    if( 0 != ::fstat( _fd, &st ) ) {
+      SIO_THROW( sio::error_code::io_failure, "Couldn't stat file '" + _fname + "': " + std::strerror( errno ) ) ;
+    }
+    return static_cast<size_type>( st.st_size ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::string &pread_reader::file_name() const {
+    return _fname ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void pread_reader::read_record_info( pos_type pos, record_info &rec_info, buffer &outbuf ) const {
+    const auto offset = static_cast<size_type>( static_cast<std::streamoff>( pos ) ) ;
+    outbuf.resize( sio::max_record_info_len ) ;
+    const auto nread = read_bytes( outbuf.data(), offset, sio::max_record_info_len ) ;
+    if( nread < 8 ) {
+      SIO_THROW( sio::error_code::eof, "Reached end of file !" ) ;
+    }
+    record_info_view view ;
+    view._file_start = pos ;
+    sio::api::read_record_info( outbuf.span( 0, nread ), view ) ;
+    rec_info = view.to_info() ;
+    outbuf.resize( rec_info._header_length ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void pread_reader::read_record_data( const record_info &rec_info, buffer &outbuf, size_type buffer_shift ) const {
+    SIO_PERF_TIMER( read_record_data ) ;
+    SIO_TRACE_RECORD_SCOPE( "io", "read_record_data", rec_info._name ) ;
+    outbuf.resize( buffer_shift + rec_info._data_length ) ;
+    const auto offset = static_cast<size_type>( static_cast<std::streamoff>( rec_info._file_start ) ) + rec_info._header_length ;
+    if( read_bytes( outbuf.ptr( buffer_shift ), offset, rec_info._data_length ) < rec_info._data_length ) {
+      SIO_THROW( sio::error_code::io_failure, "Reached end of file while reading the record data!" ) ;
+    }
+    SIO_PERF_COUNT( records_read, 1 ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void pread_reader::read_record( pos_type pos, record_info &rec_info, buffer &outbuf ) const {
+    SIO_TRACE_SCOPE( "io", "read_record" ) ;
+    const auto offset = static_cast<size_type>( static_cast<std::streamoff>( pos ) ) ;
+    // read the header and, opportunistically, the beginning of the record data.
+    // Not sized on the buffer: a large reused buffer would make every read large
+    const size_type first_read = sio::max_record_info_len + read_ahead ;
+    outbuf.resize( first_read ) ;
+    const auto nread = read_bytes( outbuf.data(), offset, first_read ) ;
+    if( nread < 8 ) {
+      SIO_THROW( sio::error_code::eof, "Reached end of file !" ) ;
+    }
+    record_info_view view ;
+    view._file_start = pos ;
+    sio::api::read_record_info( outbuf.span( 0, nread ), view ) ;
+    rec_info = view.to_info() ;
+    const auto len = static_cast<size_type>( rec_info._header_length ) + rec_info._data_length ;
+    outbuf.resize( len ) ;
+    if( nread < len ) {
+      if( read_bytes( outbuf.ptr( nread ), offset + nread, len - nread ) < len - nread ) {
+        SIO_THROW( sio::error_code::io_failure, "Reached end of file while reading the record data!" ) ;
+      }
+    }
+    SIO_PERF_COUNT( records_read, 1 ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  pread_reader::size_type pread_reader::read_bytes( sio::byte *dest, size_type offset, size_type length ) const {
+    size_type done = 0 ;
+    while( done < length ) {
+      const auto ret = ::pread( _fd, dest + done, length - done, static_cast<off_t>( offset + done ) ) ;
+      if( ret < 0 ) {
+        if( EINTR == errno ) {
+          continue ;
+        }
+        SIO_THROW( sio::error_code::io_failure, "Couldn't read from file '" + _fname + "': " + std::strerror( errno ) ) ;
+      }
+      if( 0 == ret ) {
+        break ;
+      }
+      done += static_cast<size_type>( ret ) ;
+    }
+    SIO_PERF_COUNT( bytes_read, done ) ;
+    return done ;
+  }
+
+}
@@ -0,0 +1,205 @@
+// -- sio headers
+#include <sio/prefetch_reader.h>
+#include <sio/exception.h>
+#include <sio/definitions.h>
+#include <sio/trace.h>
+
+// -- std headers
+#include <algorithm>
+#include <utility>
+
+
+namespace sio {
+
+  prefetch_reader::prefetch_reader( sio::ifstream &stream, size_type max_records, size_type max_bytes ) :
+    _reader( stream ),
+    _max_records( std::max( max_records, size_type(1) ) ),
+    _max_bytes( max_bytes ) {
+    _depth = std::min( _depth, _max_records ) ;
+    _thread = std::thread( &prefetch_reader::run, this ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  prefetch_reader::~prefetch_reader() {
+    {
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+      _stop = true ;
+    }
+    _producer_cond.notify_one() ;
+    if( _thread.joinable() ) {
+      _thread.join() ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool prefetch_reader::read_next_record( record_info &rec_info, buffer &outbuf ) {
+    std::unique_lock<std::mutex> lock( _mutex ) ;
+    if( _queue.empty() and not _eof and not _error ) {
+      // the consumer is faster than the read-ahead: prefetch deeper
+      ++ _consumer_waits ;
+      _full_streak = 0 ;
+      _depth = std::min( 2*_depth, _max_records ) ;
+      _producer_cond.notify_one() ;
+      SIO_TRACE_SCOPE( "stall", "prefetch_queue_empty" ) ;
+      _consumer_cond.wait( lock, [this]{
+        return ( not _queue.empty() or _eof or _error ) ;
+      }) ;
+    }
+    else if( _queue.size() >= _depth ) {
+      // the queue stays full: the consumer is slower, prefetch less
+      if( ++ _full_streak >= 2*_depth ) {
+        _depth = std::max( _depth-1, size_type(1) ) ;
+        _full_streak = 0 ;
+      }
+    }
+    if( not _queue.empty() ) {
+      auto &front = _queue.front() ;
+      rec_info = std::move( front._info ) ;
+      buffer previous( std::move( outbuf ) ) ;
+      outbuf = std::move( front._buffer ) ;
+      _queued_bytes -= outbuf.size() ;
+      if( previous.valid() and previous.capacity() > 0 and _pool.size() <= _max_records ) {
+        _pool.push_back( std::move( previous ) ) ;
+      }
+      _queue.pop_front() ;
+      lock.unlock() ;
+      _producer_cond.notify_one() ;
+      return true ;
+    }
+    if( _error ) {
+      std::rethrow_exception( _error ) ;
+    }
+    // end of stream
+    return false ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void prefetch_reader::seek( pos_type pos ) {
+    {
+      std::lock_guard<std::mutex> lock( _mutex ) ;
+      ++ _generation ;
+      clear_queue() ;
+      _eof = false ;
+      _error = nullptr ;
+      _seek_pos = pos ;
+      _seek_requested = true ;
+    }
+    _producer_cond.notify_one() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  prefetch_reader::size_type prefetch_reader::depth() const {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    return _depth ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  prefetch_reader::size_type prefetch_reader::consumer_waits() const {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    return _consumer_waits ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void prefetch_reader::run() {
+    SIO_TRACE_THREAD_NAME( "sio prefetch" ) ;
+    std::unique_lock<std::mutex> lock( _mutex ) ;
+    auto ready = [this]{
+      return ( _stop or _seek_requested or ( not _eof and not _error and has_room() ) ) ;
+    } ;
+    while( 1 ) {
+      if( not ready() and not _eof and not _error ) {
+        // the queue is full: the consumer is the bottleneck
+        SIO_TRACE_SCOPE( "stall", "prefetch_queue_full" ) ;
+        _producer_cond.wait( lock, ready ) ;
+      }
+      else {
+        _producer_cond.wait( lock, ready ) ;
+      }
+      if( _stop ) {
+        break ;
+      }
+      if( _seek_requested ) {
+        // no I/O here, the reader only moves on next read
+        _reader.seek( _seek_pos ) ;
+        _seek_requested = false ;
+        continue ;
+      }
+      const auto generation = _generation ;
+      auto buf = take_buffer() ;
+      record_info info ;
+      bool eof = false ;
+      std::exception_ptr error {} ;
+      // read out the next record without holding the lock
+      lock.unlock() ;
+      try {
+        SIO_TRACE_RECORD_SCOPE( "io", "prefetch_record", info._name ) ;
+        _reader.read_record_info( info ) ;
+        auto rec_span = _reader.read_record() ;
+        buf.resize( rec_span.size() ) ;
+        std::copy( rec_span.begin(), rec_span.end(), buf.begin() ) ;
+      }
+      catch( sio::exception &e ) {
+        if( e.code() == sio::error_code::eof ) {
+          eof = true ;
+        }
+        else {
+          error = std::current_exception() ;
+        }
+      }
+      catch( ... ) {
+        error = std::current_exception() ;
+      }
+      lock.lock() ;
+      // a seek happened in the meantime: drop the record
+      if( generation != _generation or eof or error ) {
+        _pool.push_back( std::move( buf ) ) ;
+        if( generation == _generation ) {
+          _eof = eof ;
+          _error = error ;
+          _consumer_cond.notify_one() ;
+        }
+        continue ;
+      }
+      _queued_bytes += buf.size() ;
+      _queue.emplace_back( std::move( info ), std::move( buf ) ) ;
+      _consumer_cond.notify_one() ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool prefetch_reader::has_room() const {
+    if( _queue.empty() ) {
+      return true ;
+    }
+    return ( _queue.size() < _depth ) and ( _queued_bytes < _max_bytes ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  buffer prefetch_reader::take_buffer() {
+    if( _pool.empty() ) {
+      return buffer( sio::kbyte ) ;
+    }
+    buffer buf( std::move( _pool.back() ) ) ;
+    _pool.pop_back() ;
+    return buf ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void prefetch_reader::clear_queue() {
+    for( auto &e : _queue ) {
+      _pool.push_back( std::move( e._buffer ) ) ;
+    }
+    _queue.clear() ;
+    _queued_bytes = 0 ;
+  }
+
+}
@@ -0,0 +1,128 @@
+// -- sio headers
+#include <sio/range_reader.h>
+#include <sio/api.h>
+#include <sio/exception.h>
+
+// -- std headers
+#include <algorithm>
+
+
+namespace sio {
+
+  range_reader::range_reader( const pread_reader &reader, size_type begin, size_type end ) :
+    _reader( reader ),
+    _file_size( reader.file_size() ),
+    _begin( begin ),
+    _end( std::min( end, _file_size ) ) {
+    /* nop */
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::vector<range_reader::size_type> range_reader::split( size_type file_size, size_type nranges ) {
+    nranges = std::max( nranges, size_type(1) ) ;
+    std::vector<size_type> bounds ;
+    bounds.reserve( nranges + 1 ) ;
+    for( size_type i=0 ; i<nranges ; i++ ) {
+      bounds.push_back( ( file_size / nranges ) * i + std::min( i, file_size % nranges ) ) ;
+    }
+    bounds.push_back( file_size ) ;
+    return bounds ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  range_reader::size_type range_reader::first_record() {
+    if( _synced ) {
+      return _first ;
+    }
+    _synced = true ;
+    _first = _next = _end ;
+    // the records start on 4 bytes boundaries
+    const size_type aligned_begin = ( _begin + sio::bit_align ) & sio::padding_mask ;
+    if( aligned_begin >= _end ) {
+      return _first ;
+    }
+    buffer scan_buf( scan_block_size ) ;
+    buffer hdr_buf( sio::max_record_info_len ) ;
+    // the marker is 4 bytes after the record start
+    size_type block_start = aligned_begin + 4 ;
+    while( block_start < _file_size ) {
+      const auto nread = _reader.read_bytes( scan_buf.data(), block_start, scan_block_size ) ;
+      if( 0 == nread ) {
+        break ;
+      }
+      const auto span = scan_buf.span( 0, nread ) ;
+      size_type offset = 0 ;
+      while( true ) {
+        offset = sio::api::find_record_marker( span, offset ) ;
+        if( offset + 4 > nread ) {
+          break ;
+        }
+        const auto candidate = block_start + offset - 4 ;
+        if( candidate >= _end ) {
+          _scanned = candidate - aligned_begin ;
+          return _first ;
+        }
+        if( valid_record( candidate, hdr_buf ) ) {
+          _scanned = candidate - aligned_begin ;
+          _first = _next = candidate ;
+          return _first ;
+        }
+        offset += 4 ;
+      }
+      // an aligned marker never crosses the (aligned) block boundaries
+      if( nread < scan_block_size ) {
+        break ;
+      }
+      block_start += nread ;
+    }
+    _scanned = _end - aligned_begin ;
+    return _first ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool range_reader::read_next_record( record_info &rec_info, buffer &outbuf ) {
+    first_record() ;
+    if( _next >= _end ) {
+      return false ;
+    }
+    _reader.read_record( static_cast<std::streamoff>( _next ), rec_info, outbuf ) ;
+    _next = static_cast<size_type>( static_cast<std::streamoff>( rec_info._file_end ) ) ;
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  range_reader::size_type range_reader::scanned_bytes() const {
+    return _scanned ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool range_reader::valid_record( size_type pos, buffer &hdr_buf ) const {
+    // check this record and the next one (or the end of file)
+    for( unsigned int i=0 ; i<2 ; i++ ) {
+      if( i > 0 and pos == _file_size ) {
+        return true ;
+      }
+      const auto nread = _reader.read_bytes( hdr_buf.data(), pos, sio::max_record_info_len ) ;
+      if( nread < 8 ) {
+        return false ;
+      }
+      record_info_view rec_info ;
+      rec_info._file_start = static_cast<std::streamoff>( pos ) ;
+      if( not sio::api::validate_record_info( hdr_buf.span( 0, nread ), rec_info ) ) {
+        return false ;
+      }
+      const auto end = static_cast<size_type>( static_cast<std::streamoff>( rec_info._file_end ) ) ;
+      if( end > _file_size ) {
+        return false ;
+      }
+      pos = end ;
+    }
+    return true ;
+  }
+
+}
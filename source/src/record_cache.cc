@@ -0,0 +1,166 @@
+// -- sio headers
+#include <sio/record_cache.h>
+#include <sio/api.h>
+#include <sio/compression/zlib.h>
+#include <sio/exception.h>
+#include <sio/pread_reader.h>
+#include <sio/trace.h>
+
+// -- std headers
+#include <exception>
+
+
+namespace sio {
+
+  namespace {
+
+    std::uint64_t key_position( record_cache::pos_type pos ) {
+      return static_cast<std::uint64_t>( static_cast<std::streamoff>( pos ) ) ;
+    }
+
+  }
+
+  //--------------------------------------------------------------------------
+
+  double record_cache::statistics::hit_rate() const {
+    const auto requests = _hits + _misses + _shared_loads ;
+    return ( requests > 0 ) ? static_cast<double>( _hits + _shared_loads ) / requests : 0. ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  record_cache::record_cache( size_type max_bytes ) :
+    _max_bytes( max_bytes ) {
+    /* nop */
+  }
+
+  //--------------------------------------------------------------------------
+
+  record_cache::record_ptr record_cache::get( const pread_reader &reader, pos_type pos ) {
+    return get( reader.file_name(), pos, [&]( record &rec ) {
+      load_record( reader, pos, rec ) ;
+    }) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  record_cache::record_ptr record_cache::get( const std::string &fname, pos_type pos, const load_function &load ) {
+    std::unique_lock<std::mutex> lock( _mutex ) ;
+    auto iter = _slots.find( key_type( fname, key_position( pos ) ) ) ;
+    if( _slots.end() != iter ) {
+      auto &sl = iter->second ;
+      if( sl._loaded ) {
+        ++ _stats._hits ;
+        _lru.splice( _lru.begin(), _lru, sl._lru ) ;
+        return sl._future.get() ;
+      }
+      // another caller is loading the record: wait for it
+      ++ _stats._shared_loads ;
+      auto future = sl._future ;
+      lock.unlock() ;
+      return future.get() ;
+    }
+    ++ _stats._misses ;
+    std::promise<record_ptr> promise ;
+    iter = _slots.emplace( key_type( fname, key_position( pos ) ), slot() ).first ;
+    iter->second._future = promise.get_future().share() ;
+    lock.unlock() ;
+    // load the record without holding the lock
+    std::shared_ptr<record> rec ;
+    try {
+      rec = std::make_shared<record>() ;
+      load( *rec ) ;
+    }
+    catch( ... ) {
+      lock.lock() ;
+      _slots.erase( iter ) ;
+      lock.unlock() ;
+      promise.set_exception( std::current_exception() ) ;
+      throw ;
+    }
+    const record_ptr result = rec ;
+    lock.lock() ;
+    auto &sl = iter->second ;
+    sl._bytes = rec->_data.capacity() + rec->_info._name.capacity() + sizeof( record ) ;
+    sl._loaded = true ;
+    _lru.push_front( iter->first ) ;
+    sl._lru = _lru.begin() ;
+    _stats._bytes += sl._bytes ;
+    ++ _stats._records ;
+    // the waiting callers get the record even if it is evicted right away
+    promise.set_value( result ) ;
+    evict() ;
+    return result ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool record_cache::contains( const std::string &fname, pos_type pos ) const {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    auto iter = _slots.find( key_type( fname, key_position( pos ) ) ) ;
+    return ( _slots.end() != iter ) and iter->second._loaded ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void record_cache::clear() {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    for( const auto &key : _lru ) {
+      _slots.erase( key ) ;
+    }
+    _lru.clear() ;
+    _stats._records = 0 ;
+    _stats._bytes = 0 ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  record_cache::statistics record_cache::stats() const {
+    std::lock_guard<std::mutex> lock( _mutex ) ;
+    return _stats ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  record_cache::size_type record_cache::max_bytes() const {
+    return _max_bytes ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void record_cache::load_record( const pread_reader &reader, pos_type pos, record &rec ) {
+    SIO_TRACE_SCOPE( "io", "cache_load" ) ;
+    sio::buffer rec_buffer( sio::max_record_info_len ) ;
+    record_info rec_info ;
+    reader.read_record( pos, rec_info, rec_buffer ) ;
+    unpack_record( rec_info, rec_buffer.span( rec_info._header_length, rec_info._data_length ), rec ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void record_cache::unpack_record( const record_info &rec_info, const buffer_span &rec_data, record &rec ) {
+    rec._info = rec_info ;
+    if( sio::api::is_compressed( rec_info._options ) ) {
+      sio::zlib_compression compressor ;
+      rec._data.resize( rec_info._uncompressed_length ) ;
+      compressor.uncompress( rec_data, rec._data ) ;
+    }
+    else {
+      rec._data = sio::buffer( sio::buffer::container( rec_data.begin(), rec_data.end() ) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void record_cache::evict() {
+    while( _stats._bytes > _max_bytes and not _lru.empty() ) {
+      auto iter = _slots.find( _lru.back() ) ;
+      _stats._bytes -= iter->second._bytes ;
+      -- _stats._records ;
+      ++ _stats._evictions ;
+      _slots.erase( iter ) ;
+      _lru.pop_back() ;
+    }
+  }
+
+}
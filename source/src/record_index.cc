@@ -0,0 +1,252 @@
+// -- sio headers
+#include <sio/record_index.h>
+#include <sio/api.h>
+#include <sio/block.h>
+#include <sio/buffer.h>
+#include <sio/compression/zlib.h>
+#include <sio/exception.h>
+#include <sio/io_device.h>
+#include <sio/version.h>
+
+// -- std headers
+#include <algorithm>
+#include <memory>
+
+
+namespace sio {
+
+  namespace {
+
+    /**
+     *  @brief  The block reading/writing an index in a sidecar file
+     */
+    class record_index_block : public sio::block {
+    public:
+      record_index_block( std::vector<record_index_entry> &entries, std::vector<std::string> &files ) :
+        sio::block( record_index::block_name, sio::version::encode_version( 1, 1 ) ),
+        _entries( entries ),
+        _files( files ) {
+        /* nop */
+      }
+
+      void read( sio::read_device &device, sio::version_type vers ) override {
+        std::vector<unsigned long long> sequences, positions, lengths ;
+        std::vector<std::string> names ;
+        std::vector<unsigned int> file_numbers ;
+        device.data( sequences ) ;
+        device.data( positions ) ;
+        device.data( lengths ) ;
+        device.data( names ) ;
+        // v1.1: multi-file index
+        if( sio::version::major_version( vers ) > 1 or sio::version::minor_version( vers ) > 0 ) {
+          device.data( _files ) ;
+          device.data( file_numbers ) ;
+        }
+        else {
+          file_numbers.resize( sequences.size(), 0 ) ;
+        }
+        if( positions.size() != sequences.size() or lengths.size() != sequences.size() or names.size() != sequences.size() or file_numbers.size() != sequences.size() ) {
+          SIO_THROW( sio::error_code::invalid_argument, "Inconsistent record index block" ) ;
+        }
+        _entries.resize( sequences.size() ) ;
+        for( std::size_t i=0 ; i<sequences.size() ; i++ ) {
+          _entries[i]._sequence = sequences[i] ;
+          _entries[i]._position = positions[i] ;
+          _entries[i]._length = lengths[i] ;
+          _entries[i]._name = std::move( names[i] ) ;
+          _entries[i]._file = file_numbers[i] ;
+        }
+      }
+
+      void write( sio::write_device &device ) override {
+        std::vector<unsigned long long> sequences, positions, lengths ;
+        std::vector<std::string> names ;
+        std::vector<unsigned int> file_numbers ;
+        sequences.reserve( _entries.size() ) ;
+        positions.reserve( _entries.size() ) ;
+        lengths.reserve( _entries.size() ) ;
+        names.reserve( _entries.size() ) ;
+        file_numbers.reserve( _entries.size() ) ;
+        for( const auto &ent : _entries ) {
+          sequences.push_back( ent._sequence ) ;
+          positions.push_back( ent._position ) ;
+          lengths.push_back( ent._length ) ;
+          names.push_back( ent._name ) ;
+          file_numbers.push_back( ent._file ) ;
+        }
+        device.data( sequences ) ;
+        device.data( positions ) ;
+        device.data( lengths ) ;
+        device.data( names ) ;
+        device.data( _files ) ;
+        device.data( file_numbers ) ;
+      }
+
+    private:
+      ///< The index entries to read/write
+      std::vector<record_index_entry>     &_entries ;
+      ///< The file list to read/write
+      std::vector<std::string>            &_files ;
+    };
+
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::string record_index::sidecar_name( const std::string &fname ) {
+    return fname + ".idx" ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void record_index::add( const record_info &rec_info, std::uint64_t sequence ) {
+    entry ent ;
+    ent._sequence = sequence ;
+    ent._position = static_cast<std::uint64_t>( static_cast<std::streamoff>( rec_info._file_start ) ) ;
+    ent._length = static_cast<std::uint64_t>( static_cast<std::streamoff>( rec_info._file_end ) ) - ent._position ;
+    ent._name = rec_info._name ;
+    _entries.push_back( std::move( ent ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void record_index::add( const entry &ent ) {
+    _entries.push_back( ent ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::uint32_t record_index::add_file( const std::string &fname ) {
+    _files.push_back( fname ) ;
+    return static_cast<std::uint32_t>( _files.size() - 1 ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::vector<std::string> &record_index::files() const {
+    return _files ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void record_index::sort() {
+    std::stable_sort( _entries.begin(), _entries.end(), []( const entry &lhs, const entry &rhs ) {
+      return ( lhs._sequence < rhs._sequence ) ;
+    }) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void record_index::clear() {
+    _entries.clear() ;
+    _files.clear() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  record_index::size_type record_index::size() const {
+    return _entries.size() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool record_index::empty() const {
+    return _entries.empty() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const record_index::entry &record_index::at( size_type index ) const {
+    if( index >= _entries.size() ) {
+      SIO_THROW( sio::error_code::out_of_range, "Record index entry out of range" ) ;
+    }
+    return _entries[index] ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::vector<record_index::pos_type> record_index::positions() const {
+    std::vector<pos_type> pos ;
+    pos.reserve( _entries.size() ) ;
+    for( const auto &ent : _entries ) {
+      pos.push_back( pos_type( static_cast<std::streamoff>( ent._position ) ) ) ;
+    }
+    return pos ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  record_index::const_iterator record_index::begin() const {
+    return _entries.begin() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  record_index::const_iterator record_index::end() const {
+    return _entries.end() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void record_index::write( const std::string &fname ) const {
+    sio::ofstream stream ;
+    stream.open( fname, std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open index file '" + fname + "'" ) ;
+    }
+    // the block only reads the entries on write
+    auto &entries = const_cast<container&>( _entries ) ;
+    auto &files = const_cast<std::vector<std::string>&>( _files ) ;
+    sio::block_list blocks {} ;
+    blocks.push_back( std::make_shared<record_index_block>( entries, files ) ) ;
+    sio::buffer rec_buffer( sio::kbyte + 32*_entries.size() ) ;
+    sio::buffer comp_buffer( sio::kbyte ) ;
+    auto rec_info = sio::api::write_record( record_name, rec_buffer, blocks, 0 ) ;
+    sio::zlib_compression compressor ;
+    sio::api::compress_record( rec_info, rec_buffer, comp_buffer, compressor ) ;
+    sio::api::write_record( stream, rec_buffer.span( 0, rec_info._header_length ), comp_buffer.span(), rec_info ) ;
+    stream.close() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void record_index::read( const std::string &fname ) {
+    sio::ifstream stream ;
+    stream.open( fname, std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open index file '" + fname + "'" ) ;
+    }
+    sio::record_info rec_info ;
+    sio::buffer rec_buffer( sio::kbyte ) ;
+    sio::api::read_record( stream, rec_info, rec_buffer ) ;
+    if( rec_info._name != record_name ) {
+      SIO_THROW( sio::error_code::invalid_argument, "File '" + fname + "' is not a record index file" ) ;
+    }
+    container entries ;
+    std::vector<std::string> files ;
+    sio::block_list blocks {} ;
+    blocks.push_back( std::make_shared<record_index_block>( entries, files ) ) ;
+    const auto data = rec_buffer.span( rec_info._header_length, rec_info._data_length ) ;
+    if( sio::api::is_compressed( rec_info._options ) ) {
+      sio::zlib_compression compressor ;
+      sio::buffer uncomp_buffer( rec_info._uncompressed_length ) ;
+      compressor.uncompress( data, uncomp_buffer ) ;
+      sio::api::read_blocks( uncomp_buffer.span(), blocks ) ;
+    }
+    else {
+      sio::api::read_blocks( data, blocks ) ;
+    }
+    // relative file names are relative to the index file
+    const auto slash = fname.find_last_of( '/' ) ;
+    if( slash != std::string::npos ) {
+      for( auto &file : files ) {
+        if( not file.empty() and file[0] != '/' ) {
+          file = fname.substr( 0, slash+1 ) + file ;
+        }
+      }
+    }
+    _entries = std::move( entries ) ;
+    _files = std::move( files ) ;
+  }
+
+}
@@ -0,0 +1,183 @@
+// -- sio headers
+#include <sio/recovery.h>
+#include <sio/api.h>
+#include <sio/compression/zlib.h>
+#include <sio/exception.h>
+#include <sio/pread_reader.h>
+
+// -- std headers
+#include <algorithm>
+
+
+namespace sio {
+
+  namespace {
+
+    /**
+     *  @brief  A window on the file content, reloaded on demand
+     */
+    class file_window {
+    public:
+      file_window( const pread_reader &reader, std::size_t file_size ) :
+        _reader( reader ),
+        _file_size( file_size ) {
+        /* nop */
+      }
+
+      /// Get a span on [pos, pos+length), or less at the end of file
+      buffer_span get( std::size_t pos, std::size_t length ) {
+        length = std::min( length, _file_size - std::min( pos, _file_size ) ) ;
+        if( pos < _start or pos + length > _start + _length ) {
+          const std::size_t chunk = recovery::chunk_size ;
+          const auto load = std::max( length, chunk ) ;
+          _buffer.resize( load ) ;
+          _start = pos ;
+          _length = _reader.read_bytes( _buffer.data(), pos, load ) ;
+          if( _length < length ) {
+            SIO_THROW( sio::error_code::io_failure, "Couldn't read the file content" ) ;
+          }
+        }
+        return _buffer.span( pos - _start, length ) ;
+      }
+
+      /// Get the number of bytes loaded in the window from the given position
+      std::size_t available( std::size_t pos ) const {
+        return ( pos >= _start and pos < _start + _length ) ? ( _start + _length - pos ) : 0 ;
+      }
+
+    private:
+      ///< The file reader
+      const pread_reader       &_reader ;
+      ///< The file size
+      const std::size_t         _file_size ;
+      ///< The window content
+      buffer                    _buffer {recovery::chunk_size} ;
+      ///< The window position in the file
+      std::size_t               _start {0} ;
+      ///< The number of valid bytes in the window
+      std::size_t               _length {0} ;
+    };
+
+    /**
+     *  @brief  Check whether an intact record starts at the given position.
+     *          Returns the record length or 0
+     */
+    std::size_t intact_record( file_window &window, std::size_t pos, std::size_t file_size, bool deep, record_info &rec_info, buffer &uncomp_buffer ) {
+      const auto hdr_span = window.get( pos, sio::max_record_info_len ) ;
+      if( hdr_span.size() < 8 ) {
+        return 0 ;
+      }
+      record_info_view view ;
+      view._file_start = static_cast<std::streamoff>( pos ) ;
+      if( not sio::api::validate_record_info( hdr_span, view ) ) {
+        return 0 ;
+      }
+      const auto end = static_cast<std::size_t>( static_cast<std::streamoff>( view._file_end ) ) ;
+      if( end > file_size or end <= pos ) {
+        return 0 ;
+      }
+      rec_info = view.to_info() ;
+      const auto rec_span = window.get( pos, end - pos ) ;
+      const auto data = rec_span.subspan( rec_info._header_length, rec_info._data_length ) ;
+      if( not sio::api::is_compressed( rec_info._options ) ) {
+        return recovery::valid_blocks( data ) ? ( end - pos ) : 0 ;
+      }
+      if( deep ) {
+        try {
+          sio::zlib_compression compressor ;
+          uncomp_buffer.resize( rec_info._uncompressed_length ) ;
+          compressor.uncompress( data, uncomp_buffer ) ;
+        }
+        catch( const sio::exception & ) {
+          return 0 ;
+        }
+        return recovery::valid_blocks( uncomp_buffer.span() ) ? ( end - pos ) : 0 ;
+      }
+      return end - pos ;
+    }
+
+  }
+
+  //--------------------------------------------------------------------------
+
+  recovery_report recovery::scan( const std::string &fname, const record_function &func, bool deep ) {
+    const pread_reader reader( fname ) ;
+    recovery_report report ;
+    report._file_size = reader.file_size() ;
+    file_window window( reader, report._file_size ) ;
+    record_info rec_info ;
+    buffer uncomp_buffer( sio::kbyte ) ;
+    std::size_t pos = 0 ;
+    while( pos < report._file_size ) {
+      auto length = intact_record( window, pos, report._file_size, deep, rec_info, uncomp_buffer ) ;
+      if( length > 0 ) {
+        func( rec_info, window.get( pos, length ) ) ;
+        ++ report._records ;
+        report._record_bytes += length ;
+        pos += length ;
+        continue ;
+      }
+      // corrupted: look for the next intact record after the marker
+      const auto skip_start = pos ;
+      pos += 4 ;
+      while( pos < report._file_size ) {
+        // search in the loaded window first
+        const auto span = window.get( pos, std::max( window.available( pos ), 64*sio::kbyte ) ) ;
+        // the marker is 4 bytes after the record start
+        const auto marker = sio::api::find_record_marker( span, 4 ) ;
+        if( marker + 4 > span.size() ) {
+          // overlap the chunks by one word: a marker at the start of the next chunk is searched from offset 4
+          pos += std::max( span.size() & sio::padding_mask, std::size_t(8) ) - 4 ;
+          continue ;
+        }
+        pos += marker - 4 ;
+        if( intact_record( window, pos, report._file_size, deep, rec_info, uncomp_buffer ) > 0 ) {
+          break ;
+        }
+        pos += 4 ;
+      }
+      pos = std::min( pos, report._file_size ) ;
+      report._skipped.emplace_back( skip_start, pos ) ;
+      report._skipped_bytes += pos - skip_start ;
+    }
+    return report ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  recovery_report recovery::recover( const std::string &input, const std::string &output, bool deep ) {
+    sio::ofstream stream ;
+    stream.open( output, std::ios::binary ) ;
+    if( not stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open output stream '" + output + "'" ) ;
+    }
+    auto report = scan( input, [&]( const record_info &, const buffer_span &rec_span ) {
+      if( not stream.write( rec_span.data(), rec_span.size() ).good() ) {
+        SIO_THROW( sio::error_code::io_failure, "Couldn't write record to output stream" ) ;
+      }
+    }, deep ) ;
+    stream.close() ;
+    return report ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool recovery::valid_blocks( const buffer_span &data ) {
+    buffer_span::index_type index = 0 ;
+    try {
+      while( index < data.size() ) {
+        block_info_view info ;
+        const auto block = sio::api::extract_block( data, index, info ) ;
+        if( block.size() == 0 ) {
+          return false ;
+        }
+        index += block.size() ;
+      }
+    }
+    catch( const sio::exception & ) {
+      return false ;
+    }
+    return ( index == data.size() ) ;
+  }
+
+}
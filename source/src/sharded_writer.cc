@@ -0,0 +1,248 @@
+// -- sio headers
+#include <sio/sharded_writer.h>
+#include <sio/api.h>
+#include <sio/exception.h>
+#include <sio/trace.h>
+
+// -- std headers
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+
+namespace sio {
+
+  sharded_writer::sharded_writer( const std::string &fname, size_type nshards, shard_policy policy, size_type max_queued ) :
+    _fname( fname ),
+    _policy( policy ),
+    _max_queued( std::max( max_queued, size_type(1) ) ) {
+    if( 0 == nshards ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The number of shards must be positive" ) ;
+    }
+    for( size_type i=0 ; i<nshards ; i++ ) {
+      std::unique_ptr<shard> sh( new shard() ) ;
+      sh->_fname = shard_name( fname, i ) ;
+      sh->_stream.open( sh->_fname, std::ios::binary ) ;
+      if( not sh->_stream.is_open() ) {
+        stop() ;
+        SIO_THROW( sio::error_code::not_open, "Couldn't open output stream '" + sh->_fname + "'" ) ;
+      }
+      _shards.push_back( std::move( sh ) ) ;
+      auto &ref = *_shards.back() ;
+      ref._thread = std::thread( &sharded_writer::run, this, std::ref( ref ) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  sharded_writer::~sharded_writer() {
+    try {
+      close() ;
+    }
+    catch( ... ) {
+      /* no throw in destructor */
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::string sharded_writer::shard_name( const std::string &fname, size_type shard ) {
+    // out.sio -> out_<shard>.sio
+    const auto slash = fname.find_last_of( '/' ) ;
+    const auto dot = fname.find_last_of( '.' ) ;
+    if( dot == std::string::npos or ( slash != std::string::npos and dot < slash ) or dot == slash+1 ) {
+      return fname + "_" + std::to_string( shard ) ;
+    }
+    return fname.substr( 0, dot ) + "_" + std::to_string( shard ) + fname.substr( dot ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  sharded_writer::size_type sharded_writer::write_record( const buffer_span &rec_buf, const record_info &rec_info, std::uint64_t sequence ) {
+    if( not rec_buf.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The record buffer is not valid" ) ;
+    }
+    return enqueue( rec_buf, buffer_span(), false, rec_info, sequence ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  sharded_writer::size_type sharded_writer::write_record( const buffer_span &hdr_span, const buffer_span &data_span, const record_info &rec_info, std::uint64_t sequence ) {
+    if( not hdr_span.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The record header buffer is not valid" ) ;
+    }
+    if( not data_span.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "The record data buffer is not valid" ) ;
+    }
+    return enqueue( hdr_span, data_span, true, rec_info, sequence ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void sharded_writer::close() {
+    if( _closed.exchange( true ) ) {
+      return ;
+    }
+    stop() ;
+    for( auto &sh : _shards ) {
+      if( sh->_error ) {
+        std::rethrow_exception( sh->_error ) ;
+      }
+    }
+    // write the shard indices and merge them in the manifest
+    _index.clear() ;
+    for( auto &sh : _shards ) {
+      sh->_index.sort() ;
+      sh->_index.write( record_index::sidecar_name( sh->_fname ) ) ;
+      // the shard files are in the manifest directory
+      const auto slash = sh->_fname.find_last_of( '/' ) ;
+      const auto file = _index.add_file( ( slash == std::string::npos ) ? sh->_fname : sh->_fname.substr( slash+1 ) ) ;
+      for( auto ent : sh->_index ) {
+        ent._file = file ;
+        _index.add( ent ) ;
+      }
+    }
+    _index.sort() ;
+    _index.write( record_index::sidecar_name( _fname ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  sharded_writer::size_type sharded_writer::shards() const {
+    return _shards.size() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const record_index &sharded_writer::index() const {
+    return _index ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  sharded_writer::size_type sharded_writer::select_shard( std::uint64_t sequence ) {
+    if( _policy == shard_policy::hash ) {
+      // splitmix64 finalizer: consecutive numbers spread over all shards
+      auto h = sequence + 0x9e3779b97f4a7c15ULL ;
+      h = ( h ^ ( h >> 30 ) ) * 0xbf58476d1ce4e5b9ULL ;
+      h = ( h ^ ( h >> 27 ) ) * 0x94d049bb133111ebULL ;
+      h = h ^ ( h >> 31 ) ;
+      return static_cast<size_type>( h % _shards.size() ) ;
+    }
+    return static_cast<size_type>( _counter.fetch_add( 1 ) % _shards.size() ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  sharded_writer::size_type sharded_writer::enqueue( const buffer_span &hdr_span, const buffer_span &data_span, bool split, const record_info &rec_info, std::uint64_t sequence ) {
+    if( _closed ) {
+      SIO_THROW( sio::error_code::not_open, "The sharded writer is closed" ) ;
+    }
+    const auto index = select_shard( sequence ) ;
+    auto &sh = *_shards[index] ;
+    std::unique_lock<std::mutex> lock( sh._mutex ) ;
+    auto ready = [&]{
+      return ( sh._queue.size() < _max_queued or sh._error or sh._stop ) ;
+    } ;
+    if( not ready() ) {
+      // the shard queue is full: the writer thread is the bottleneck
+      SIO_TRACE_SCOPE( "stall", "shard_queue_full" ) ;
+      sh._caller_cond.wait( lock, ready ) ;
+    }
+    if( sh._error ) {
+      std::rethrow_exception( sh._error ) ;
+    }
+    // close() may have been called since the check above
+    if( sh._stop ) {
+      SIO_THROW( sio::error_code::not_open, "The sharded writer is closed" ) ;
+    }
+    item it ;
+    if( not sh._pool.empty() ) {
+      it = std::move( sh._pool.back() ) ;
+      sh._pool.pop_back() ;
+    }
+    lock.unlock() ;
+    // copy the record out of the caller buffers
+    const auto total = hdr_span.size() + data_span.size() ;
+    it._buffer.resize( total ) ;
+    std::copy( hdr_span.begin(), hdr_span.end(), it._buffer.begin() ) ;
+    if( split ) {
+      std::copy( data_span.begin(), data_span.end(), it._buffer.begin() + hdr_span.size() ) ;
+    }
+    it._header_length = hdr_span.size() ;
+    it._split = split ;
+    it._info = rec_info ;
+    it._sequence = sequence ;
+    lock.lock() ;
+    if( sh._stop ) {
+      // the shard thread may be gone: the record would never be written
+      SIO_THROW( sio::error_code::not_open, "The sharded writer is closed" ) ;
+    }
+    sh._queue.push_back( std::move( it ) ) ;
+    lock.unlock() ;
+    sh._writer_cond.notify_one() ;
+    return index ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void sharded_writer::run( shard &sh ) {
+    SIO_TRACE_THREAD_NAME( "sio shard " + sh._fname ) ;
+    std::unique_lock<std::mutex> lock( sh._mutex ) ;
+    while( 1 ) {
+      sh._writer_cond.wait( lock, [&]{
+        return ( sh._stop or not sh._queue.empty() ) ;
+      }) ;
+      if( sh._queue.empty() ) {
+        // stop requested and nothing left to write
+        break ;
+      }
+      item it = std::move( sh._queue.front() ) ;
+      sh._queue.pop_front() ;
+      lock.unlock() ;
+      sh._caller_cond.notify_one() ;
+      // write the record without holding the lock
+      try {
+        if( not sh._error ) {
+          if( it._split ) {
+            sio::api::write_record( sh._stream, it._buffer.span( 0, it._header_length ), it._buffer.span( it._header_length ), it._info ) ;
+          }
+          else {
+            sio::api::write_record( sh._stream, it._buffer.span(), it._info ) ;
+          }
+          sh._index.add( it._info, it._sequence ) ;
+        }
+      }
+      catch( ... ) {
+        lock.lock() ;
+        sh._error = std::current_exception() ;
+        lock.unlock() ;
+        sh._caller_cond.notify_all() ;
+      }
+      lock.lock() ;
+      if( sh._pool.size() < _max_queued ) {
+        sh._pool.push_back( std::move( it ) ) ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void sharded_writer::stop() {
+    for( auto &sh : _shards ) {
+      {
+        std::lock_guard<std::mutex> lock( sh->_mutex ) ;
+        sh->_stop = true ;
+      }
+      sh->_writer_cond.notify_one() ;
+      sh->_caller_cond.notify_all() ;
+    }
+    for( auto &sh : _shards ) {
+      if( sh->_thread.joinable() ) {
+        sh->_thread.join() ;
+      }
+      sh->_stream.close() ;
+    }
+  }
+
+}
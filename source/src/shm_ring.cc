@@ -0,0 +1,396 @@
+// -- sio headers
+#include <sio/shm_ring.h>
+#include <sio/api.h>
+#include <sio/exception.h>
+#include <sio/definitions.h>
+
+// -- std headers
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <chrono>
+
+// -- posix headers
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+
+namespace sio {
+
+  /**
+   *  @brief  The control block at the start of the ring file.
+   *  The producer and consumer fields are on separate cache lines
+   */
+  struct shm_ring::control {
+    ///< The producer position (published bytes)
+    alignas(64) std::atomic<std::uint64_t>  _head ;
+    ///< Incremented on each publication (consumer futex word)
+    std::atomic<std::uint32_t>              _data_seq ;
+    ///< Whether the consumer waits for data
+    std::atomic<std::uint32_t>              _data_waiters ;
+    ///< The consumer position (released bytes)
+    alignas(64) std::atomic<std::uint64_t>  _tail ;
+    ///< Incremented on each release (producer futex word)
+    std::atomic<std::uint32_t>              _space_seq ;
+    ///< Whether the producer waits for space
+    std::atomic<std::uint32_t>              _space_waiters ;
+    ///< Whether the producer has closed the ring
+    alignas(64) std::atomic<std::uint32_t>  _closed ;
+    ///< The capacity of the data area
+    std::uint64_t                           _capacity ;
+    ///< Written last by the producer once the ring is ready
+    std::atomic<std::uint32_t>              _magic ;
+  };
+
+  namespace {
+
+    /// Marks a ready ring control block
+    constexpr std::uint32_t ring_magic = 0x5109a1b5 ;
+
+    /// Sleep until the futex word changes from the expected value
+    inline void futex_wait( std::atomic<std::uint32_t> &word, std::uint32_t expected ) {
+#ifdef __linux__
+      // bounded wait: protects against a peer process that died
+      struct timespec timeout = { 0, 100*1000*1000 } ;
+      ::syscall( SYS_futex, reinterpret_cast<std::uint32_t*>( &word ), FUTEX_WAIT, expected, &timeout, nullptr, 0 ) ;
+#else
+      if( word.load() == expected ) {
+        std::this_thread::sleep_for( std::chrono::microseconds( 50 ) ) ;
+      }
+#endif
+    }
+
+    /// Wake up the processes sleeping on the futex word
+    inline void futex_wake( std::atomic<std::uint32_t> &word ) {
+#ifdef __linux__
+      ::syscall( SYS_futex, reinterpret_cast<std::uint32_t*>( &word ), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0 ) ;
+#else
+      (void)word ;
+#endif
+    }
+
+    /// Wait until the predicate is true. The waiter announces itself
+    /// before sleeping, so that the notifier only wakes it up if needed
+    template <typename Pred>
+    inline void wait_until( std::atomic<std::uint32_t> &seq, std::atomic<std::uint32_t> &waiters, Pred pred ) {
+      while( 1 ) {
+        const auto current = seq.load() ;
+        if( pred() ) {
+          return ;
+        }
+        waiters.store( 1 ) ;
+        if( pred() ) {
+          return ;
+        }
+        futex_wait( seq, current ) ;
+      }
+    }
+
+    /// Notify a waiter, if any
+    inline void notify( std::atomic<std::uint32_t> &seq, std::atomic<std::uint32_t> &waiters ) {
+      seq.fetch_add( 1 ) ;
+      if( waiters.exchange( 0 ) ) {
+        futex_wake( seq ) ;
+      }
+    }
+
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  shm_ring::shm_ring( const std::string &fname, size_type capacity, bool create ) :
+    _fname( fname ) {
+    const auto page_size = static_cast<size_type>( ::sysconf( _SC_PAGESIZE ) ) ;
+    _control_size = ( ( sizeof( control ) + page_size - 1 ) / page_size ) * page_size ;
+    if( create ) {
+      if( 0 == capacity ) {
+        SIO_THROW( sio::error_code::invalid_argument, "Ring capacity must be positive" ) ;
+      }
+      _capacity = ( ( capacity + page_size - 1 ) / page_size ) * page_size ;
+      _fd = ::open( fname.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 ) ;
+      if( _fd < 0 ) {
+        SIO_THROW( sio::error_code::open_fail, "Couldn't create ring file '" + fname + "': " + std::strerror( errno ) ) ;
+      }
+      if( 0 != ::ftruncate( _fd, static_cast<off_t>( _control_size + _capacity ) ) ) {
+        ::close( _fd ) ;
+        SIO_THROW( sio::error_code::io_failure, "Couldn't resize ring file '" + fname + "': " + std::strerror( errno ) ) ;
+      }
+    }
+    else {
+      _fd = ::open( fname.c_str(), O_RDWR | O_CLOEXEC ) ;
+      if( _fd < 0 ) {
+        SIO_THROW( sio::error_code::open_fail, "Couldn't open ring file '" + fname + "': " + std::strerror( errno ) ) ;
+      }
+    }
+    void *ctrl = ::mmap( nullptr, _control_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0 ) ;
+    if( MAP_FAILED == ctrl ) {
+      ::close( _fd ) ;
+      SIO_THROW( sio::error_code::io_failure, "Couldn't map ring control block: " + std::string( std::strerror( errno ) ) ) ;
+    }
+    if( create ) {
+      _control = new( ctrl ) control() ;
+      _control->_capacity = _capacity ;
+      _control->_magic.store( ring_magic ) ;
+    }
+    else {
+      _control = static_cast<control*>( ctrl ) ;
+      struct stat st ;
+      if( ring_magic != _control->_magic.load() or 0 != ::fstat( _fd, &st ) or
+          static_cast<size_type>( st.st_size ) != _control_size + _control->_capacity ) {
+        ::munmap( ctrl, _control_size ) ;
+        ::close( _fd ) ;
+        SIO_THROW( sio::error_code::open_fail, "File '" + fname + "' is not a valid ring" ) ;
+      }
+      _capacity = _control->_capacity ;
+    }
+    // reserve twice the data area and map the data area twice in a row
+    void *area = ::mmap( nullptr, 2*_capacity, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 ) ;
+    if( MAP_FAILED != area ) {
+      auto first = static_cast<sio::byte*>( area ) ;
+      void *m1 = ::mmap( first, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, _fd, static_cast<off_t>( _control_size ) ) ;
+      void *m2 = ::mmap( first + _capacity, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, _fd, static_cast<off_t>( _control_size ) ) ;
+      if( MAP_FAILED != m1 and MAP_FAILED != m2 ) {
+        _data = first ;
+      }
+      else {
+        ::munmap( area, 2*_capacity ) ;
+      }
+    }
+    if( nullptr == _data ) {
+      ::munmap( ctrl, _control_size ) ;
+      ::close( _fd ) ;
+      SIO_THROW( sio::error_code::io_failure, "Couldn't map ring data area: " + std::string( std::strerror( errno ) ) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  shm_ring::~shm_ring() {
+    ::munmap( _data, 2*_capacity ) ;
+    ::munmap( _control, _control_size ) ;
+    ::close( _fd ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::string &shm_ring::name() const {
+    return _fname ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  shm_ring::size_type shm_ring::capacity() const {
+    return _capacity ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::uint64_t shm_ring::head() const {
+    return _control->_head.load( std::memory_order_acquire ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::uint64_t shm_ring::tail() const {
+    return _control->_tail.load( std::memory_order_acquire ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool shm_ring::closed() const {
+    return ( 0 != _control->_closed.load() ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  sio::byte *shm_ring::address( std::uint64_t pos ) const {
+    return _data + ( pos % _capacity ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void shm_ring::publish( std::uint64_t pos ) {
+    _control->_head.store( pos ) ;
+    notify( _control->_data_seq, _control->_data_waiters ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void shm_ring::close() {
+    _control->_closed.store( 1 ) ;
+    notify( _control->_data_seq, _control->_data_waiters ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void shm_ring::wait_space( std::uint64_t pos ) {
+    wait_until( _control->_space_seq, _control->_space_waiters, [&]() {
+      return ( pos - _control->_tail.load() <= _capacity ) ;
+    }) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void shm_ring::release( std::uint64_t pos ) {
+    _control->_tail.store( pos ) ;
+    notify( _control->_space_seq, _control->_space_waiters ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool shm_ring::wait_data( std::uint64_t pos ) {
+    // the closed flag is set after the last publication
+    wait_until( _control->_data_seq, _control->_data_waiters, [&]() {
+      return ( _control->_head.load() >= pos or 0 != _control->_closed.load() ) ;
+    }) ;
+    return ( _control->_head.load() >= pos ) ;
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  shm_ring_writer::shm_ring_writer( const std::string &fname, size_type capacity ) :
+    shm_ring( fname, capacity, true ) {
+    /* nop */
+  }
+
+  //--------------------------------------------------------------------------
+
+  shm_ring_writer::~shm_ring_writer() {
+    try {
+      close() ;
+    }
+    catch( ... ) {
+      /* nop */
+    }
+    ::unlink( name().c_str() ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void shm_ring_writer::write( const sio::byte *src, size_type length ) {
+    const auto end = _write_pos + length ;
+    if( end - _published > capacity() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Record too large for the ring capacity" ) ;
+    }
+    wait_space( end ) ;
+    // contiguous even across the end of the data area (double mapping)
+    std::memcpy( address( _write_pos ), src, length ) ;
+    _write_pos = end ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  shm_ring_writer::pos_type shm_ring_writer::position() const {
+    return pos_type( static_cast<std::streamoff>( _write_pos ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void shm_ring_writer::flush() {
+    if( _write_pos != _published ) {
+      publish( _write_pos ) ;
+      _published = _write_pos ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void shm_ring_writer::close() {
+    flush() ;
+    shm_ring::close() ;
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  shm_ring_reader::shm_ring_reader( const std::string &fname ) :
+    shm_ring( fname, 0, false ) {
+    _read_pos = tail() ;
+    _next_pos = _read_pos ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void shm_ring_reader::read_record_info( record_info_view &rec_info ) {
+    if( _has_current ) {
+      // give the previous record back to the producer
+      _has_current = false ;
+      release( _next_pos ) ;
+    }
+    _read_pos = _next_pos ;
+    if( not wait_data( _read_pos + 8 ) ) {
+      SIO_THROW( sio::error_code::eof, "Reached end of ring !" ) ;
+    }
+    // Interpret: 1) The length of the record header.
+    //            2) The record marker.
+    unsigned int header_length(0), marker(0) ;
+    const buffer_span first_bytes( address( _read_pos ), 8 ) ;
+    sio::api::read( first_bytes, &header_length, 0, 1 ) ;
+    sio::api::read( first_bytes, &marker, 4, 1 ) ;
+    if( marker != sio::record_marker ) {
+      SIO_THROW( sio::error_code::no_marker, "Record marker not found!" ) ;
+    }
+    if( header_length < 8 or header_length > sio::max_record_info_len or header_length > capacity() ) {
+      SIO_THROW( sio::error_code::no_marker, "Invalid record header length" ) ;
+    }
+    if( not wait_data( _read_pos + header_length ) ) {
+      SIO_THROW( sio::error_code::io_failure, "Reached end of ring while reading the record header!" ) ;
+    }
+    _current = record_info_view() ;
+    _current._file_start = pos_type( static_cast<std::streamoff>( _read_pos ) ) ;
+    sio::api::read_record_info( buffer_span( address( _read_pos ), header_length ), _current ) ;
+    _next_pos = static_cast<std::uint64_t>( static_cast<std::streamoff>( _current._file_end ) ) ;
+    if( _next_pos - _read_pos > capacity() ) {
+      SIO_THROW( sio::error_code::io_failure, "Record larger than the ring capacity!" ) ;
+    }
+    _has_current = true ;
+    rec_info = _current ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool shm_ring_reader::next_record_info( record_info_view &rec_info ) {
+    try {
+      read_record_info( rec_info ) ;
+    }
+    catch( sio::exception &e ) {
+      if( e.code() == sio::error_code::eof ) {
+        return false ;
+      }
+      throw ;
+    }
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  buffer_span shm_ring_reader::read_record_data() {
+    auto rec_span = read_record() ;
+    return rec_span.subspan( _current._header_length ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  buffer_span shm_ring_reader::read_record() {
+    if( not _has_current ) {
+      SIO_THROW( sio::error_code::bad_state, "No record header read out!" ) ;
+    }
+    const auto len = static_cast<std::uint64_t>( _current._header_length ) + _current._data_length ;
+    if( not wait_data( _read_pos + len ) ) {
+      SIO_THROW( sio::error_code::io_failure, "Reached end of ring while reading the record data!" ) ;
+    }
+    return buffer_span( address( _read_pos ), len ) ;
+  }
+
+}
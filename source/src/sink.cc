@@ -0,0 +1,85 @@
+// -- sio headers
+#include <sio/sink.h>
+#include <sio/exception.h>
+
+// -- std headers
+#include <algorithm>
+
+
+namespace sio {
+
+  memory_sink::memory_sink( buffer &buf ) :
+    _buffer(buf) {
+    if( not _buffer.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Buffer is invalid" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void memory_sink::write( const sio::byte *src, size_type length ) {
+    if( _position + length > _buffer.size() ) {
+      // grow geometrically to keep the writes amortized
+      _buffer.resize( std::max( _position + length, 2*_buffer.size() ) ) ;
+    }
+    std::copy( src, src + length, _buffer.ptr( _position ) ) ;
+    _position += length ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  memory_sink::pos_type memory_sink::position() const {
+    return pos_type( static_cast<std::streamoff>( _position ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void memory_sink::flush() {
+    /* nop */
+  }
+
+  //--------------------------------------------------------------------------
+
+  buffer_span memory_sink::span() const {
+    return _buffer.span( 0, _position ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void memory_sink::clear() {
+    _position = 0 ;
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  file_sink::file_sink( sio::ofstream &stream ) :
+    _stream(stream) {
+    if( not _stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "ofstream is not open!" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void file_sink::write( const sio::byte *src, size_type length ) {
+    if( not _stream.write( src, length ).good() ) {
+      SIO_THROW( sio::error_code::io_failure, "Couldn't write to output stream" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  file_sink::pos_type file_sink::position() const {
+    return _stream.tellp() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void file_sink::flush() {
+    if( not _stream.flush().good() ) {
+      SIO_THROW( sio::error_code::io_failure, "Couldn't flush output stream" ) ;
+    }
+  }
+
+}
@@ -0,0 +1,440 @@
+// -- sio headers
+#include <sio/socket_stream.h>
+#include <sio/api.h>
+#include <sio/exception.h>
+#include <sio/definitions.h>
+
+// -- std headers
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <utility>
+
+// -- posix headers
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+
+namespace sio {
+
+  namespace {
+
+    /// Fill a Unix-domain socket address
+    sockaddr_un unix_address( const std::string &path ) {
+      sockaddr_un addr ;
+      std::memset( &addr, 0, sizeof(addr) ) ;
+      addr.sun_family = AF_UNIX ;
+      if( path.size() >= sizeof(addr.sun_path) ) {
+        SIO_THROW( sio::error_code::invalid_argument, "Socket path too long: " + path ) ;
+      }
+      std::memcpy( addr.sun_path, path.c_str(), path.size() ) ;
+      return addr ;
+    }
+
+    /// Create a stream socket
+    int create_socket( int domain ) {
+      const int fd = ::socket( domain, SOCK_STREAM, 0 ) ;
+      if( fd < 0 ) {
+        SIO_THROW( sio::error_code::open_fail, "Couldn't create socket: " + std::string( std::strerror( errno ) ) ) ;
+      }
+      return fd ;
+    }
+
+    /// Close the socket and throw
+    void fail( int fd, sio::error_code code, const std::string &message ) {
+      const std::string reason = std::strerror( errno ) ;
+      ::close( fd ) ;
+      SIO_THROW( code, message + ": " + reason ) ;
+    }
+
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  int sockets::listen_unix( const std::string &path, int backlog ) {
+    const auto addr = unix_address( path ) ;
+    const int fd = create_socket( AF_UNIX ) ;
+    ::unlink( path.c_str() ) ;
+    if( 0 != ::bind( fd, reinterpret_cast<const sockaddr*>( &addr ), sizeof(addr) ) ) {
+      fail( fd, sio::error_code::open_fail, "Couldn't bind socket to " + path ) ;
+    }
+    if( 0 != ::listen( fd, backlog ) ) {
+      fail( fd, sio::error_code::open_fail, "Couldn't listen on socket " + path ) ;
+    }
+    return fd ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  int sockets::connect_unix( const std::string &path ) {
+    const auto addr = unix_address( path ) ;
+    const int fd = create_socket( AF_UNIX ) ;
+    if( 0 != ::connect( fd, reinterpret_cast<const sockaddr*>( &addr ), sizeof(addr) ) ) {
+      fail( fd, sio::error_code::open_fail, "Couldn't connect to socket " + path ) ;
+    }
+    return fd ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  int sockets::listen_tcp( unsigned short port, bool loopback_only, int backlog ) {
+    const int fd = create_socket( AF_INET ) ;
+    int on = 1 ;
+    ::setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on) ) ;
+    sockaddr_in addr ;
+    std::memset( &addr, 0, sizeof(addr) ) ;
+    addr.sin_family = AF_INET ;
+    addr.sin_port = htons( port ) ;
+    addr.sin_addr.s_addr = htonl( loopback_only ? INADDR_LOOPBACK : INADDR_ANY ) ;
+    if( 0 != ::bind( fd, reinterpret_cast<const sockaddr*>( &addr ), sizeof(addr) ) ) {
+      fail( fd, sio::error_code::open_fail, "Couldn't bind socket to port " + std::to_string( port ) ) ;
+    }
+    if( 0 != ::listen( fd, backlog ) ) {
+      fail( fd, sio::error_code::open_fail, "Couldn't listen on port " + std::to_string( port ) ) ;
+    }
+    return fd ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  int sockets::connect_tcp( const std::string &host, unsigned short port ) {
+    sockaddr_in addr ;
+    std::memset( &addr, 0, sizeof(addr) ) ;
+    addr.sin_family = AF_INET ;
+    addr.sin_port = htons( port ) ;
+    if( 1 != ::inet_pton( AF_INET, host.c_str(), &addr.sin_addr ) ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Invalid IPv4 address: " + host ) ;
+    }
+    const int fd = create_socket( AF_INET ) ;
+    if( 0 != ::connect( fd, reinterpret_cast<const sockaddr*>( &addr ), sizeof(addr) ) ) {
+      fail( fd, sio::error_code::open_fail, "Couldn't connect to " + host + ":" + std::to_string( port ) ) ;
+    }
+    // the records are batched by the sink: don't delay the batches
+    int on = 1 ;
+    ::setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on) ) ;
+    return fd ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  unsigned short sockets::local_port( int fd ) {
+    sockaddr_in addr ;
+    socklen_t len = sizeof(addr) ;
+    if( 0 != ::getsockname( fd, reinterpret_cast<sockaddr*>( &addr ), &len ) ) {
+      SIO_THROW( sio::error_code::bad_state, "Couldn't get socket address: " + std::string( std::strerror( errno ) ) ) ;
+    }
+    return ntohs( addr.sin_port ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  int sockets::accept( int fd ) {
+    while( 1 ) {
+      const int client = ::accept( fd, nullptr, nullptr ) ;
+      if( client >= 0 ) {
+        int on = 1 ;
+        // fails on Unix-domain sockets, which is fine
+        ::setsockopt( client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on) ) ;
+        return client ;
+      }
+      if( EINTR != errno ) {
+        SIO_THROW( sio::error_code::open_fail, "Couldn't accept connection: " + std::string( std::strerror( errno ) ) ) ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void sockets::close( int fd ) {
+    if( fd >= 0 ) {
+      ::close( fd ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  socket_sink::socket_sink( int fd, size_type max_records, size_type max_bytes, size_type copy_threshold, std::chrono::microseconds max_delay ) :
+    _fd( fd ),
+    _max_records( std::max( max_records, size_type(1) ) ),
+    _max_bytes( max_bytes ),
+    _copy_threshold( copy_threshold ),
+    _max_delay( max_delay ),
+    _batch( std::max( max_bytes, sio::kbyte ) ) {
+    if( _fd < 0 ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Invalid socket" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  socket_sink::~socket_sink() {
+    try {
+      close() ;
+    }
+    catch( ... ) {
+      /* nop */
+    }
+    sockets::close( _fd ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void socket_sink::write( const sio::byte *src, size_type length ) {
+    if( 0 == length ) {
+      return ;
+    }
+    if( length > _copy_threshold ) {
+      // large write: send from the caller memory, before the record is complete
+      chunk borrowed ;
+      borrowed._ptr = src ;
+      borrowed._length = length ;
+      _chunks.push_back( borrowed ) ;
+      _borrowed = true ;
+    }
+    else {
+      if( _batch_len + length > _batch.size() ) {
+        _batch.resize( std::max( _batch_len + length, 2*_batch.size() ) ) ;
+      }
+      std::memcpy( _batch.ptr( _batch_len ), src, length ) ;
+      // extend the previous chunk if contiguous in the batch buffer
+      if( not _chunks.empty() and nullptr == _chunks.back()._ptr and _chunks.back()._offset + _chunks.back()._length == _batch_len ) {
+        _chunks.back()._length += length ;
+      }
+      else {
+        chunk copied ;
+        copied._offset = _batch_len ;
+        copied._length = length ;
+        _chunks.push_back( copied ) ;
+      }
+      _batch_len += length ;
+    }
+    _batch_bytes += length ;
+    _position += length ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  socket_sink::pos_type socket_sink::position() const {
+    return pos_type( static_cast<std::streamoff>( _position ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void socket_sink::flush() {
+    const auto now = std::chrono::steady_clock::now() ;
+    if( 0 == _batch_records ++ ) {
+      _batch_start = now ;
+    }
+    if( _borrowed or _batch_records >= _max_records or _batch_bytes >= _max_bytes or now - _batch_start >= _max_delay ) {
+      sync() ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void socket_sink::sync() {
+    if( _chunks.empty() ) {
+      return ;
+    }
+    std::vector<iovec> iovs ;
+    iovs.reserve( _chunks.size() ) ;
+    for( const auto &c : _chunks ) {
+      iovec iov ;
+      iov.iov_base = const_cast<sio::byte*>( nullptr != c._ptr ? c._ptr : _batch.ptr( c._offset ) ) ;
+      iov.iov_len = c._length ;
+      iovs.push_back( iov ) ;
+    }
+    std::size_t first = 0 ;
+    while( first < iovs.size() ) {
+      msghdr msg ;
+      std::memset( &msg, 0, sizeof(msg) ) ;
+      msg.msg_iov = &iovs[first] ;
+      msg.msg_iovlen = std::min( iovs.size() - first, std::size_t(IOV_MAX) ) ;
+      const auto ret = ::sendmsg( _fd, &msg, MSG_NOSIGNAL ) ;
+      ++ _send_calls ;
+      if( ret < 0 ) {
+        if( EINTR == errno ) {
+          continue ;
+        }
+        SIO_THROW( sio::error_code::io_failure, "Couldn't send records: " + std::string( std::strerror( errno ) ) ) ;
+      }
+      // partial send: skip the bytes sent and resend the rest
+      auto sent = static_cast<std::size_t>( ret ) ;
+      while( first < iovs.size() and sent >= iovs[first].iov_len ) {
+        sent -= iovs[first].iov_len ;
+        ++ first ;
+      }
+      if( sent > 0 ) {
+        iovs[first].iov_base = static_cast<sio::byte*>( iovs[first].iov_base ) + sent ;
+        iovs[first].iov_len -= sent ;
+      }
+    }
+    _chunks.clear() ;
+    _batch_len = 0 ;
+    _batch_records = 0 ;
+    _batch_bytes = 0 ;
+    _borrowed = false ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void socket_sink::close() {
+    if( _closed ) {
+      return ;
+    }
+    sync() ;
+    ::shutdown( _fd, SHUT_WR ) ;
+    _closed = true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  socket_sink::size_type socket_sink::send_calls() const {
+    return _send_calls ;
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  socket_source::socket_source( int fd, size_type recv_size ) :
+    _fd( fd ),
+    _recv( std::max( recv_size, sio::kbyte ) ) {
+    if( _fd < 0 ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Invalid socket" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  socket_source::~socket_source() {
+    sockets::close( _fd ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  socket_source::size_type socket_source::read( sio::byte *dest, size_type length ) {
+    size_type done = 0 ;
+    while( done < length ) {
+      // serve from the receive buffer first
+      if( _recv_pos < _recv_len ) {
+        const auto len = std::min( length - done, _recv_len - _recv_pos ) ;
+        std::memcpy( dest + done, _recv.ptr( _recv_pos ), len ) ;
+        _recv_pos += len ;
+        done += len ;
+        continue ;
+      }
+      size_type nrecv = 0 ;
+      if( length - done >= _recv.size() / 2 ) {
+        // large read: receive directly in the destination
+        nrecv = receive( dest + done, length - done ) ;
+        done += nrecv ;
+      }
+      else {
+        _recv_pos = 0 ;
+        _recv_len = receive( _recv.data(), _recv.size() ) ;
+        nrecv = _recv_len ;
+      }
+      if( 0 == nrecv ) {
+        break ;
+      }
+    }
+    _position += done ;
+    return done ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  socket_source::pos_type socket_source::position() const {
+    return pos_type( static_cast<std::streamoff>( _position ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void socket_source::seek( pos_type pos ) {
+    const auto target = static_cast<std::uint64_t>( static_cast<std::streamoff>( pos ) ) ;
+    if( target < _position ) {
+      SIO_THROW( sio::error_code::bad_state, "Can't move backward in a socket stream!" ) ;
+    }
+    sio::byte discard [256] ;
+    while( _position < target ) {
+      const auto len = static_cast<size_type>( std::min( target - _position, std::uint64_t(sizeof(discard)) ) ) ;
+      if( read( discard, len ) < len ) {
+        SIO_THROW( sio::error_code::io_failure, "Reached end of socket stream while skipping bytes!" ) ;
+      }
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool socket_source::receive_record( record_info &rec_info, buffer &outbuf ) {
+    if( not outbuf.valid() ) {
+      outbuf = take_buffer() ;
+    }
+    try {
+      sio::api::read_record( *this, rec_info, outbuf ) ;
+    }
+    catch( sio::exception &e ) {
+      if( e.code() == sio::error_code::eof ) {
+        return false ;
+      }
+      throw ;
+    }
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  buffer socket_source::take_buffer() {
+    std::lock_guard<std::mutex> lock( _pool_mutex ) ;
+    if( _pool.empty() ) {
+      return buffer( sio::kbyte ) ;
+    }
+    buffer buf( std::move( _pool.back() ) ) ;
+    _pool.pop_back() ;
+    return buf ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void socket_source::give_buffer( buffer &&buf ) {
+    if( not buf.valid() ) {
+      return ;
+    }
+    std::lock_guard<std::mutex> lock( _pool_mutex ) ;
+    _pool.push_back( std::move( buf ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  socket_source::size_type socket_source::recv_calls() const {
+    return _recv_calls ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  socket_source::size_type socket_source::receive( sio::byte *dest, size_type length ) {
+    while( 1 ) {
+      const auto ret = ::recv( _fd, dest, length, 0 ) ;
+      ++ _recv_calls ;
+      if( ret >= 0 ) {
+        return static_cast<size_type>( ret ) ;
+      }
+      if( EINTR != errno ) {
+        SIO_THROW( sio::error_code::io_failure, "Couldn't receive records: " + std::string( std::strerror( errno ) ) ) ;
+      }
+    }
+  }
+
+}
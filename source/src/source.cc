@@ -0,0 +1,91 @@
+// -- sio headers
+#include <sio/source.h>
+#include <sio/exception.h>
+
+// -- std headers
+#include <algorithm>
+
+
+namespace sio {
+
+  memory_source::memory_source( const buffer_span &buf ) :
+    _buffer(buf) {
+    if( not _buffer.valid() ) {
+      SIO_THROW( sio::error_code::invalid_argument, "Buffer is invalid" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  memory_source::size_type memory_source::read( sio::byte *dest, size_type length ) {
+    const auto len = std::min( length, _buffer.size() - _position ) ;
+    std::copy( _buffer.ptr( _position ), _buffer.ptr( _position ) + len, dest ) ;
+    _position += len ;
+    return len ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  memory_source::pos_type memory_source::position() const {
+    return pos_type( static_cast<std::streamoff>( _position ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void memory_source::seek( pos_type pos ) {
+    const auto offset = static_cast<std::streamoff>( pos ) ;
+    if( offset < 0 or static_cast<size_type>( offset ) > _buffer.size() ) {
+      SIO_THROW( sio::error_code::out_of_range, "Position outside of the buffer" ) ;
+    }
+    _position = static_cast<size_type>( offset ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const buffer_span &memory_source::span() const {
+    return _buffer ;
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  file_source::file_source( sio::ifstream &stream ) :
+    _stream(stream) {
+    if( not _stream.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "ifstream is not open!" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  file_source::size_type file_source::read( sio::byte *dest, size_type length ) {
+    if( not _stream.good() ) {
+      SIO_THROW( sio::error_code::bad_state, "ifstream is in a bad state!" ) ;
+    }
+    _stream.read( dest, length ) ;
+    const auto nread = static_cast<size_type>( _stream.gcount() ) ;
+    if( _stream.eof() ) {
+      // end of file is reported with the number of bytes read out
+      _stream.clear() ;
+    }
+    else if( not _stream.good() ) {
+      SIO_THROW( sio::error_code::io_failure, "ifstream is in a bad state after a read operation!" ) ;
+    }
+    return nread ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  file_source::pos_type file_source::position() const {
+    return _stream.tellg() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void file_source::seek( pos_type pos ) {
+    if( not _stream.seekg( pos ).good() ) {
+      SIO_THROW( sio::error_code::bad_state, "ifstream is in a bad state after a seek operation!" ) ;
+    }
+  }
+
+}
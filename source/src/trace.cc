@@ -0,0 +1,304 @@
+// -- sio headers
+#include <sio/trace.h>
+#include <sio/exception.h>
+
+// -- std headers
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+// -- posix headers
+#include <unistd.h>
+
+
+namespace sio {
+
+  std::atomic<bool> trace::_enabled {false} ;
+
+  namespace {
+
+    /**
+     *  @brief  A complete trace event
+     */
+    struct event {
+      ///< The event category
+      const char                 *_category {nullptr} ;
+      ///< The event name
+      const char                 *_name {nullptr} ;
+      ///< The record name, if any
+      std::string                 _record {} ;
+      ///< The start time (nanoseconds)
+      std::int64_t                _start {0} ;
+      ///< The duration (nanoseconds)
+      std::int64_t                _duration {0} ;
+    };
+
+    /**
+     *  @brief  The events of a thread. The mutex is only contended
+     *          while the trace is written out or cleared
+     */
+    struct thread_buffer {
+      ///< The buffer mutex
+      std::mutex                  _mutex {} ;
+      ///< The events
+      std::vector<event>          _events {} ;
+      ///< The thread name
+      std::string                 _name {} ;
+      ///< The number of dropped events
+      std::size_t                 _dropped {0} ;
+      ///< The thread id in the trace
+      unsigned int                _tid {0} ;
+      ///< Whether a running thread owns the buffer
+      std::atomic<bool>           _in_use {false} ;
+      ///< The next buffer in the list (set before publication)
+      thread_buffer              *_next {nullptr} ;
+    };
+
+    /// The head of the list of buffers. The buffers are never freed
+    std::atomic<thread_buffer*> buffers_head {nullptr} ;
+    /// The number of buffers, used as thread id
+    std::atomic<unsigned int> buffers_count {0} ;
+    /// The trace epoch (nanoseconds)
+    std::atomic<std::int64_t> trace_epoch {0} ;
+
+    /**
+     *  @brief  Get a free buffer or allocate a new one
+     */
+    thread_buffer *acquire_buffer() {
+      for( auto buf = buffers_head.load( std::memory_order_acquire ) ; nullptr != buf ; buf = buf->_next ) {
+        bool expected = false ;
+        if( not buf->_in_use.load( std::memory_order_relaxed ) and
+            buf->_in_use.compare_exchange_strong( expected, true, std::memory_order_acquire ) ) {
+          // the events of the previous owner are kept, not its name
+          std::lock_guard<std::mutex> lock( buf->_mutex ) ;
+          buf->_name = "thread " + std::to_string( buf->_tid ) ;
+          return buf ;
+        }
+      }
+      auto buf = new thread_buffer() ;
+      buf->_in_use.store( true, std::memory_order_relaxed ) ;
+      buf->_tid = ++ buffers_count ;
+      buf->_name = "thread " + std::to_string( buf->_tid ) ;
+      buf->_next = buffers_head.load( std::memory_order_relaxed ) ;
+      while( not buffers_head.compare_exchange_weak( buf->_next, buf, std::memory_order_release, std::memory_order_relaxed ) ) {
+        /* retry with the new head */
+      }
+      return buf ;
+    }
+
+    /**
+     *  @brief  Owns the buffer of a thread, released at thread exit
+     */
+    struct buffer_holder {
+      buffer_holder() = default ;
+      buffer_holder( const buffer_holder& ) = delete ;
+      buffer_holder& operator=( const buffer_holder& ) = delete ;
+      ~buffer_holder() {
+        if( nullptr != _buffer ) {
+          _buffer->_in_use.store( false, std::memory_order_release ) ;
+        }
+      }
+      ///< The buffer of the thread
+      thread_buffer              *_buffer {nullptr} ;
+    };
+
+    thread_buffer &local_buffer() {
+      static thread_local buffer_holder holder ;
+      if( nullptr == holder._buffer ) {
+        holder._buffer = acquire_buffer() ;
+      }
+      return *holder._buffer ;
+    }
+
+    std::string json_escape( const std::string &str ) {
+      std::string escaped ;
+      for( const auto c : str ) {
+        if( c == '"' or c == '\\' ) {
+          escaped.push_back( '\\' ) ;
+          escaped.push_back( c ) ;
+        }
+        else if( static_cast<unsigned char>( c ) >= 0x20 ) {
+          escaped.push_back( c ) ;
+        }
+      }
+      return escaped ;
+    }
+
+    /**
+     *  @brief  Write the trace at exit, when started from the environment
+     */
+    class exit_writer {
+    public:
+      exit_writer() {
+        const char *env = std::getenv( "SIO_TRACE" ) ;
+        if( nullptr != env and not std::string( env ).empty() ) {
+          _fname = env ;
+          trace::start() ;
+        }
+      }
+
+      exit_writer( const exit_writer& ) = delete ;
+      exit_writer& operator=( const exit_writer& ) = delete ;
+
+      ~exit_writer() {
+        if( _fname.empty() ) {
+          return ;
+        }
+        trace::stop() ;
+        try {
+          trace::write_json( _fname ) ;
+        }
+        catch( const sio::exception &e ) {
+          std::cerr << "[SIO] Couldn't write the trace: " << e.what() << std::endl ;
+        }
+      }
+
+    private:
+      ///< The trace file name
+      std::string                 _fname {} ;
+    };
+
+    const exit_writer environment_trace ;
+
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool trace::compiled() {
+#ifdef SIO_TRACING
+    return true ;
+#else
+    return false ;
+#endif
+  }
+
+  //--------------------------------------------------------------------------
+
+  void trace::start() {
+    std::int64_t expected = 0 ;
+    trace_epoch.compare_exchange_strong( expected, now() ) ;
+    _enabled.store( true ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void trace::stop() {
+    _enabled.store( false ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void trace::clear() {
+    for( auto buf = buffers_head.load( std::memory_order_acquire ) ; nullptr != buf ; buf = buf->_next ) {
+      std::lock_guard<std::mutex> lock( buf->_mutex ) ;
+      buf->_events.clear() ;
+      buf->_dropped = 0 ;
+    }
+    trace_epoch.store( enabled() ? now() : 0 ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void trace::set_thread_name( const std::string &name ) {
+    auto &buf = local_buffer() ;
+    std::lock_guard<std::mutex> lock( buf._mutex ) ;
+    buf._name = name ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t trace::size() {
+    std::size_t count = 0 ;
+    for( auto buf = buffers_head.load( std::memory_order_acquire ) ; nullptr != buf ; buf = buf->_next ) {
+      std::lock_guard<std::mutex> lock( buf->_mutex ) ;
+      count += buf->_events.size() ;
+    }
+    return count ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t trace::dropped() {
+    std::size_t count = 0 ;
+    for( auto buf = buffers_head.load( std::memory_order_acquire ) ; nullptr != buf ; buf = buf->_next ) {
+      std::lock_guard<std::mutex> lock( buf->_mutex ) ;
+      count += buf->_dropped ;
+    }
+    return count ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void trace::add_event( const char *category, const char *name, const std::string *record, std::int64_t start, std::int64_t end ) {
+    auto &buf = local_buffer() ;
+    std::lock_guard<std::mutex> lock( buf._mutex ) ;
+    if( buf._events.size() >= max_thread_events ) {
+      ++ buf._dropped ;
+      return ;
+    }
+    buf._events.emplace_back() ;
+    auto &evt = buf._events.back() ;
+    evt._category = category ;
+    evt._name = name ;
+    if( nullptr != record ) {
+      evt._record = *record ;
+    }
+    evt._start = start ;
+    evt._duration = end - start ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void trace::write_json( std::ostream &out ) {
+    const auto pid = static_cast<long>( ::getpid() ) ;
+    const auto epoch = trace_epoch.load() ;
+    std::size_t ndropped = 0 ;
+    bool first = true ;
+    auto separator = [&]() -> const char* {
+      const char *sep = first ? "\n" : ",\n" ;
+      first = false ;
+      return sep ;
+    } ;
+    const auto flags = out.flags() ;
+    const auto precision = out.precision() ;
+    out << "{\"traceEvents\": [" ;
+    out << std::fixed << std::setprecision(3) ;
+    for( auto buf = buffers_head.load( std::memory_order_acquire ) ; nullptr != buf ; buf = buf->_next ) {
+      std::lock_guard<std::mutex> lock( buf->_mutex ) ;
+      ndropped += buf->_dropped ;
+      if( buf->_events.empty() ) {
+        continue ;
+      }
+      out << separator() << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": " << buf->_tid
+          << ", \"args\": {\"name\": \"" << json_escape( buf->_name ) << "\"}}" ;
+      for( const auto &evt : buf->_events ) {
+        out << separator() << "{\"name\": \"" << evt._name << "\", \"cat\": \"" << evt._category
+            << "\", \"ph\": \"X\", \"ts\": " << ( evt._start - epoch ) * 1e-3 << ", \"dur\": " << evt._duration * 1e-3
+            << ", \"pid\": " << pid << ", \"tid\": " << buf->_tid ;
+        if( not evt._record.empty() ) {
+          out << ", \"args\": {\"record\": \"" << json_escape( evt._record ) << "\"}" ;
+        }
+        out << "}" ;
+      }
+    }
+    out << "\n], \"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped_events\": " << ndropped << "}}" << std::endl ;
+    out.flags( flags ) ;
+    out.precision( precision ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void trace::write_json( const std::string &fname ) {
+    std::ofstream out( fname ) ;
+    if( not out.is_open() ) {
+      SIO_THROW( sio::error_code::not_open, "Couldn't open trace file '" + fname + "'" ) ;
+    }
+    write_json( out ) ;
+    if( not out.good() ) {
+      SIO_THROW( sio::error_code::io_failure, "Couldn't write trace file '" + fname + "'" ) ;
+    }
+  }
+
+}
@@ -0,0 +1,414 @@
+// -- sio headers
+#include <sio/uring_reader.h>
+#include <sio/api.h>
+#include <sio/exception.h>
+#include <sio/definitions.h>
+
+// -- std headers
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <string>
+
+#ifdef SIO_WITH_IO_URING
+// -- linux headers
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace sio {
+
+#ifdef SIO_WITH_IO_URING
+
+  /**
+   *  @brief  ring struct.
+   *
+   *  Minimal io_uring submission/completion queue pair, set up with
+   *  the raw system calls so that no extra library is required
+   */
+  struct uring_reader::ring {
+    ring() = default ;
+    ring( const ring& ) = delete ;
+    ring& operator=( const ring& ) = delete ;
+    ~ring() {
+      if( nullptr != _sqes ) {
+        ::munmap( _sqes, _sqes_size ) ;
+      }
+      if( nullptr != _cq_ptr and _cq_ptr != _sq_ptr ) {
+        ::munmap( _cq_ptr, _cq_size ) ;
+      }
+      if( nullptr != _sq_ptr ) {
+        ::munmap( _sq_ptr, _sq_size ) ;
+      }
+      if( _ring_fd >= 0 ) {
+        ::close( _ring_fd ) ;
+      }
+      if( _file_fd >= 0 ) {
+        ::close( _file_fd ) ;
+      }
+    }
+
+    /// Setup the queues. Returns false if io_uring is not supported
+    bool setup( const std::string &fname, unsigned int entries ) {
+      io_uring_params params ;
+      std::memset( &params, 0, sizeof(params) ) ;
+      _ring_fd = static_cast<int>( ::syscall( __NR_io_uring_setup, entries, &params ) ) ;
+      if( _ring_fd < 0 ) {
+        return false ;
+      }
+      _sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned) ;
+      _cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe) ;
+      const bool single_mmap = ( params.features & IORING_FEAT_SINGLE_MMAP ) ;
+      if( single_mmap ) {
+        _sq_size = _cq_size = std::max( _sq_size, _cq_size ) ;
+      }
+      _sq_ptr = ::mmap( nullptr, _sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQ_RING ) ;
+      if( MAP_FAILED == _sq_ptr ) {
+        _sq_ptr = nullptr ;
+        return false ;
+      }
+      if( single_mmap ) {
+        _cq_ptr = _sq_ptr ;
+      }
+      else {
+        _cq_ptr = ::mmap( nullptr, _cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_CQ_RING ) ;
+        if( MAP_FAILED == _cq_ptr ) {
+          _cq_ptr = nullptr ;
+          return false ;
+        }
+      }
+      _sqes_size = params.sq_entries * sizeof(io_uring_sqe) ;
+      void *sqes = ::mmap( nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQES ) ;
+      if( MAP_FAILED == sqes ) {
+        return false ;
+      }
+      _sqes = static_cast<io_uring_sqe*>( sqes ) ;
+      auto sq = static_cast<char*>( _sq_ptr ) ;
+      auto cq = static_cast<char*>( _cq_ptr ) ;
+      _sq_tail = reinterpret_cast<unsigned*>( sq + params.sq_off.tail ) ;
+      _sq_mask = *reinterpret_cast<unsigned*>( sq + params.sq_off.ring_mask ) ;
+      _sq_array = reinterpret_cast<unsigned*>( sq + params.sq_off.array ) ;
+      _cq_head = reinterpret_cast<unsigned*>( cq + params.cq_off.head ) ;
+      _cq_tail = reinterpret_cast<unsigned*>( cq + params.cq_off.tail ) ;
+      _cq_mask = *reinterpret_cast<unsigned*>( cq + params.cq_off.ring_mask ) ;
+      _cqes = reinterpret_cast<io_uring_cqe*>( cq + params.cq_off.cqes ) ;
+      _entries = params.sq_entries ;
+      _file_fd = ::open( fname.c_str(), O_RDONLY | O_CLOEXEC ) ;
+      if( _file_fd < 0 ) {
+        SIO_THROW( sio::error_code::open_fail, "Couldn't open file '" + fname + "': " + std::strerror( errno ) ) ;
+      }
+      return true ;
+    }
+
+    /// Queue a read in the submission queue (not submitted yet)
+    void queue_read( sio::byte *dest, std::size_t offset, unsigned int length, std::size_t user_data ) {
+      const unsigned tail = *_sq_tail ;
+      const unsigned index = tail & _sq_mask ;
+      io_uring_sqe *sqe = &_sqes[ index ] ;
+      std::memset( sqe, 0, sizeof(io_uring_sqe) ) ;
+      sqe->opcode = IORING_OP_READ ;
+      sqe->fd = _file_fd ;
+      sqe->addr = reinterpret_cast<unsigned long long>( dest ) ;
+      sqe->len = length ;
+      sqe->off = offset ;
+      sqe->user_data = user_data ;
+      _sq_array[ index ] = index ;
+      __atomic_store_n( _sq_tail, tail + 1, __ATOMIC_RELEASE ) ;
+      ++ _to_submit ;
+    }
+
+    /// Submit the queued reads and wait for at least one completion
+    void submit_and_wait() {
+      while( 1 ) {
+        const auto ret = ::syscall( __NR_io_uring_enter, _ring_fd, _to_submit, 1, IORING_ENTER_GETEVENTS, nullptr, 0 ) ;
+        if( ret >= 0 ) {
+          _to_submit -= std::min( _to_submit, static_cast<unsigned>( ret ) ) ;
+          return ;
+        }
+        if( EINTR != errno ) {
+          SIO_THROW( sio::error_code::io_failure, std::string("io_uring_enter failed: ") + std::strerror( errno ) ) ;
+        }
+      }
+    }
+
+    ///< The ring file descriptor
+    int                  _ring_fd {-1} ;
+    ///< The file descriptor of the file to read
+    int                  _file_fd {-1} ;
+    ///< The number of submission queue entries
+    unsigned             _entries {0} ;
+    ///< The number of queued entries not submitted yet
+    unsigned             _to_submit {0} ;
+    ///< The mapped submission ring
+    void                *_sq_ptr {nullptr} ;
+    ///< The size of the mapped submission ring
+    std::size_t          _sq_size {0} ;
+    ///< The mapped completion ring
+    void                *_cq_ptr {nullptr} ;
+    ///< The size of the mapped completion ring
+    std::size_t          _cq_size {0} ;
+    ///< The mapped submission queue entries
+    io_uring_sqe        *_sqes {nullptr} ;
+    ///< The size of the mapped submission queue entries
+    std::size_t          _sqes_size {0} ;
+    ///< The submission ring tail
+    unsigned            *_sq_tail {nullptr} ;
+    ///< The submission ring mask
+    unsigned             _sq_mask {0} ;
+    ///< The submission ring index array
+    unsigned            *_sq_array {nullptr} ;
+    ///< The completion ring head
+    unsigned            *_cq_head {nullptr} ;
+    ///< The completion ring tail
+    unsigned            *_cq_tail {nullptr} ;
+    ///< The completion ring mask
+    unsigned             _cq_mask {0} ;
+    ///< The completion queue entries
+    io_uring_cqe        *_cqes {nullptr} ;
+  };
+
+#else
+
+  struct uring_reader::ring {} ;
+
+#endif
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  uring_reader::uring_reader( const std::string &fname, unsigned int queue_depth ) :
+    _fname( fname ),
+    _ring() {
+#ifdef SIO_WITH_IO_URING
+    std::unique_ptr<ring> new_ring( new ring() ) ;
+    if( new_ring->setup( fname, std::max( queue_depth, 1u ) ) ) {
+      _ring = std::move( new_ring ) ;
+      return ;
+    }
+    SIO_DEBUG( "io_uring not available, using ifstream fallback" ) ;
+#else
+    (void)queue_depth ;
+#endif
+    _stream.open( fname, std::ios::binary ) ;
+    if( not _stream.is_open() ) {
+      SIO_THROW( sio::error_code::open_fail, "Couldn't open file '" + fname + "'" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  uring_reader::~uring_reader() = default ;
+
+  //--------------------------------------------------------------------------
+
+  bool uring_reader::available() {
+#ifdef SIO_WITH_IO_URING
+    io_uring_params params ;
+    std::memset( &params, 0, sizeof(params) ) ;
+    const int fd = static_cast<int>( ::syscall( __NR_io_uring_setup, 1, &params ) ) ;
+    if( fd < 0 ) {
+      return false ;
+    }
+    ::close( fd ) ;
+    return true ;
+#else
+    return false ;
+#endif
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool uring_reader::uses_io_uring() const {
+    return ( nullptr != _ring ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void uring_reader::read_records( const std::vector<record_info> &infos, std::vector<buffer> &outbufs ) {
+    prepare_buffers( outbufs, infos.size() ) ;
+    std::vector<read_request> requests( infos.size() ) ;
+    for( size_type i=0 ; i<infos.size() ; i++ ) {
+      const auto len = static_cast<size_type>( infos[i]._header_length ) + infos[i]._data_length ;
+      outbufs[i].resize( len ) ;
+      requests[i]._dest = outbufs[i].data() ;
+      requests[i]._offset = static_cast<size_type>( static_cast<std::streamoff>( infos[i]._file_start ) ) ;
+      requests[i]._length = len ;
+      requests[i]._min_length = len ;
+    }
+    read_batch( requests ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void uring_reader::read_records( const std::vector<pos_type> &positions, std::vector<record_info> &infos, std::vector<buffer> &outbufs ) {
+    prepare_buffers( outbufs, positions.size() ) ;
+    infos.resize( positions.size() ) ;
+    // first batch: the record headers
+    std::vector<read_request> requests( positions.size() ) ;
+    for( size_type i=0 ; i<positions.size() ; i++ ) {
+      outbufs[i].resize( sio::max_record_info_len ) ;
+      requests[i]._dest = outbufs[i].data() ;
+      requests[i]._offset = static_cast<size_type>( static_cast<std::streamoff>( positions[i] ) ) ;
+      requests[i]._length = sio::max_record_info_len ;
+      requests[i]._min_length = 8 ;
+    }
+    read_batch( requests ) ;
+    // second batch: the record data, after the header bytes in the buffers
+    size_type ndata = 0 ;
+    for( size_type i=0 ; i<positions.size() ; i++ ) {
+      record_info_view view ;
+      view._file_start = positions[i] ;
+      sio::api::read_record_info( outbufs[i].span( 0, requests[i]._done ), view ) ;
+      infos[i] = view.to_info() ;
+      const auto header_len = static_cast<size_type>( view._header_length ) ;
+      const auto len = header_len + view._data_length ;
+      const auto already_read = std::min( requests[i]._done, len ) ;
+      outbufs[i].resize( len ) ;
+      if( already_read < len ) {
+        auto &request = requests[ndata++] ;
+        request._dest = outbufs[i].ptr( already_read ) ;
+        request._offset = requests[i]._offset + already_read ;
+        request._length = len - already_read ;
+        request._min_length = request._length ;
+        request._done = 0 ;
+      }
+    }
+    requests.resize( ndata ) ;
+    read_batch( requests ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void uring_reader::read_batch( std::vector<read_request> &requests ) {
+#ifdef SIO_WITH_IO_URING
+    if( nullptr == _ring ) {
+      read_batch_stream( requests ) ;
+      return ;
+    }
+    // single reads are limited to 1 GiB, larger requests are continued as short reads
+    const size_type max_read = 0x40000000 ;
+    size_type next = 0, inflight = 0, completed = 0 ;
+    while( completed < requests.size() ) {
+      // fill the submission queue
+      while( next < requests.size() and inflight < _ring->_entries ) {
+        auto &request = requests[next] ;
+        if( request._length == 0 ) {
+          ++ completed ;
+          ++ next ;
+          continue ;
+        }
+        _ring->queue_read( request._dest, request._offset, static_cast<unsigned int>( std::min( request._length, max_read ) ), next ) ;
+        ++ inflight ;
+        ++ next ;
+      }
+      if( 0 == inflight ) {
+        continue ;
+      }
+      _ring->submit_and_wait() ;
+      // reap the completions
+      unsigned head = *_ring->_cq_head ;
+      const unsigned tail = __atomic_load_n( _ring->_cq_tail, __ATOMIC_ACQUIRE ) ;
+      bool fallback = false ;
+      std::string error ;
+      while( head != tail ) {
+        const io_uring_cqe &cqe = _ring->_cqes[ head & _ring->_cq_mask ] ;
+        ++ head ;
+        -- inflight ;
+        auto &request = requests[ static_cast<size_type>( cqe.user_data ) ] ;
+        if( cqe.res == -EINVAL or cqe.res == -EOPNOTSUPP ) {
+          // old kernel without IORING_OP_READ: finish with the fallback
+          fallback = true ;
+          continue ;
+        }
+        // on error, the other reads of the batch are drained before throwing:
+        // the kernel could otherwise still write in the caller buffers
+        if( cqe.res < 0 ) {
+          if( error.empty() ) {
+            error = "Couldn't read from file '" + _fname + "': " + std::strerror( -cqe.res ) ;
+          }
+          continue ;
+        }
+        const auto nread = static_cast<size_type>( cqe.res ) ;
+        request._done += nread ;
+        if( nread == 0 or request._done >= request._length ) {
+          if( request._done < request._min_length and error.empty() ) {
+            error = "Reached end of file '" + _fname + "' while reading a record!" ;
+          }
+          ++ completed ;
+          continue ;
+        }
+        if( fallback or not error.empty() ) {
+          continue ;
+        }
+        // short read: queue the remaining bytes
+        _ring->queue_read( request._dest + request._done, request._offset + request._done,
+          static_cast<unsigned int>( std::min( request._length - request._done, max_read ) ), cqe.user_data ) ;
+        ++ inflight ;
+      }
+      __atomic_store_n( _ring->_cq_head, head, __ATOMIC_RELEASE ) ;
+      if( fallback or not error.empty() ) {
+        // drain the remaining reads
+        while( inflight > 0 ) {
+          _ring->submit_and_wait() ;
+          unsigned h = *_ring->_cq_head ;
+          const unsigned t = __atomic_load_n( _ring->_cq_tail, __ATOMIC_ACQUIRE ) ;
+          inflight -= ( t - h ) ;
+          __atomic_store_n( _ring->_cq_head, t, __ATOMIC_RELEASE ) ;
+        }
+      }
+      if( not error.empty() ) {
+        SIO_THROW( sio::error_code::io_failure, error ) ;
+      }
+      if( fallback ) {
+        // use the ifstream for the whole batch
+        _ring.reset() ;
+        _stream.open( _fname, std::ios::binary ) ;
+        if( not _stream.is_open() ) {
+          SIO_THROW( sio::error_code::open_fail, "Couldn't open file '" + _fname + "'" ) ;
+        }
+        for( auto &request : requests ) {
+          request._done = 0 ;
+        }
+        read_batch_stream( requests ) ;
+        return ;
+      }
+    }
+#else
+    read_batch_stream( requests ) ;
+#endif
+  }
+
+  //--------------------------------------------------------------------------
+
+  void uring_reader::read_batch_stream( std::vector<read_request> &requests ) {
+    for( auto &request : requests ) {
+      _stream.clear() ;
+      _stream.seekg( static_cast<std::streamoff>( request._offset ) ) ;
+      if( not _stream.good() ) {
+        SIO_THROW( sio::error_code::bad_state, "ifstream is in a bad state after a seek operation!" ) ;
+      }
+      _stream.read( request._dest, request._length ) ;
+      request._done = static_cast<size_type>( _stream.gcount() ) ;
+      if( request._done < request._min_length ) {
+        SIO_THROW( sio::error_code::io_failure, "Reached end of file '" + _fname + "' while reading a record!" ) ;
+      }
+    }
+    _stream.clear() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void uring_reader::prepare_buffers( std::vector<buffer> &outbufs, size_type count ) {
+    if( outbufs.size() > count ) {
+      outbufs.erase( outbufs.begin() + count, outbufs.end() ) ;
+    }
+    while( outbufs.size() < count ) {
+      outbufs.emplace_back( sio::max_record_info_len ) ;
+    }
+  }
+
+}